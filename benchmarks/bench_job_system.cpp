@@ -0,0 +1,133 @@
+/**
+ * @file bench_job_system.cpp
+ * @author B.G. Smit
+ * @brief Micro-benchmarks for the scaling of the job system.
+ *
+ * Every benchmark runs with 1 to N worker threads (the calling thread helps as well), where N is
+ * one less than the hardware concurrency, next to a serial baseline. Items per second should grow
+ * with the worker count until memory bandwidth or the core count is reached.
+ * @copyright Copyright (c) 2025
+ */
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Core/JobSystem.h"
+
+namespace {
+
+constexpr size_t kItemCount = 1 << 20;
+
+/**
+ * @brief Adds the worker counts 1, 2, 4, ... up to one less than the hardware concurrency.
+ */
+void WorkerCounts(benchmark::internal::Benchmark* benchmark) {
+  const int max_workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+  for (int workers = 1; workers < max_workers; workers *= 2)
+    benchmark->Arg(workers);
+  benchmark->Arg(max_workers);
+  benchmark->UseRealTime();
+}
+
+/**
+ * @brief A compute-bound function of an index, so the loops scale with cores, not bandwidth.
+ */
+float Work(size_t i) {
+  float value = (float)i;
+  for (int step = 0; step < 32; step++)
+    value = std::sqrt(value * 1.0001f + 1.0f);
+  return value;
+}
+
+std::vector<int> RandomInts(size_t count) {
+  std::mt19937 random(42);
+  std::vector<int> values(count);
+  for (int& value : values)
+    value = (int)random();
+  return values;
+}
+
+}  // namespace
+
+static void BM_SerialFor(benchmark::State& state) {
+  std::vector<float> output(kItemCount);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kItemCount; i++)
+      output[i] = Work(i);
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kItemCount);
+}
+BENCHMARK(BM_SerialFor)->UseRealTime();
+
+static void BM_ParallelFor(benchmark::State& state) {
+  Weaver::JobSystem jobs((uint32_t)state.range(0));
+  std::vector<float> output(kItemCount);
+  for (auto _ : state) {
+    jobs.ParallelFor(0, kItemCount, [&](size_t i) { output[i] = Work(i); });
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kItemCount);
+}
+BENCHMARK(BM_ParallelFor)->Apply(WorkerCounts);
+
+static void BM_ParallelReduce(benchmark::State& state) {
+  Weaver::JobSystem jobs((uint32_t)state.range(0));
+  for (auto _ : state) {
+    const float sum = jobs.ParallelReduce(
+        0, kItemCount, 0.0f, [](size_t i) { return Work(i); }, std::plus<float>());
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kItemCount);
+}
+BENCHMARK(BM_ParallelReduce)->Apply(WorkerCounts);
+
+static void BM_StdSort(benchmark::State& state) {
+  const std::vector<int> input = RandomInts(kItemCount);
+  std::vector<int> values;
+  for (auto _ : state) {
+    values = input;
+    std::sort(values.begin(), values.end());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kItemCount);
+}
+BENCHMARK(BM_StdSort)->UseRealTime();
+
+static void BM_ParallelSort(benchmark::State& state) {
+  Weaver::JobSystem jobs((uint32_t)state.range(0));
+  const std::vector<int> input = RandomInts(kItemCount);
+  std::vector<int> values;
+  for (auto _ : state) {
+    values = input;
+    jobs.ParallelSort(values.begin(), values.end());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kItemCount);
+}
+BENCHMARK(BM_ParallelSort)->Apply(WorkerCounts);
+
+/**
+ * @brief Measures the overhead of scheduling and waiting for many tiny jobs.
+ */
+static void BM_ScheduleTinyJobs(benchmark::State& state) {
+  constexpr int kJobCount = 10000;
+  Weaver::JobSystem jobs((uint32_t)state.range(0));
+  std::vector<Weaver::JobHandle> handles(kJobCount);
+  for (auto _ : state) {
+    Weaver::JobHandle root = jobs.Schedule([&]() {
+      for (int i = 0; i < kJobCount; i++)
+        handles[i] = jobs.Schedule([]() {});
+      for (const auto& handle : handles)
+        jobs.Wait(handle);
+    });
+    jobs.Wait(root);
+  }
+  state.SetItemsProcessed(state.iterations() * kJobCount);
+}
+BENCHMARK(BM_ScheduleTinyJobs)->Apply(WorkerCounts);
@@ -0,0 +1,161 @@
+/**
+ * @file bench_pixel_conversion.cpp
+ * @author B.G. Smit
+ * @brief Micro-benchmarks for the pixel conversion kernels.
+ *
+ * Every kernel is measured at each SIMD level the CPU supports (0 = scalar, 1 = SSE4.1,
+ * 2 = AVX2) over a 1920x1080 frame, reporting the throughput in pixels per second.
+ * @copyright Copyright (c) 2025
+ */
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Core/PixelConversion.h"
+
+using Weaver::PixelConversion;
+using Weaver::SimdLevel;
+
+namespace {
+
+constexpr size_t kPixelCount = 1920 * 1080;
+
+/**
+ * @brief Selects the SIMD level requested by the benchmark, skipping unsupported levels.
+ * @return True if the level is supported.
+ */
+bool SelectSimdLevel(benchmark::State& state) {
+  const SimdLevel level = (SimdLevel)state.range(0);
+  if ((int)level > (int)PixelConversion::GetSupportedSimdLevel()) {
+    state.SkipWithError("SIMD level not supported by this CPU");
+    return false;
+  }
+  PixelConversion::SetSimdLevel(level);
+  return true;
+}
+
+std::vector<uint8_t> RandomBytes(size_t count) {
+  std::mt19937 random(42);
+  std::vector<uint8_t> bytes(count);
+  for (uint8_t& byte : bytes)
+    byte = (uint8_t)random();
+  return bytes;
+}
+
+std::vector<float> RandomFloats(size_t count) {
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> distribution(-0.25f, 1.25f);
+  std::vector<float> values(count);
+  for (float& value : values)
+    value = distribution(random);
+  return values;
+}
+
+}  // namespace
+
+static void BM_RGBToRGBA(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 3);
+  std::vector<uint8_t> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::RGBToRGBA(source.data(), destination.data(), kPixelCount);
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_RGBToRGBA)->DenseRange(0, 2);
+
+static void BM_SwizzleRB(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 4);
+  std::vector<uint8_t> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::SwizzleRB(source.data(), destination.data(), kPixelCount);
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_SwizzleRB)->DenseRange(0, 2);
+
+static void BM_FloatToHalf(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<float> source = RandomFloats(kPixelCount * 4);
+  std::vector<uint16_t> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::FloatToHalf(source.data(), destination.data(), source.size());
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_FloatToHalf)->DenseRange(0, 2);
+
+static void BM_HalfToFloat(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<uint8_t> bytes = RandomBytes(kPixelCount * 8);
+  const uint16_t* source = (const uint16_t*)bytes.data();
+  std::vector<float> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::HalfToFloat(source, destination.data(), destination.size());
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_HalfToFloat)->DenseRange(0, 2);
+
+static void BM_FloatToUnorm8(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<float> source = RandomFloats(kPixelCount * 4);
+  std::vector<uint8_t> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::FloatToUnorm8(source.data(), destination.data(), source.size());
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_FloatToUnorm8)->DenseRange(0, 2);
+
+static void BM_PremultiplyAlpha(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 4);
+  std::vector<uint8_t> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::PremultiplyAlpha(source.data(), destination.data(), kPixelCount);
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_PremultiplyAlpha)->DenseRange(0, 2);
+
+static void BM_LinearToSRGB(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<float> source = RandomFloats(kPixelCount * 4);
+  std::vector<uint8_t> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::LinearToSRGB(source.data(), destination.data(), kPixelCount);
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_LinearToSRGB)->DenseRange(0, 2);
+
+static void BM_SRGBToLinear(benchmark::State& state) {
+  if (!SelectSimdLevel(state))
+    return;
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 4);
+  std::vector<float> destination(kPixelCount * 4);
+  for (auto _ : state) {
+    PixelConversion::SRGBToLinear(source.data(), destination.data(), kPixelCount);
+    benchmark::DoNotOptimize(destination.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kPixelCount);
+}
+BENCHMARK(BM_SRGBToLinear)->DenseRange(0, 2);
@@ -0,0 +1,99 @@
+/**
+ * @file bench_timer.cpp
+ * @author B.G. Smit
+ * @brief Micro-benchmarks for the per-sample overhead of the clocks, timers and profiler scopes.
+ *
+ * The clock is measured with each source (0 = steady_clock, 1 = TSC) next to the standard clocks,
+ * then the instrumentation built on it: a `Timer` sample, a `WEAVER_TIME_SCOPE` and a profiler
+ * scope with and without an active session. The time per iteration is the cost of one sample.
+ * @copyright Copyright (c) 2025
+ */
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+
+#include "Core/Clock.h"
+#include "Core/Profiler.h"
+#include "Core/Timer.h"
+
+using Weaver::Clock;
+using Weaver::ClockSource;
+
+namespace {
+
+/**
+ * @brief Selects the clock source requested by the benchmark, skipping unsupported sources.
+ * @return True if the source is supported.
+ */
+bool SelectClockSource(benchmark::State& state) {
+  const ClockSource source = (ClockSource)state.range(0);
+  if ((int)source > (int)Clock::GetSupportedSource()) {
+    state.SkipWithError("Clock source not supported by this CPU");
+    return false;
+  }
+  Clock::SetSource(source);
+  return true;
+}
+
+}  // namespace
+
+static void BM_ClockNow(benchmark::State& state) {
+  if (!SelectClockSource(state))
+    return;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Clock::Now());
+  Clock::SetSource(Clock::GetSupportedSource());
+}
+BENCHMARK(BM_ClockNow)->DenseRange(0, 1);
+
+static void BM_SteadyClockNow(benchmark::State& state) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+}
+BENCHMARK(BM_SteadyClockNow);
+
+static void BM_HighResolutionClockNow(benchmark::State& state) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(std::chrono::high_resolution_clock::now());
+}
+BENCHMARK(BM_HighResolutionClockNow);
+
+static void BM_TimerElapsed(benchmark::State& state) {
+  if (!SelectClockSource(state))
+    return;
+  Weaver::Timer timer;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(timer.elapsed_ns());
+  Clock::SetSource(Clock::GetSupportedSource());
+}
+BENCHMARK(BM_TimerElapsed)->DenseRange(0, 1);
+
+static void BM_TimeScope(benchmark::State& state) {
+  if (!SelectClockSource(state))
+    return;
+  for (auto _ : state) {
+    WEAVER_TIME_SCOPE("bench_timer.TimeScope");
+  }
+  Clock::SetSource(Clock::GetSupportedSource());
+}
+BENCHMARK(BM_TimeScope)->DenseRange(0, 1);
+
+static void BM_ProfileScope(benchmark::State& state) {
+  const bool active = state.range(0) != 0;
+  if (active)
+    Weaver::Profiler::BeginSession();
+  // Every scope records two events. A new session starts before the buffer is full, so no event
+  // is dropped.
+  size_t scopes = 0;
+  for (auto _ : state) {
+    if (active && ++scopes == Weaver::Profiler::kMaxEventsPerThread / 2) {
+      state.PauseTiming();
+      Weaver::Profiler::BeginSession();
+      scopes = 0;
+      state.ResumeTiming();
+    }
+    Weaver::ProfileScope scope("bench_timer.ProfileScope");
+  }
+  Weaver::Profiler::EndSession();
+}
+BENCHMARK(BM_ProfileScope)->Arg(0)->Arg(1);
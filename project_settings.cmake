@@ -1,6 +1,8 @@
 set(PROJECT_NAME "Weaver")
 set(PROJECT_VERSION "1.0.0")
-set(PROJECT_CPP_VERSION 17)
+set(PROJECT_CPP_VERSION 20)
+# Compiles the WEAVER_PROFILE_* instrumentation in; OFF removes it entirely.
+set(PROJECT_ENABLE_PROFILING ON)
 set(PROJECT_COMPANY_NAME "My Default Company")
 set(PROJECT_COMPANY_NAMESPACE "com.mydefaultcompany")
 set(CPACK_PACKAGE_DESCRIPTION_SUMMARY "A Template GUI Application in C++, Dear ImGUI, an Vulkan")
@@ -56,33 +56,23 @@ class ExampleLayer : public Weaver::Layer {
   virtual void OnUIRender() override;
 
   /**
-   * @brief Called when the window is resized.
-   * @param width The new width of the window.
-   * @param height The new height of the window.
+   * @brief Called when the layer is attached; subscribes to the window events it reacts to.
    */
-  virtual void OnResize(uint32_t width, uint32_t height) override {}
-
-  /**
-   * @brief Called when the window is minimized.
-   */
-  virtual void OnMinimize() override {
-    m_continuous_rendering_before_state_change = m_continuous_rendering;
-    m_continuous_rendering = false;
-  }
-
-  /**
-   * @brief Called when the window is maximized.
-   */
-  virtual void OnMaximize() override {
-    m_continuous_rendering_before_state_change = m_continuous_rendering;
-    m_continuous_rendering = false;
-  }
-
-  /**
-   * @brief Called when the window is restored.
-   */
-  virtual void OnRestored() override {
-    m_continuous_rendering = m_continuous_rendering_before_state_change;
+  virtual void OnAttach() override {
+    Subscribe<Weaver::WindowMinimizeEvent>([this](const Weaver::WindowMinimizeEvent&) {
+      m_continuous_rendering_before_state_change = m_continuous_rendering;
+      m_continuous_rendering = false;
+      return false;
+    });
+    Subscribe<Weaver::WindowMaximizeEvent>([this](const Weaver::WindowMaximizeEvent&) {
+      m_continuous_rendering_before_state_change = m_continuous_rendering;
+      m_continuous_rendering = false;
+      return false;
+    });
+    Subscribe<Weaver::WindowRestoreEvent>([this](const Weaver::WindowRestoreEvent&) {
+      m_continuous_rendering = m_continuous_rendering_before_state_change;
+      return false;
+    });
   }
 
  private:
@@ -107,6 +97,7 @@ void ExampleLayer::OnUIRender() {
   ImGui::Text("Application Statistics");
   ImGui::Separator();
   ImGui::Text("Frame Rate: %.1f FPS", ImGui::GetIO().Framerate);
+  ImGui::Text("Input Latency: %.1f ms", Weaver::Canvas::Get().GetInputLatency());
   ImGui::Text("Viewport Size: %d x %d", m_viewport_width, m_viewport_height);
 
   ImGui::Spacing();
@@ -294,6 +285,9 @@ Weaver::Canvas* Weaver::CreateCanvas(int argc, char** argv) {
       if (ImGui::MenuItem("Show Demo Window")) {
         s_show_demo_window = true;
       }
+      if (ImGui::MenuItem("Low Latency", nullptr, app->IsLowLatency())) {
+        app->SetLowLatency(!app->IsLowLatency());
+      }
       ImGui::EndMenu();
     }
 
@@ -0,0 +1,160 @@
+/**
+ * @file AssetLoader.cpp
+ * @author B.G. Smit
+ * @brief Implements the asynchronous asset loader.
+ *
+ * Images are decoded on the `ThreadPool` workers into CPU memory. The GPU upload
+ * (which records Vulkan commands) is deferred to `ProcessUploads`, which the `Canvas`
+ * calls on the main thread once per frame.
+ * @copyright Copyright (c) 2025
+ */
+#include "AssetLoader.h"
+
+#include "Canvas.h"
+#include "Log.h"
+
+namespace Weaver {
+
+/**
+ * @brief Gets the descriptor set to draw and marks the asset as drawn this frame.
+ * @return The Vulkan descriptor set.
+ */
+VkDescriptorSet ImageAsset::GetDescriptorSet() const {
+  m_LastUsedFrame.store(Canvas::GetFrameCount(), std::memory_order_relaxed);
+  return m_Image ? m_Image->GetDescriptorSet() : m_Placeholder;
+}
+
+/**
+ * @brief Cancels loading of the asset.
+ */
+void ImageAsset::Cancel() {
+  State state = m_State.load(std::memory_order_acquire);
+  while (state == State::Queued || state == State::Decoding || state == State::Decoded) {
+    if (m_State.compare_exchange_weak(state, State::Cancelled, std::memory_order_acq_rel))
+      return;
+  }
+}
+
+/**
+ * @brief Constructs a new AssetLoader and starts its decode workers.
+ * @param worker_count The number of decode workers, zero for automatic sizing.
+ */
+AssetLoader::AssetLoader(uint32_t worker_count) : m_Workers(worker_count) {
+  const uint8_t placeholder_pixel[4] = {48, 48, 48, 255};
+  m_Placeholder = std::make_unique<Image>(1, 1, ImageFormat::RGBA, placeholder_pixel);
+}
+
+/**
+ * @brief Destroys the AssetLoader.
+ */
+AssetLoader::~AssetLoader() = default;
+
+/**
+ * @brief Starts loading an image file and returns immediately.
+ * @param path The path to the image file.
+ * @param options Controls the GPU format chosen for the decoded pixels.
+ * @return A handle that draws a placeholder until the image is ready.
+ */
+std::shared_ptr<ImageAsset> AssetLoader::LoadImage(
+    std::string_view path, const ImageLoadOptions& options) {
+  auto asset = std::make_shared<ImageAsset>();
+  asset->m_Path = std::string(path);
+  asset->m_Options = options;
+  asset->m_Placeholder = m_Placeholder->GetDescriptorSet();
+  asset->m_LastUsedFrame.store(Canvas::GetFrameCount(), std::memory_order_relaxed);
+
+  // The worker only holds a weak reference, so dropping the handle cancels the load.
+  std::weak_ptr<ImageAsset> weak_asset = asset;
+  m_Decoding.fetch_add(1, std::memory_order_relaxed);
+  m_Workers.Submit([this, weak_asset]() {
+    DecodeAsset(weak_asset);
+    // After the decoded asset was queued, so a finished decode is never missed.
+    m_Decoding.fetch_sub(1, std::memory_order_release);
+  });
+
+  return asset;
+}
+
+/**
+ * @brief Decodes an asset on a worker thread.
+ * @param weak_asset The asset to decode.
+ */
+void AssetLoader::DecodeAsset(const std::weak_ptr<ImageAsset>& weak_asset) {
+  std::shared_ptr<ImageAsset> asset = weak_asset.lock();
+  if (!asset)
+    return;
+
+  ImageAsset::State expected = ImageAsset::State::Queued;
+  if (!asset->m_State.compare_exchange_strong(
+          expected, ImageAsset::State::Decoding, std::memory_order_acq_rel))
+    return;
+
+  ImageData data;
+  const bool decoded = Image::Decode(asset->m_Path, asset->m_Options, data);
+  if (!decoded)
+    WEAVER_LOG_ERROR("Failed to decode image: ") << asset->m_Path;
+
+  asset->m_Data = std::move(data);
+
+  expected = ImageAsset::State::Decoding;
+  const ImageAsset::State result = decoded ? ImageAsset::State::Decoded : ImageAsset::State::Failed;
+  if (!asset->m_State.compare_exchange_strong(expected, result, std::memory_order_acq_rel)) {
+    // Cancelled while decoding, the main thread never reads the data in this state.
+    asset->m_Data = ImageData();
+    return;
+  }
+
+  if (decoded) {
+    std::lock_guard<std::mutex> lock(m_DecodedMutex);
+    m_Decoded.push_back(weak_asset);
+  }
+}
+
+/**
+ * @brief Uploads decoded images to the GPU.
+ * @param max_uploads The maximum number of images uploaded by this call.
+ */
+void AssetLoader::ProcessUploads(uint32_t max_uploads) {
+  {
+    std::lock_guard<std::mutex> lock(m_DecodedMutex);
+    m_PendingUploads.insert(m_PendingUploads.end(), m_Decoded.begin(), m_Decoded.end());
+    m_Decoded.clear();
+  }
+
+  uint32_t uploaded = 0;
+  size_t processed = 0;
+  for (; processed < m_PendingUploads.size() && uploaded < max_uploads; processed++) {
+    std::shared_ptr<ImageAsset> asset = m_PendingUploads[processed].lock();
+    if (!asset)
+      continue;
+
+    if (asset->GetState() != ImageAsset::State::Decoded) {
+      asset->m_Data = ImageData();
+      continue;
+    }
+
+    auto image = std::make_shared<Image>(asset->m_Data, asset->m_Options.Sampler);
+    asset->m_Data = ImageData();
+    uploaded++;
+
+    ImageAsset::State expected = ImageAsset::State::Decoded;
+    if (asset->m_State.compare_exchange_strong(
+            expected, ImageAsset::State::Ready, std::memory_order_acq_rel))
+      asset->m_Image = std::move(image);
+  }
+
+  m_PendingUploads.erase(m_PendingUploads.begin(), m_PendingUploads.begin() + processed);
+}
+
+/**
+ * @brief Checks if images are being decoded or wait to be uploaded.
+ * @return True if loads are in progress.
+ */
+bool AssetLoader::HasPendingLoads() {
+  if (m_Decoding.load(std::memory_order_acquire) > 0 || !m_PendingUploads.empty())
+    return true;
+  std::lock_guard<std::mutex> lock(m_DecodedMutex);
+  return !m_Decoded.empty();
+}
+
+}  // namespace Weaver
@@ -0,0 +1,196 @@
+/**
+ * @file AssetLoader.h
+ * @author B.G. Smit
+ * @brief Declares the asynchronous asset loader used to stream images from disk.
+ *
+ * This file defines the `AssetLoader` class, which decodes image files on a pool of
+ * worker threads and uploads them to the GPU on the main thread, and the `ImageAsset`
+ * handle it returns. Handles can be drawn immediately; they show a placeholder texture
+ * until the real image is ready.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Image.h"
+#include "ThreadPool.h"
+
+namespace Weaver {
+
+/**
+ * @class ImageAsset
+ * @brief A handle to an image that is being loaded by the `AssetLoader`.
+ */
+class ImageAsset {
+ public:
+  /**
+   * @enum State
+   * @brief The loading state of the asset.
+   */
+  enum class State {
+    Queued,   /**< Waiting for a decode worker. */
+    Decoding, /**< Being decoded on a worker thread. */
+    Decoded,  /**< Decoded, waiting for the GPU upload on the main thread. */
+    Ready,    /**< Uploaded and ready to be drawn. */
+    Failed,   /**< The file could not be decoded. */
+    Cancelled /**< Loading was cancelled before it finished. */
+  };
+
+  /**
+   * @brief Gets the descriptor set to draw, which is the placeholder until the image is ready.
+   * @details Also marks the asset as drawn this frame for the `TextureCache` eviction.
+   * @return The Vulkan descriptor set.
+   */
+  VkDescriptorSet GetDescriptorSet() const;
+
+  /**
+   * @brief Gets the frame in which the asset was last drawn.
+   * @return The frame count, see `Canvas::GetFrameCount`.
+   */
+  uint64_t GetLastUsedFrame() const {
+    return m_LastUsedFrame.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Gets the size of the device memory used by the loaded image.
+   * @return The size in bytes, zero if the image is not ready.
+   */
+  uint64_t GetMemorySize() const {
+    return m_Image ? m_Image->GetMemorySize() : 0;
+  }
+
+  /**
+   * @brief Gets the loaded image.
+   * @return The image, or nullptr if it is not ready yet.
+   */
+  const std::shared_ptr<Image>& GetImage() const {
+    return m_Image;
+  }
+
+  /**
+   * @brief Gets the loading state of the asset.
+   * @return The loading state.
+   */
+  State GetState() const {
+    return m_State.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Checks whether the image has been uploaded and can be drawn.
+   * @return True if the image is ready, false otherwise.
+   */
+  bool IsReady() const {
+    return GetState() == State::Ready;
+  }
+
+  /**
+   * @brief Gets the path of the image file.
+   * @return The path of the image file.
+   */
+  const std::string& GetPath() const {
+    return m_Path;
+  }
+
+  /**
+   * @brief Cancels loading, e.g. when the image scrolls out of view.
+   * @details Work that has not started yet is skipped and a finished decode is not uploaded.
+   * Releasing the last handle to an asset cancels it implicitly. A handle from the
+   * `TextureCache` is shared, so cancelling it cancels the load for every holder.
+   */
+  void Cancel();
+
+ private:
+  friend class AssetLoader;
+
+  std::string m_Path;
+  ImageLoadOptions m_Options;
+  std::atomic<State> m_State{State::Queued};
+  mutable std::atomic<uint64_t> m_LastUsedFrame{0};
+
+  // Written by the decode worker before the state moves to Decoded.
+  ImageData m_Data;
+
+  // Only touched on the main thread.
+  std::shared_ptr<Image> m_Image;
+  VkDescriptorSet m_Placeholder = VK_NULL_HANDLE;
+};
+
+/**
+ * @class AssetLoader
+ * @brief Decodes images on worker threads and uploads them on the main thread.
+ */
+class AssetLoader {
+ public:
+  /**
+   * @brief Constructs a new AssetLoader and starts its decode workers.
+   * @param worker_count The number of decode workers, zero for automatic sizing.
+   */
+  explicit AssetLoader(uint32_t worker_count = 0);
+  /**
+   * @brief Destroys the AssetLoader. Pending loads are abandoned.
+   */
+  ~AssetLoader();
+
+  /**
+   * @brief Starts loading an image file and returns immediately.
+   * @param path The path to the image file.
+   * @param options Controls the GPU format chosen for the decoded pixels.
+   * @return A handle that draws a placeholder until the image is ready.
+   */
+  std::shared_ptr<ImageAsset> LoadImage(
+      std::string_view path, const ImageLoadOptions& options = ImageLoadOptions());
+
+  /**
+   * @brief Uploads decoded images to the GPU. Must be called on the main thread.
+   * @details Called by the `Canvas` once per frame.
+   * @param max_uploads The maximum number of images uploaded by this call. Remaining images
+   * are uploaded on subsequent calls so large batches do not stall a single frame.
+   */
+  void ProcessUploads(uint32_t max_uploads);
+
+  /**
+   * @brief Checks if images are being decoded or wait to be uploaded. Main thread only.
+   * @return True if loads are in progress.
+   */
+  bool HasPendingLoads();
+
+  /**
+   * @brief Gets the descriptor set of the placeholder texture.
+   * @return The Vulkan descriptor set.
+   */
+  VkDescriptorSet GetPlaceholder() const {
+    return m_Placeholder->GetDescriptorSet();
+  }
+
+ private:
+  /**
+   * @brief Decodes an asset on a worker thread.
+   * @param weak_asset The asset to decode.
+   */
+  void DecodeAsset(const std::weak_ptr<ImageAsset>& weak_asset);
+
+ private:
+  std::unique_ptr<Image> m_Placeholder;
+
+  std::mutex m_DecodedMutex;
+  std::vector<std::weak_ptr<ImageAsset>> m_Decoded;
+  std::vector<std::weak_ptr<ImageAsset>> m_PendingUploads;
+  std::atomic<uint32_t> m_Decoding{0};  // Decodes submitted to the workers and not finished.
+
+  // Declared last so the workers are joined before the queues above are destroyed.
+  ThreadPool m_Workers;
+};
+
+}  // namespace Weaver
+
+#endif
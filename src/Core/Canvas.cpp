@@ -1,6 +1,20 @@
 #include "Canvas.h"
 
+#include "AssetLoader.h"
+#include "CommandRecorder.h"
+#include "Coroutine.h"
+#include "GpuTimeline.h"
+#include "JobSystem.h"
+#include "LayerScheduler.h"
 #include "Log.h"
+#include "MpscQueue.h"
+#include "Profiler.h"
+#include "ReadbackQueue.h"
+#include "SamplerCache.h"
+#include "TaskGraph.h"
+#include "TextureCache.h"
+#include "Timers.h"
+#include "UploadQueue.h"
 #include "Themes.h"
 #include "Common/Settings.h"
 
@@ -32,8 +46,13 @@
 #include <stdlib.h>  // abort
 #include <vulkan/vulkan.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <mutex>
 
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_vulkan.h"
@@ -90,14 +109,62 @@ uint32_t g_CommandBufferSize = Weaver::Settings::Rendering::COMMAND_BUFFER_SIZE;
 static ImGui_ImplVulkanH_Window g_MainWindowData;
 static uint32_t g_MinImageCount = 2;
 static bool g_SwapChainRebuild = false;
+static bool g_PreferSoftwareRenderer = false;
+
+// Set when the device supports VK_KHR_dynamic_rendering and the application did not opt out. The
+// frame is then rendered without a VkRenderPass or per-image VkFramebuffers.
+static bool g_PreferDynamicRendering = true;
+static bool g_UseDynamicRendering = false;
+#ifdef VK_KHR_dynamic_rendering
+static PFN_vkCmdBeginRenderingKHR g_CmdBeginRendering = nullptr;
+static PFN_vkCmdEndRenderingKHR g_CmdEndRendering = nullptr;
+#endif
 
-// Per-frame-in-flight
-static std::vector<std::vector<VkCommandBuffer>> s_AllocatedCommandBuffers;
-static std::vector<std::vector<std::function<void()>>> s_ResourceFreeQueue;
-
-// Unlike g_MainWindowData.FrameIndex, this is not the the swapchain image index
-// and is always guaranteed to increase (eg. 0, 1, 2, 0, 1, 2)
-static uint32_t s_CurrentFrameIndex = 0;
+// Set when the device supports VK_KHR_timeline_semaphore. Otherwise GpuTimeline emulates the
+// timeline with fences.
+static bool g_UseTimelineSemaphore = false;
+
+// Resources freed from any thread. Before recording a frame the main thread moves them into
+// s_ResourceFreeQueue, tagged with that frame, and frees them once the frame has completed.
+// Anything the freed resource was used by is executed in that frame or an earlier one.
+using ResourceFree = std::pair<uint64_t, std::function<void()>>;
+static Weaver::MpscQueue<std::function<void()>> s_ResourceFreeSubmissions;
+static std::vector<ResourceFree> s_ResourceFreeQueue;
+
+// GPU work recorded ahead of the UI render pass of the current frame.
+static std::mutex s_ComputeMutex;
+static std::vector<std::function<void(VkCommandBuffer)>> s_ComputeQueue;
+
+// Serializes access to g_Queue, which Vulkan requires to be externally synchronized.
+static std::mutex s_QueueMutex;
+
+// Number of frames rendered, used to track when textures were last drawn. Read by worker threads.
+static std::atomic<uint64_t> s_FrameCount{0};
+static std::atomic<uint32_t> s_FramesInFlight{0};
+
+// The timeline value of the last submission that rendered into each swapchain image, and of the
+// last rendered frame, which the low-latency mode waits for before polling input.
+static std::vector<uint64_t> s_BackbufferTimelineValues;
+static uint64_t s_LastFrameTimelineValue = 0;
+// The last timeline value submitted in each frame that has not completed yet, and the number of
+// frames that have completed. Only the main thread touches the deque.
+static std::deque<std::pair<uint64_t, uint64_t>> s_FrameTimelineValues;
+static std::atomic<uint64_t> s_CompletedFrameCount{0};
+
+// Tasks posted to the main thread. Posts that find the ring full go to the overflow queue, which
+// allocates but never blocks the poster. s_MainThreadOverflowCount counts the overflowed tasks
+// that have not run yet; while it is non-zero every post overflows, so tasks keep their order.
+static Weaver::BoundedMpscQueue<Weaver::Canvas::MainThreadTask,
+    Weaver::Settings::Rendering::MAIN_THREAD_QUEUE_CAPACITY>
+    s_MainThreadTasks;
+static Weaver::MpscQueue<Weaver::Canvas::MainThreadTask> s_MainThreadOverflow;
+static std::atomic<size_t> s_MainThreadOverflowCount{0};
+
+// On-demand rendering sleeps in SDL_WaitEventTimeout. A posted task wakes it with an SDL event of
+// this type; s_WakePending keeps posts from flooding the SDL queue.
+static std::atomic<bool> s_OnDemandRendering{false};
+static std::atomic<bool> s_WakePending{false};
+static Uint32 s_WakeEventType = (Uint32)-1;
 
 static Weaver::Canvas* s_Instance = nullptr;
 
@@ -165,6 +232,63 @@ static bool IsExtensionAvailable(
   return false;
 }
 
+/**
+ * @brief Queries extension features of the selected physical device.
+ * @param features The feature structure to fill in.
+ * @return False if the query is not available.
+ */
+static bool SetupVulkan_QueryFeatures(void* features) {
+  // The feature query needs VK_KHR_get_physical_device_properties2, which is enabled if present.
+  auto f_vkGetPhysicalDeviceFeatures2KHR =
+      (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(
+          g_Instance, "vkGetPhysicalDeviceFeatures2KHR");
+  if (!f_vkGetPhysicalDeviceFeatures2KHR)
+    return false;
+
+  VkPhysicalDeviceFeatures2KHR features2 = {};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+  features2.pNext = features;
+  f_vkGetPhysicalDeviceFeatures2KHR(g_PhysicalDevice, &features2);
+  return true;
+}
+
+/**
+ * @brief Checks if the selected physical device can render without render passes.
+ * @param properties The extensions of the physical device.
+ * @return True if `VK_KHR_dynamic_rendering` and its feature are supported.
+ */
+static bool SetupVulkan_SupportsDynamicRendering(
+    const ImVector<VkExtensionProperties>& properties) {
+#ifdef VK_KHR_dynamic_rendering
+  if (!IsExtensionAvailable(properties, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+    return false;
+
+  VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering = {};
+  dynamic_rendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+  return SetupVulkan_QueryFeatures(&dynamic_rendering) &&
+         dynamic_rendering.dynamicRendering == VK_TRUE;
+#else
+  (void)properties;
+  return false;
+#endif
+}
+
+/**
+ * @brief Checks if the selected physical device supports timeline semaphores.
+ * @param properties The extensions of the physical device.
+ * @return True if `VK_KHR_timeline_semaphore` and its feature are supported.
+ */
+static bool SetupVulkan_SupportsTimelineSemaphore(
+    const ImVector<VkExtensionProperties>& properties) {
+  if (!IsExtensionAvailable(properties, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+    return false;
+
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore = {};
+  timeline_semaphore.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+  return SetupVulkan_QueryFeatures(&timeline_semaphore) &&
+         timeline_semaphore.timelineSemaphore == VK_TRUE;
+}
+
 static VkPhysicalDevice SetupVulkan_SelectPhysicalDevice() {
   uint32_t gpu_count;
   VkResult err = vkEnumeratePhysicalDevices(g_Instance, &gpu_count, nullptr);
@@ -176,6 +300,16 @@ static VkPhysicalDevice SetupVulkan_SelectPhysicalDevice() {
   err = vkEnumeratePhysicalDevices(g_Instance, &gpu_count, gpus.Data);
   check_vk_result(err);
 
+  // Software implementations are only picked on request, they are much slower than any GPU.
+  if (g_PreferSoftwareRenderer) {
+    for (VkPhysicalDevice& device : gpus) {
+      VkPhysicalDeviceProperties properties;
+      vkGetPhysicalDeviceProperties(device, &properties);
+      if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+        return device;
+    }
+  }
+
   // If a number >1 of GPUs got reported, find discrete GPU if present, or use first one available.
   // This covers most common cases (multi-gpu/integrated+dedicated graphics). Handling more
   // complicated setups (multiple dedicated GPUs) is out of scope of this sample.
@@ -298,15 +432,70 @@ static void SetupVulkan(ImVector<const char*> instance_extensions) {
     queue_info[0].queueFamilyIndex = g_QueueFamily;
     queue_info[0].queueCount = 1;
     queue_info[0].pQueuePriorities = queue_priority;
+    // Anisotropic filtering is opt-in per sampler, see SamplerCache.
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(g_PhysicalDevice, &supported_features);
+    VkPhysicalDeviceFeatures enabled_features = {};
+    enabled_features.samplerAnisotropy = supported_features.samplerAnisotropy;
+
     VkDeviceCreateInfo create_info = {};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    // The feature structures of the enabled extensions.
+    void* features_chain = nullptr;
+
+    // Render without render passes and framebuffers where possible, otherwise fall back to them.
+    g_UseDynamicRendering =
+        g_PreferDynamicRendering && SetupVulkan_SupportsDynamicRendering(properties);
+#ifdef VK_KHR_dynamic_rendering
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering = {};
+    dynamic_rendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamic_rendering.dynamicRendering = VK_TRUE;
+    if (g_UseDynamicRendering) {
+      device_extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+      // Its dependencies, which a Vulkan 1.0 instance has to enable explicitly.
+      const char* dependencies[] = {VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+          VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+          VK_KHR_MULTIVIEW_EXTENSION_NAME,
+          VK_KHR_MAINTENANCE2_EXTENSION_NAME};
+      for (const char* dependency : dependencies) {
+        if (IsExtensionAvailable(properties, dependency))
+          device_extensions.push_back(dependency);
+      }
+      dynamic_rendering.pNext = features_chain;
+      features_chain = &dynamic_rendering;
+    }
+#endif
+
+    // Every submission signals one timeline semaphore, see GpuTimeline.
+    g_UseTimelineSemaphore = SetupVulkan_SupportsTimelineSemaphore(properties);
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore = {};
+    timeline_semaphore.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timeline_semaphore.timelineSemaphore = VK_TRUE;
+    if (g_UseTimelineSemaphore) {
+      device_extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+      timeline_semaphore.pNext = features_chain;
+      features_chain = &timeline_semaphore;
+    }
+    create_info.pNext = features_chain;
+
     create_info.queueCreateInfoCount = sizeof(queue_info) / sizeof(queue_info[0]);
     create_info.pQueueCreateInfos = queue_info;
     create_info.enabledExtensionCount = (uint32_t)device_extensions.Size;
     create_info.ppEnabledExtensionNames = device_extensions.Data;
+    create_info.pEnabledFeatures = &enabled_features;
     err = vkCreateDevice(g_PhysicalDevice, &create_info, g_Allocator, &g_Device);
     check_vk_result(err);
     vkGetDeviceQueue(g_Device, g_QueueFamily, 0, &g_Queue);
+
+#ifdef VK_KHR_dynamic_rendering
+    if (g_UseDynamicRendering) {
+      g_CmdBeginRendering =
+          (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(g_Device, "vkCmdBeginRenderingKHR");
+      g_CmdEndRendering =
+          (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(g_Device, "vkCmdEndRenderingKHR");
+      g_UseDynamicRendering = g_CmdBeginRendering && g_CmdEndRendering;
+    }
+#endif
   }
 
   // Create Descriptor Pool
@@ -394,7 +583,9 @@ static void SetupVulkanWindow(
       g_PhysicalDevice, wd->Surface, &present_modes[0], IM_ARRAYSIZE(present_modes));
   // printf("[vulkan] Selected PresentMode = %d\n", wd->PresentMode);
 
-  // Create SwapChain, RenderPass, Framebuffer, etc.
+  // Create SwapChain, RenderPass, Framebuffer, etc. With dynamic rendering only the swapchain and
+  // its image views are created, so a resize does not rebuild a render pass or framebuffers.
+  wd->UseDynamicRendering = g_UseDynamicRendering;
   IM_ASSERT(g_MinImageCount >= 2);
   ImGui_ImplVulkanH_CreateOrResizeWindow(g_Instance,
       g_PhysicalDevice,
@@ -426,7 +617,151 @@ static void CleanupVulkanWindow() {
   ImGui_ImplVulkanH_DestroyWindow(g_Instance, g_Device, &g_MainWindowData, g_Allocator);
 }
 
+/**
+ * @brief Checks if work was submitted with `Canvas::SubmitCompute` since the last frame.
+ * @return True if work is queued.
+ */
+static bool HasComputeWork() {
+  std::lock_guard<std::mutex> lock(s_ComputeMutex);
+  return !s_ComputeQueue.empty();
+}
+
+/**
+ * @brief Records and clears the work submitted with `Canvas::SubmitCompute`.
+ * @param command_buffer The command buffer to record into.
+ */
+static void RecordComputeQueue(VkCommandBuffer command_buffer) {
+  std::vector<std::function<void(VkCommandBuffer)>> queue;
+  {
+    std::lock_guard<std::mutex> lock(s_ComputeMutex);
+    queue.swap(s_ComputeQueue);
+  }
+  for (auto& func : queue)
+    func(command_buffer);
+}
+
+/**
+ * @brief Moves the resources freed since the last call into the free queue, tagged with the
+ * current frame. Called before the frame's command buffer is recorded.
+ */
+static void CollectResourceFrees() {
+  std::vector<std::function<void()>> submissions;
+  s_ResourceFreeSubmissions.PopAll(submissions);
+  const uint64_t frame = s_FrameCount.load();
+  for (auto& func : submissions)
+    s_ResourceFreeQueue.emplace_back(frame, std::move(func));
+}
+
+/**
+ * @brief Frees the resources whose frame has completed.
+ * @param all Whether to free every resource, once the device is idle.
+ */
+static void FlushResourceFreeQueue(bool all) {
+  auto remaining = s_ResourceFreeQueue.begin();
+  for (auto it = s_ResourceFreeQueue.begin(); it != s_ResourceFreeQueue.end(); ++it) {
+    if (all || Weaver::Canvas::IsFrameComplete(it->first))
+      it->second();
+    else
+      *remaining++ = std::move(*it);
+  }
+  s_ResourceFreeQueue.erase(remaining, s_ResourceFreeQueue.end());
+}
+
+/**
+ * @brief Records the last timeline value of the current frame and advances the completed frames.
+ * @param timeline The timeline.
+ */
+static void UpdateFrameTimeline(Weaver::GpuTimeline& timeline) {
+  s_FrameTimelineValues.emplace_back(s_FrameCount.load(), timeline.GetSubmittedValue());
+  const uint64_t completed = timeline.GetCompletedValue();
+  while (!s_FrameTimelineValues.empty() && s_FrameTimelineValues.front().second <= completed) {
+    s_CompletedFrameCount = s_FrameTimelineValues.front().first + 1;
+    s_FrameTimelineValues.pop_front();
+  }
+}
+
+/**
+ * @brief Transitions a swapchain image between layouts around the UI rendering.
+ * @param command_buffer The command buffer to record into.
+ * @param image The swapchain image.
+ * @param to_attachment True to prepare the image for rendering, false to prepare it for present.
+ */
+static void TransitionBackbuffer(
+    VkCommandBuffer command_buffer, VkImage image, bool to_attachment) {
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = to_attachment ? 0 : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  barrier.dstAccessMask = to_attachment ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0;
+  barrier.oldLayout =
+      to_attachment ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  barrier.newLayout =
+      to_attachment ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = 1;
+  // The acquire semaphore is waited for at the color attachment output stage.
+  vkCmdPipelineBarrier(command_buffer,
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      to_attachment ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                    : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      0,
+      0,
+      NULL,
+      0,
+      NULL,
+      1,
+      &barrier);
+}
+
+/**
+ * @brief Begins rendering the UI into a swapchain image without a render pass.
+ * @param wd The window.
+ * @param fd The frame being rendered.
+ */
+static void BeginDynamicRendering(ImGui_ImplVulkanH_Window* wd, ImGui_ImplVulkanH_Frame* fd) {
+#ifdef VK_KHR_dynamic_rendering
+  TransitionBackbuffer(fd->CommandBuffer, fd->Backbuffer, true);
+
+  VkRenderingAttachmentInfoKHR color_attachment = {};
+  color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+  color_attachment.imageView = fd->BackbufferView;
+  color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+  color_attachment.clearValue = wd->ClearValue;
+
+  VkRenderingInfoKHR info = {};
+  info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+  info.renderArea.extent.width = wd->Width;
+  info.renderArea.extent.height = wd->Height;
+  info.layerCount = 1;
+  info.colorAttachmentCount = 1;
+  info.pColorAttachments = &color_attachment;
+  g_CmdBeginRendering(fd->CommandBuffer, &info);
+#else
+  (void)wd;
+  (void)fd;
+#endif
+}
+
+/**
+ * @brief Ends rendering the UI and prepares the swapchain image for presentation.
+ * @param fd The frame being rendered.
+ */
+static void EndDynamicRendering(ImGui_ImplVulkanH_Frame* fd) {
+#ifdef VK_KHR_dynamic_rendering
+  g_CmdEndRendering(fd->CommandBuffer);
+  TransitionBackbuffer(fd->CommandBuffer, fd->Backbuffer, false);
+#else
+  (void)fd;
+#endif
+}
+
 static void FrameRender(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data) {
+  WEAVER_PROFILE_SCOPE("Render");
   VkResult err;
 
   VkSemaphore image_acquired_semaphore =
@@ -446,17 +781,8 @@ static void FrameRender(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data) {
   check_vk_result(err);
 
   ImGui_ImplVulkanH_Frame* fd = &wd->Frames[wd->FrameIndex];
-  {
-    err = vkWaitForFences(g_Device,
-        1,
-        &fd->Fence,
-        VK_TRUE,
-        UINT64_MAX);  // wait indefinitely instead of periodically checking
-    check_vk_result(err);
-
-    err = vkResetFences(g_Device, 1, &fd->Fence);
-    check_vk_result(err);
-  }
+  // Wait only for the last submission that used this image, not for the whole queue.
+  Weaver::Canvas::WaitForTimelineValue(s_BackbufferTimelineValues[wd->FrameIndex]);
   {
     err = vkResetCommandPool(g_Device, fd->CommandPool, 0);
     check_vk_result(err);
@@ -466,7 +792,17 @@ static void FrameRender(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data) {
     err = vkBeginCommandBuffer(fd->CommandBuffer, &info);
     check_vk_result(err);
   }
-  {
+
+  // Uploads, work recorded on other threads and compute work run before the UI that samples
+  // their results.
+  Weaver::Canvas& canvas = Weaver::Canvas::Get();
+  canvas.GetUploadQueue().Record(fd->CommandBuffer);
+  canvas.GetCommandRecorder().Execute(fd->CommandBuffer);
+  RecordComputeQueue(fd->CommandBuffer);
+
+  if (g_UseDynamicRendering) {
+    BeginDynamicRendering(wd, fd);
+  } else {
     VkRenderPassBeginInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     info.renderPass = wd->RenderPass;
@@ -482,7 +818,10 @@ static void FrameRender(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data) {
   ImGui_ImplVulkan_RenderDrawData(draw_data, fd->CommandBuffer);
 
   // Submit command buffer
-  vkCmdEndRenderPass(fd->CommandBuffer);
+  if (g_UseDynamicRendering)
+    EndDynamicRendering(fd);
+  else
+    vkCmdEndRenderPass(fd->CommandBuffer);
   {
     VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     VkSubmitInfo info = {};
@@ -497,14 +836,15 @@ static void FrameRender(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data) {
 
     err = vkEndCommandBuffer(fd->CommandBuffer);
     check_vk_result(err);
-    err = vkQueueSubmit(g_Queue, 1, &info, fd->Fence);
-    check_vk_result(err);
+    s_BackbufferTimelineValues[wd->FrameIndex] = Weaver::Canvas::SubmitToQueue(info);
+    s_LastFrameTimelineValue = s_BackbufferTimelineValues[wd->FrameIndex];
   }
 }
 
 static void FramePresent(ImGui_ImplVulkanH_Window* wd) {
   if (g_SwapChainRebuild)
     return;
+  WEAVER_PROFILE_SCOPE("Present");
   VkSemaphore render_complete_semaphore =
       wd->FrameSemaphores[wd->SemaphoreIndex].RenderCompleteSemaphore;
   VkPresentInfoKHR info = {};
@@ -514,7 +854,11 @@ static void FramePresent(ImGui_ImplVulkanH_Window* wd) {
   info.swapchainCount = 1;
   info.pSwapchains = &wd->Swapchain;
   info.pImageIndices = &wd->FrameIndex;
-  VkResult err = vkQueuePresentKHR(g_Queue, &info);
+  VkResult err;
+  {
+    std::lock_guard<std::mutex> lock(s_QueueMutex);
+    err = vkQueuePresentKHR(g_Queue, &info);
+  }
   if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR) {
     g_SwapChainRebuild = true;
     return;
@@ -628,8 +972,24 @@ void Canvas::Init() {
   extensions.resize(extensions_count);
   SDL_Vulkan_GetInstanceExtensions(m_WindowHandle, &extensions_count, extensions.Data);
   WEAVER_LOG_INFO("Vulkan instance extensions retrieved. Calling SetupVulkan...");
+  g_PreferSoftwareRenderer =
+      m_Specification.PreferSoftwareRenderer || getenv("WEAVER_SOFTWARE_RENDERER") != nullptr;
+  g_PreferDynamicRendering = m_Specification.PreferDynamicRendering &&
+                             getenv("WEAVER_DISABLE_DYNAMIC_RENDERING") == nullptr;
+  g_MinImageCount = std::max<uint32_t>(m_Specification.MinImageCount, 2);
+  m_LowLatency = m_Specification.LowLatency || getenv("WEAVER_LOW_LATENCY") != nullptr;
+  s_OnDemandRendering = m_Specification.OnDemandRendering;
+  s_WakeEventType = SDL_RegisterEvents(1);
+
+  // WEAVER_PROFILE=<path> records the whole run and writes a Chrome trace on shutdown.
+  WEAVER_PROFILE_THREAD("Main");
+  if (getenv("WEAVER_PROFILE") != nullptr)
+    Profiler::BeginSession();
+  Timers::SetDumpInterval(Weaver::Settings::Profiling::TIMER_DUMP_INTERVAL);
   SetupVulkan(extensions);
   WEAVER_LOG_INFO("SetupVulkan completed.");
+  WEAVER_LOG_INFO(g_UseDynamicRendering ? "Rendering with VK_KHR_dynamic_rendering."
+                                        : "Rendering with render passes and framebuffers.");
 
   // Create Window Surface
   WEAVER_LOG_INFO("Creating Vulkan surface...");
@@ -650,8 +1010,10 @@ void Canvas::Init() {
   SetupVulkanWindow(wd, surface, w, h);
   WEAVER_LOG_INFO("Vulkan window setup completed.");
 
-  s_AllocatedCommandBuffers.resize(wd->ImageCount);
-  s_ResourceFreeQueue.resize(wd->ImageCount);
+  s_FramesInFlight = wd->ImageCount;
+  s_BackbufferTimelineValues.assign(wd->ImageCount, 0);
+  WEAVER_LOG_INFO("Swapchain created with ")
+      << wd->ImageCount << " images" << (m_LowLatency ? ", low-latency mode enabled." : ".");
 
   // Setup Dear ImGui context
   WEAVER_LOG_INFO("Creating ImGui context...");
@@ -686,6 +1048,15 @@ void Canvas::Init() {
   init_info.PipelineCache = g_PipelineCache;
   init_info.DescriptorPool = g_DescriptorPool;
   init_info.RenderPass = wd->RenderPass;
+#ifdef VK_KHR_dynamic_rendering
+  if (g_UseDynamicRendering) {
+    init_info.UseDynamicRendering = true;
+    init_info.PipelineRenderingCreateInfo.sType =
+        VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    init_info.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+    init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats = &wd->SurfaceFormat.format;
+  }
+#endif
   init_info.Subpass = 0;
   init_info.MinImageCount = g_MinImageCount;
   init_info.ImageCount = wd->ImageCount;
@@ -732,6 +1103,24 @@ void Canvas::Init() {
     abort();
   }
   WEAVER_LOG_INFO("Material Symbols font loaded successfully.");
+
+  // Requires the Vulkan backend for the placeholder texture.
+  m_Timeline = std::make_unique<GpuTimeline>(g_UseTimelineSemaphore);
+  WEAVER_LOG_INFO(m_Timeline->UsesTimelineSemaphore()
+                      ? "Synchronizing submissions with a timeline semaphore."
+                      : "Synchronizing submissions with fences.");
+  m_CommandRecorder = std::make_unique<CommandRecorder>();
+  m_SamplerCache = std::make_unique<SamplerCache>();
+  m_UploadQueue = std::make_unique<UploadQueue>(Weaver::Settings::Rendering::UPLOAD_CHUNK_SIZE,
+      Weaver::Settings::Rendering::UPLOAD_POOL_BUDGET);
+  m_AssetLoader = std::make_unique<AssetLoader>();
+  m_TextureCache = std::make_unique<TextureCache>(*m_AssetLoader,
+      Weaver::Settings::Rendering::TEXTURE_CACHE_BUDGET,
+      Weaver::Settings::Rendering::TEXTURE_CACHE_EVICTION_FRAMES);
+  m_ReadbackQueue =
+      std::make_unique<ReadbackQueue>(Weaver::Settings::Rendering::READBACK_POOL_BUDGET);
+  m_LayerScheduler = std::make_unique<LayerScheduler>(JobSystem::Get());
+  m_Coroutines = std::make_unique<CoroutineScheduler>();
   // io.Fonts->AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
   // ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, nullptr,
   // io.Fonts->GetGlyphRangesJapanese()); IM_ASSERT(font != nullptr); Load default font ImFontConfig
@@ -742,24 +1131,47 @@ void Canvas::Init() {
 }
 
 void Canvas::Shutdown() {
+  // Suspended coroutines may reference layers, so they are destroyed first.
+  m_Coroutines.reset();
+
   for (auto& layer : m_LayerStack)
     layer->OnDetach();
 
   m_LayerStack.clear();
+  m_LayerScheduler.reset();
+
+  m_ReadbackQueue.reset();
+  m_TextureCache.reset();
+  m_AssetLoader.reset();
 
   // Cleanup
-  VkResult err = vkDeviceWaitIdle(g_Device);
+  VkResult err;
+  {
+    std::lock_guard<std::mutex> lock(s_QueueMutex);
+    err = vkDeviceWaitIdle(g_Device);
+  }
   check_vk_result(err);
 
   // Free resources in queue
-  for (auto& queue : s_ResourceFreeQueue) {
-    for (auto& func : queue)
-      func();
-  }
-  s_ResourceFreeQueue.clear();
+  CollectResourceFrees();
+  FlushResourceFreeQueue(true);
+  s_ComputeQueue.clear();
+
+  m_CommandRecorder.reset();
+  m_UploadQueue.reset();
+  m_SamplerCache.reset();
+  m_Timeline.reset();
 
   ImGui_ImplVulkan_Shutdown();
   ImGui_ImplSDL2_Shutdown();
+
+  if (const char* trace_path = getenv("WEAVER_PROFILE")) {
+    Profiler::EndSession();
+    if (Profiler::WriteChromeTrace(trace_path))
+      WEAVER_LOG_INFO("Profile written to ") << trace_path;
+    else
+      WEAVER_LOG_ERROR("Failed to write the profile to ") << trace_path;
+  }
   ImGui::DestroyContext();
 
   CleanupVulkanWindow();
@@ -781,38 +1193,81 @@ void Canvas::Run() {
   // New Main Loop
   bool done = false;
   while (!done && m_Running) {
+    // Once nothing has happened for a few frames, on-demand rendering sleeps until an event
+    // arrives, a task is posted, the next coroutine delay ends, or the timeout lets timers
+    // advance.
+    if (s_OnDemandRendering && m_IdleFrames >= Weaver::Settings::Rendering::ON_DEMAND_IDLE_FRAMES) {
+      int timeout = Weaver::Settings::Rendering::ON_DEMAND_TIMEOUT_MS;
+      const auto next_resume = m_Coroutines->GetNextResumeTime();
+      if (next_resume != CoroutineScheduler::Clock::time_point::max()) {
+        const auto until = std::chrono::ceil<std::chrono::milliseconds>(
+            next_resume - CoroutineScheduler::Clock::now());
+        timeout = (int)std::clamp<int64_t>(until.count(), 0, timeout);
+      }
+      SDL_WaitEventTimeout(nullptr, timeout);
+    }
+
+    // In low-latency mode the previous frame is finished before input is polled, so the UI is
+    // built from input that is at most one frame old when it reaches the GPU.
+    if (m_LowLatency)
+      WaitForTimelineValue(s_LastFrameTimelineValue);
+    const uint64_t input_time = SDL_GetPerformanceCounter();
+    const auto frame_start = std::chrono::steady_clock::now();
+    WEAVER_PROFILE_FRAME(s_FrameCount);
+    WEAVER_PROFILE_SCOPE("Frame");
+
     // Poll and handle events (inputs, window resize, etc.)
-    SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-      ImGui_ImplSDL2_ProcessEvent(&event);
-      if (event.type == SDL_QUIT)
-        done = true;
-      if (event.type == SDL_WINDOWEVENT) {
-        if (event.window.event == SDL_WINDOWEVENT_CLOSE &&
-            event.window.windowID == SDL_GetWindowID(m_WindowHandle))
-          done = true;
-        if (event.window.event == SDL_WINDOWEVENT_RESIZED)
-          g_SwapChainRebuild = true;
-        if (event.window.event == SDL_WINDOWEVENT_MINIMIZED) {
-          for (auto& layer : m_LayerStack)
-            layer->OnMinimize();
-        }
-        if (event.window.event == SDL_WINDOWEVENT_MAXIMIZED) {
-          for (auto& layer : m_LayerStack)
-            layer->OnMaximize();
+    bool active = false;
+    {
+      WEAVER_PROFILE_SCOPE("Poll");
+      SDL_Event event;
+      while (SDL_PollEvent(&event)) {
+        active = true;
+        if (event.type == s_WakeEventType) {
+          s_WakePending = false;
+          continue;
         }
-        if (event.window.event == SDL_WINDOWEVENT_RESTORED) {
-          for (auto& layer : m_LayerStack)
-            layer->OnRestored();
+        ImGui_ImplSDL2_ProcessEvent(&event);
+        if (event.type == SDL_QUIT)
+          done = true;
+        if (event.type == SDL_WINDOWEVENT) {
+          if (event.window.event == SDL_WINDOWEVENT_CLOSE &&
+              event.window.windowID == SDL_GetWindowID(m_WindowHandle))
+            done = true;
+          if (event.window.event == SDL_WINDOWEVENT_RESIZED)
+            g_SwapChainRebuild = true;
         }
+        PublishEvent(event);
       }
+      DispatchEvents();
     }
 
-    for (auto& layer : m_LayerStack)
-      layer->OnUpdate(m_TimeStep);
+    {
+      WEAVER_PROFILE_SCOPE("Update");
+      // Tasks posted from other threads run next, then coroutines resume, before the layers
+      // update.
+      active |= RunMainThreadTasks() > 0;
+      active |= m_Coroutines->ResumeReady(s_CompletedFrameCount.load()) > 0;
+      // Work that only advances while frames are rendered keeps the loop awake as well.
+      active |= m_Coroutines->IsWaitingForFrames();
+      active |= m_UploadQueue->HasPendingUploads();
+      active |= m_ReadbackQueue->GetPendingCount() > 0;
+      active |= m_AssetLoader->HasPendingLoads();
+      m_IdleFrames = active ? 0 : m_IdleFrames + 1;
+
+      m_AssetLoader->ProcessUploads(Weaver::Settings::Rendering::MAX_IMAGE_UPLOADS_PER_FRAME);
+
+      // Layers that declared their data update concurrently, joined before the UI is built.
+      m_LayerScheduler->Update(m_LayerStack);
+      RunTaskGraphs(frame_start +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<float, std::milli>(
+                            Weaver::Settings::Rendering::TASK_GRAPH_DEADLINE_MS)));
+    }
 
     // Resize swap chain?
     if (g_SwapChainRebuild) {
+      WEAVER_PROFILE_SCOPE("Rebuild Swapchain");
       int width, height;
       SDL_GetWindowSize(m_WindowHandle, &width, &height);
 
@@ -835,33 +1290,33 @@ void Canvas::Run() {
             g_MinImageCount);
         g_MainWindowData.FrameIndex = 0;
 
-        // Notify layers of resize
-        for (auto& layer : m_LayerStack) {
-          layer->OnResize(width, height);
-        }
+        // Delivered to the layers with the next frame's events, once the swap chain matches.
+        m_EventBus.Publish(WindowResizeEvent{(uint32_t)width, (uint32_t)height});
 
-        s_AllocatedCommandBuffers.clear();
-        s_AllocatedCommandBuffers.resize(g_MainWindowData.ImageCount);
-        s_ResourceFreeQueue.clear();
-        s_ResourceFreeQueue.resize(g_MainWindowData.ImageCount);
+        s_FramesInFlight = g_MainWindowData.ImageCount;
+        s_BackbufferTimelineValues.assign(g_MainWindowData.ImageCount, 0);
 
-        vkDeviceWaitIdle(g_Device);
+        {
+          std::lock_guard<std::mutex> lock(s_QueueMutex);
+          vkDeviceWaitIdle(g_Device);
+        }
         g_SwapChainRebuild = false;
       }
     }
 
     if (m_restore_in_progress && !g_SwapChainRebuild) {
-      for (auto& layer : m_LayerStack)
-        layer->OnRestored();
+      m_EventBus.Publish(WindowRestoreEvent{});
       m_restore_in_progress = false;
     }
 
-    // Start the Dear ImGui frame
-    ImGui_ImplVulkan_NewFrame();
-    ImGui_ImplSDL2_NewFrame();
-    ImGui::NewFrame();
-
     {
+      WEAVER_PROFILE_SCOPE("Build UI");
+
+      // Start the Dear ImGui frame
+      ImGui_ImplVulkan_NewFrame();
+      ImGui_ImplSDL2_NewFrame();
+      ImGui::NewFrame();
+
       static ImGuiDockNodeFlags dockspace_flags = ImGuiDockNodeFlags_None;
 
       ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDocking;
@@ -912,6 +1367,9 @@ void Canvas::Run() {
       ImGui::End();
     }
 
+    // Resources freed up to here may be used by the work recorded into this frame.
+    CollectResourceFrees();
+
     // Rendering
     ImGui::Render();
     ImDrawData* main_draw_data = ImGui::GetDrawData();
@@ -926,16 +1384,46 @@ void Canvas::Run() {
 
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
       ImGui::UpdatePlatformWindows();
-      ImGui::RenderPlatformWindowsDefault();
+      {
+        std::lock_guard<std::mutex> lock(s_QueueMutex);
+        ImGui::RenderPlatformWindowsDefault();
+      }
+      // The platform windows submit with fences of their own. An empty batch after them makes
+      // the frame's timeline value cover their draws too.
+      if (ImGui::GetPlatformIO().Viewports.Size > 1) {
+        VkSubmitInfo info = {};
+        info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        SubmitToQueue(info);
+      }
     }
 
-    if (!main_is_minimized)
+    if (!main_is_minimized) {
       FramePresent(wd);
+      if (!g_SwapChainRebuild) {
+        const float latency = (float)(SDL_GetPerformanceCounter() - input_time) * 1000.0f /
+                              (float)SDL_GetPerformanceFrequency();
+        m_InputLatency = m_InputLatency > 0.0f ? m_InputLatency * 0.9f + latency * 0.1f : latency;
+      }
+    }
 
-    float time = GetTime();
-    m_FrameTime = time - m_LastFrameTime;
-    m_TimeStep = glm::min<float>(m_FrameTime, 0.0333f);
-    m_LastFrameTime = time;
+    // The frame was not rendered, submit its uploads and recorded work on their own.
+    if (m_UploadQueue->HasPendingUploads() || m_CommandRecorder->HasSubmissions() ||
+        HasComputeWork()) {
+      VkCommandBuffer command_buffer = GetCommandBuffer(true);
+      m_UploadQueue->Record(command_buffer);
+      m_CommandRecorder->Execute(command_buffer);
+      RecordComputeQueue(command_buffer);
+      FlushCommandBuffer(command_buffer);
+    }
+
+    // Readbacks are submitted after the frame, so they see its uploads and compute work.
+    m_ReadbackQueue->Update();
+
+    m_TextureCache->Update(s_FrameCount);
+    UpdateFrameTimeline(*m_Timeline);
+    FlushResourceFreeQueue(false);
+    Timers::Update();
+    s_FrameCount++;
   }
 }
 
@@ -944,7 +1432,7 @@ void Canvas::Close() {
 }
 
 float Canvas::GetTime() {
-  return (float)SDL_GetTicks();
+  return (float)SDL_GetTicks() / 1000.0f;
 }
 
 void Canvas::Minimize() {
@@ -960,8 +1448,7 @@ void Canvas::ToggleMaximize() {
     m_restore_in_progress = true;
   } else {
     // Maximize
-    for (auto& layer : m_LayerStack)
-      layer->OnMaximize();
+    m_EventBus.Publish(WindowMaximizeEvent{});
     SDL_GetWindowPosition(m_WindowHandle, &m_SavedWindowRect.x, &m_SavedWindowRect.y);
     SDL_GetWindowSize(m_WindowHandle, &m_SavedWindowRect.w, &m_SavedWindowRect.h);
 
@@ -975,6 +1462,157 @@ void Canvas::ToggleMaximize() {
   }
 }
 
+const std::vector<float>& Canvas::GetLayerUpdateTimes() const {
+  return m_LayerScheduler->GetUpdateTimes();
+}
+
+void Canvas::PublishEvent(const SDL_Event& event) {
+  // Set by the previous ImGui frame. Layers decide whether captured input concerns them.
+  const ImGuiIO& io = ImGui::GetIO();
+  const bool keyboard_captured = io.WantCaptureKeyboard;
+  const bool mouse_captured = io.WantCaptureMouse;
+
+  switch (event.type) {
+    case SDL_WINDOWEVENT:
+      if (event.window.windowID != SDL_GetWindowID(m_WindowHandle))
+        break;
+      if (event.window.event == SDL_WINDOWEVENT_MINIMIZED)
+        m_EventBus.Publish(WindowMinimizeEvent{});
+      else if (event.window.event == SDL_WINDOWEVENT_MAXIMIZED)
+        m_EventBus.Publish(WindowMaximizeEvent{});
+      else if (event.window.event == SDL_WINDOWEVENT_RESTORED)
+        m_EventBus.Publish(WindowRestoreEvent{});
+      break;
+    case SDL_KEYDOWN:
+      m_EventBus.Publish(KeyPressedEvent{
+          (KeyCode)event.key.keysym.scancode, event.key.repeat != 0, keyboard_captured});
+      break;
+    case SDL_KEYUP:
+      m_EventBus.Publish(
+          KeyReleasedEvent{(KeyCode)event.key.keysym.scancode, keyboard_captured});
+      break;
+    case SDL_MOUSEMOTION:
+      m_EventBus.Publish(MouseMovedEvent{(float)event.motion.x,
+          (float)event.motion.y,
+          (float)event.motion.xrel,
+          (float)event.motion.yrel,
+          mouse_captured});
+      break;
+    case SDL_MOUSEBUTTONDOWN:
+      m_EventBus.Publish(MouseButtonPressedEvent{(MouseButton)event.button.button,
+          (float)event.button.x,
+          (float)event.button.y,
+          mouse_captured});
+      break;
+    case SDL_MOUSEBUTTONUP:
+      m_EventBus.Publish(MouseButtonReleasedEvent{(MouseButton)event.button.button,
+          (float)event.button.x,
+          (float)event.button.y,
+          mouse_captured});
+      break;
+    case SDL_MOUSEWHEEL:
+      m_EventBus.Publish(
+          MouseScrolledEvent{(float)event.wheel.x, (float)event.wheel.y, mouse_captured});
+      break;
+    default:
+      break;
+  }
+}
+
+void Canvas::DispatchEvents() {
+  m_EventListeners.clear();
+  for (auto it = m_LayerStack.rbegin(); it != m_LayerStack.rend(); ++it)
+    m_EventListeners.push_back(&(*it)->GetEventListener());
+  m_EventBus.Dispatch(m_EventListeners);
+}
+
+size_t Canvas::RunMainThreadTasks() {
+  // Only the tasks queued now, so tasks that post tasks cannot keep the frame from finishing.
+  // The overflow is taken first: a task that reached the ring after it was taken may be older
+  // than a task that overflowed after it, and both then wait for the next frame.
+  std::vector<MainThreadTask> overflow;
+  if (s_MainThreadOverflowCount.load() > 0)
+    s_MainThreadOverflow.PopAll(overflow);
+  const size_t count = s_MainThreadTasks.GetSize();
+
+  // Posts may use the ring again once the taken tasks are counted out, before any of them runs,
+  // so a task that throws cannot leave posting stuck on the overflow. Tasks that reach the ring
+  // from now on are beyond `count` and run next frame, after the overflowed tasks.
+  if (!overflow.empty())
+    s_MainThreadOverflowCount.fetch_sub(overflow.size());
+
+  // Tasks in the ring were posted before any task in the overflow.
+  size_t executed = 0;
+  MainThreadTask task;
+  while (executed < count && s_MainThreadTasks.TryPop(task)) {
+    task();
+    task.Reset();
+    executed++;
+  }
+  for (MainThreadTask& overflow_task : overflow)
+    overflow_task();
+  return executed + overflow.size();
+}
+
+void Canvas::PostToMainThread(MainThreadTask task) {
+  if (s_MainThreadOverflowCount.load() > 0 || !s_MainThreadTasks.TryPush(std::move(task))) {
+    s_MainThreadOverflowCount.fetch_add(1);
+    s_MainThreadOverflow.Push(std::move(task));
+  }
+
+  if (s_OnDemandRendering.load(std::memory_order_relaxed) &&
+      s_WakeEventType != (Uint32)-1 && !s_WakePending.exchange(true)) {
+    SDL_Event wake = {};
+    wake.type = s_WakeEventType;
+    SDL_PushEvent(&wake);
+  }
+}
+
+void Canvas::SetOnDemandRendering(bool enabled) {
+  s_OnDemandRendering = enabled;
+  m_IdleFrames = 0;
+}
+
+bool Canvas::IsOnDemandRendering() const {
+  return s_OnDemandRendering;
+}
+
+void Canvas::SubmitTaskGraph(TaskGraph& graph) {
+  std::lock_guard<std::mutex> lock(m_TaskGraphMutex);
+  m_SubmittedTaskGraphs.push_back(&graph);
+}
+
+void Canvas::RunTaskGraphs(std::chrono::steady_clock::time_point deadline) {
+  std::vector<TaskGraph*> graphs;
+  {
+    std::lock_guard<std::mutex> lock(m_TaskGraphMutex);
+    graphs.swap(m_SubmittedTaskGraphs);
+  }
+  if (graphs.empty())
+    return;
+
+  // Start every graph before waiting, so the tasks of all layers share the workers. All graphs
+  // are joined before the first error is rethrown, as their tasks reference layer state.
+  JobSystem& jobs = JobSystem::Get();
+  for (TaskGraph* graph : graphs)
+    graph->Start(jobs, deadline);
+  std::exception_ptr error;
+  for (TaskGraph* graph : graphs) {
+    try {
+      graph->Wait(jobs);
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+uint64_t Canvas::GetFrameCount() {
+  return s_FrameCount;
+}
+
 VkInstance Canvas::GetInstance() {
   return g_Instance;
 }
@@ -987,35 +1625,47 @@ VkDevice Canvas::GetDevice() {
   return g_Device;
 }
 
-VkCommandBuffer Canvas::GetCommandBuffer(bool begin) {
-  ImGui_ImplVulkanH_Window* wd = &g_MainWindowData;
+VkQueue Canvas::GetQueue() {
+  return g_Queue;
+}
 
-  VkCommandPool command_pool = wd->Frames[wd->FrameIndex].CommandPool;
+uint32_t Canvas::GetQueueFamilyIndex() {
+  return g_QueueFamily;
+}
 
-  VkCommandBufferAllocateInfo cmdBufAllocateInfo = {};
-  cmdBufAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  cmdBufAllocateInfo.commandPool = command_pool;
-  cmdBufAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  cmdBufAllocateInfo.commandBufferCount = 1;
+bool Canvas::IsDynamicRenderingEnabled() {
+  return g_UseDynamicRendering;
+}
 
-  VkCommandBuffer command_buffer;
-  auto err = vkAllocateCommandBuffers(g_Device, &cmdBufAllocateInfo, &command_buffer);
-  check_vk_result(err);
+#ifdef VK_KHR_dynamic_rendering
+void Canvas::CmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR& info) {
+  // The entry points are only loaded when dynamic rendering is enabled, so this must also hold
+  // in release builds, where IM_ASSERT is compiled out.
+  if (!g_UseDynamicRendering) {
+    WEAVER_LOG_ERROR("CmdBeginRendering called, but dynamic rendering is not enabled.");
+    return;
+  }
+  g_CmdBeginRendering(commandBuffer, &info);
+}
 
-  if (begin) {
-    VkCommandBufferBeginInfo begin_info = {};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    err = vkBeginCommandBuffer(command_buffer, &begin_info);
-    check_vk_result(err);
+void Canvas::CmdEndRendering(VkCommandBuffer commandBuffer) {
+  if (!g_UseDynamicRendering) {
+    WEAVER_LOG_ERROR("CmdEndRendering called, but dynamic rendering is not enabled.");
+    return;
   }
+  g_CmdEndRendering(commandBuffer);
+}
+#endif
 
-  return command_buffer;
+uint32_t Canvas::GetFramesInFlight() {
+  return s_FramesInFlight;
 }
 
-void Canvas::FlushCommandBuffer(VkCommandBuffer commandBuffer) {
-  const uint64_t DEFAULT_FENCE_TIMEOUT = 100000000000;
+VkCommandBuffer Canvas::GetCommandBuffer(bool begin) {
+  return s_Instance->m_CommandRecorder->AllocatePrimary(begin);
+}
 
+void Canvas::FlushCommandBuffer(VkCommandBuffer commandBuffer) {
   VkSubmitInfo end_info = {};
   end_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   end_info.commandBufferCount = 1;
@@ -1023,24 +1673,38 @@ void Canvas::FlushCommandBuffer(VkCommandBuffer commandBuffer) {
   auto err = vkEndCommandBuffer(commandBuffer);
   check_vk_result(err);
 
-  // Create fence to ensure that the command buffer has finished executing
-  VkFenceCreateInfo fenceCreateInfo = {};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceCreateInfo.flags = 0;
-  VkFence fence;
-  err = vkCreateFence(g_Device, &fenceCreateInfo, nullptr, &fence);
-  check_vk_result(err);
+  // Wait for this submission only, earlier work on the queue is covered by the same value.
+  WaitForTimelineValue(SubmitToQueue(end_info));
+  s_Instance->m_CommandRecorder->Release(commandBuffer);
+}
 
-  err = vkQueueSubmit(g_Queue, 1, &end_info, fence);
-  check_vk_result(err);
+std::mutex& Canvas::GetQueueMutex() {
+  return s_QueueMutex;
+}
 
-  err = vkWaitForFences(g_Device, 1, &fence, VK_TRUE, DEFAULT_FENCE_TIMEOUT);
-  check_vk_result(err);
+uint64_t Canvas::SubmitToQueue(const VkSubmitInfo& info) {
+  std::lock_guard<std::mutex> lock(s_QueueMutex);
+  return s_Instance->m_Timeline->Submit(g_Queue, info);
+}
+
+bool Canvas::IsTimelineValueComplete(uint64_t value) {
+  return s_Instance->m_Timeline->IsComplete(value);
+}
+
+void Canvas::WaitForTimelineValue(uint64_t value) {
+  s_Instance->m_Timeline->Wait(value);
+}
 
-  vkDestroyFence(g_Device, fence, nullptr);
+bool Canvas::IsFrameComplete(uint64_t frame) {
+  return frame < s_CompletedFrameCount.load();
 }
 
 void Canvas::SubmitResourceFree(std::function<void()>&& func) {
-  s_ResourceFreeQueue[s_CurrentFrameIndex].emplace_back(func);
+  s_ResourceFreeSubmissions.Push(std::move(func));
+}
+
+void Canvas::SubmitCompute(std::function<void(VkCommandBuffer)>&& func) {
+  std::lock_guard<std::mutex> lock(s_ComputeMutex);
+  s_ComputeQueue.emplace_back(std::move(func));
 }
-}  // namespace Weaver
\ No newline at end of file
+}  // namespace Weaver
@@ -16,11 +16,17 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "Coroutine.h"
+#include "EventBus.h"
+#include "Events.h"
+#include "InplaceFunction.h"
 #include "Layer.h"
 
 // #include "imgui.h"
@@ -38,6 +44,16 @@ struct GLFWwindow;
 
 namespace Weaver {
 
+class AssetLoader;
+class CommandRecorder;
+class GpuTimeline;
+class LayerScheduler;
+class ReadbackQueue;
+class SamplerCache;
+class TaskGraph;
+class TextureCache;
+class UploadQueue;
+
 /**
  * @struct CanvasSpecification
  * @brief Defines the specifications for the application canvas.
@@ -47,6 +63,36 @@ struct CanvasSpecification {
   uint32_t Width = 1600;                     /**< The width of the application window. */
   uint32_t Height = 900;                    /**< The height of the application window. */
   short CornerRadius = 12;                  /**< The corner radius of the application window. */
+  /**
+   * Prefer a software (CPU) Vulkan implementation such as lavapipe, e.g. for CI machines without
+   * a GPU. Also enabled by setting the `WEAVER_SOFTWARE_RENDERER` environment variable.
+   */
+  bool PreferSoftwareRenderer = false;
+  /**
+   * Render with `VK_KHR_dynamic_rendering` when the device supports it, so no render pass or
+   * framebuffers are rebuilt on resize. Falls back to render passes otherwise. Also disabled by
+   * setting the `WEAVER_DISABLE_DYNAMIC_RENDERING` environment variable.
+   */
+  bool PreferDynamicRendering = true;
+  /**
+   * Wait for the GPU to finish the previous frame before polling input and building the UI, so
+   * the frame shows the newest input instead of input sampled frames ago. Costs throughput when
+   * the GPU is the bottleneck. Also enabled by setting the `WEAVER_LOW_LATENCY` environment
+   * variable.
+   */
+  bool LowLatency = false;
+  /**
+   * The minimum number of swapchain images, at least 2. Fewer images let fewer frames queue up
+   * ahead of the display.
+   */
+  uint32_t MinImageCount = 2;
+  /**
+   * Only render while something happens: after a few frames without events, posted tasks,
+   * coroutines waiting for frames, pending uploads, readbacks or asset loads, the loop sleeps
+   * until the next event, `Canvas::PostToMainThread` or coroutine delay, waking at least every
+   * `Settings::Rendering::ON_DEMAND_TIMEOUT_MS`. Saves power in mostly static UIs.
+   */
+  bool OnDemandRendering = false;
 };
 
 /**
@@ -55,6 +101,9 @@ struct CanvasSpecification {
  */
 class Canvas {
  public:
+  /** A task run on the main thread, stored without allocating. */
+  using MainThreadTask = InplaceFunction<void(), 64>;
+
   /**
    * @brief Constructs a new Canvas object.
    * @param CanvasSpecification The specifications for the canvas.
@@ -121,6 +170,57 @@ class Canvas {
    * @return The current time in seconds.
    */
   float GetTime();
+  /**
+   * @brief Enables or disables the low-latency mode, see `CanvasSpecification::LowLatency`.
+   * @param enabled Whether to wait for the previous frame before polling input.
+   */
+  void SetLowLatency(bool enabled) {
+    m_LowLatency = enabled;
+  }
+  /**
+   * @brief Checks if the low-latency mode is enabled.
+   * @return True if the previous frame is waited for before polling input.
+   */
+  bool IsLowLatency() const {
+    return m_LowLatency;
+  }
+  /**
+   * @brief Enables or disables on-demand rendering, see `CanvasSpecification::OnDemandRendering`.
+   * @param enabled True to render only while something happens.
+   */
+  void SetOnDemandRendering(bool enabled);
+  /**
+   * @brief Checks if on-demand rendering is enabled.
+   * @return True if the loop sleeps while nothing happens.
+   */
+  bool IsOnDemandRendering() const;
+  /**
+   * @brief Runs a task on the main thread. Safe on any thread, and does not allocate.
+   * @details Tasks run in the order they were posted, once per frame after the events have been
+   * dispatched and before coroutines resume and layers update. Tasks posted while the tasks of a
+   * frame run wait for the next frame. Wakes the loop when on-demand rendering is idle.
+   * @param task The task. Captures must fit into 64 bytes, see `InplaceFunction`.
+   */
+  static void PostToMainThread(MainThreadTask task);
+  /**
+   * @brief Gets the time from polling input to presenting the frame built from it.
+   * @return The latency in milliseconds, smoothed over recent frames.
+   */
+  float GetInputLatency() const {
+    return m_InputLatency;
+  }
+  /**
+   * @brief Gets the time each layer spent in its last `OnUpdate`, see `Layer::GetUpdateTraits`.
+   * @return The times in milliseconds, in the order the layers were pushed.
+   */
+  const std::vector<float>& GetLayerUpdateTimes() const;
+  /**
+   * @brief Submits a task graph to run this frame, after every layer has updated. Thread-safe.
+   * @details Call from `OnUpdate`. All graphs submitted in a frame run together on the job system
+   * and are joined before `OnUIRender`. The graph must outlive the frame.
+   * @param graph The task graph.
+   */
+  void SubmitTaskGraph(TaskGraph& graph);
   /**
    * @brief Gets the SDL window handle.
    * @return The SDL window handle.
@@ -144,25 +244,180 @@ class Canvas {
    * @return The logical device.
    */
   static VkDevice GetDevice();
+  /**
+   * @brief Gets the graphics queue. Hold `GetQueueMutex` while submitting to it.
+   * @return The graphics queue.
+   */
+  static VkQueue GetQueue();
+  /**
+   * @brief Gets the mutex that serializes access to the graphics queue across threads.
+   * @return The queue mutex.
+   */
+  static std::mutex& GetQueueMutex();
+  /**
+   * @brief Gets the family index of the graphics queue.
+   * @return The queue family index.
+   */
+  static uint32_t GetQueueFamilyIndex();
+  /**
+   * @brief Gets the number of frames the GPU may still be rendering while the CPU records the next.
+   * @return The number of frames in flight.
+   */
+  static uint32_t GetFramesInFlight();
+
+  /**
+   * @brief Checks if the frame is rendered with `VK_KHR_dynamic_rendering`.
+   * @return True if dynamic rendering is enabled, false if render passes are used.
+   */
+  static bool IsDynamicRenderingEnabled();
+#ifdef VK_KHR_dynamic_rendering
+  /**
+   * @brief Begins rendering into the attachments of `info`, without a render pass or framebuffer.
+   * @details Only valid if `IsDynamicRenderingEnabled` returns true; otherwise an error is
+   * logged and nothing is recorded.
+   * @param commandBuffer The command buffer to record into.
+   * @param info The attachments and render area.
+   */
+  static void CmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR& info);
+  /**
+   * @brief Ends rendering begun with `CmdBeginRendering`.
+   * @details Logs an error and records nothing unless `IsDynamicRenderingEnabled` returns true.
+   * @param commandBuffer The command buffer to record into.
+   */
+  static void CmdEndRendering(VkCommandBuffer commandBuffer);
+#endif
 
   /**
-   * @brief Gets a command buffer from the command pool.
+   * @brief Gets a command buffer from the calling thread's command pool. Safe on any thread.
    * @param begin Whether to begin the command buffer.
-   * @return The command buffer.
+   * @return The command buffer, to be passed to `FlushCommandBuffer` on the same thread.
    */
   static VkCommandBuffer GetCommandBuffer(bool begin);
   /**
-   * @brief Flushes a command buffer.
+   * @brief Submits a command buffer from `GetCommandBuffer` and waits for it to complete.
    * @param commandBuffer The command buffer to flush.
    */
   static void FlushCommandBuffer(VkCommandBuffer commandBuffer);
 
   /**
-   * @brief Submits a resource to be freed when the current frame is finished.
-   * @param func The function to call to free the resource.
+   * @brief Submits a batch to the graphics queue and signals the next value of the GPU timeline.
+   * @details Safe to call from any thread, the queue is locked internally. The batch's fence slot
+   * is used by the timeline.
+   * @param info The batch.
+   * @return The timeline value reached once the batch has completed.
+   */
+  static uint64_t SubmitToQueue(const VkSubmitInfo& info);
+  /**
+   * @brief Checks if the work of a timeline value has completed, without waiting.
+   * @param value The value returned by `SubmitToQueue`.
+   * @return True if the work has completed.
+   */
+  static bool IsTimelineValueComplete(uint64_t value);
+  /**
+   * @brief Waits until the work of a timeline value has completed.
+   * @param value The value returned by `SubmitToQueue`.
+   */
+  static void WaitForTimelineValue(uint64_t value);
+  /**
+   * @brief Checks if the GPU has finished all work submitted during a frame. Safe on any thread.
+   * @param frame The frame, see `GetFrameCount`.
+   * @return True if the frame has completed.
+   */
+  static bool IsFrameComplete(uint64_t frame);
+
+  /**
+   * @brief Submits a resource to be freed once the GPU has finished the frames that may use it.
+   * @details Lock-free and safe to call from any thread.
+   * @param func The function to call to free the resource. It runs on the main thread.
    */
   static void SubmitResourceFree(std::function<void()>&& func);
 
+  /**
+   * @brief Submits GPU work to be recorded into the current frame, ahead of the UI render pass.
+   * @details Used by `ComputePass`. Safe to call from any thread, the function is called on the
+   * main thread. If the frame is not rendered (e.g. while minimized) the work is submitted on its
+   * own and waited for.
+   * @param func The function that records into the frame's command buffer.
+   */
+  static void SubmitCompute(std::function<void(VkCommandBuffer)>&& func);
+
+  /**
+   * @brief Gets the recorder that lets worker threads record secondary command buffers.
+   * @return A reference to the command recorder.
+   */
+  CommandRecorder& GetCommandRecorder() {
+    return *m_CommandRecorder;
+  }
+
+  /**
+   * @brief Gets the asset loader used to load images asynchronously.
+   * @return A reference to the asset loader.
+   */
+  AssetLoader& GetAssetLoader() {
+    return *m_AssetLoader;
+  }
+
+  /**
+   * @brief Gets the cache used to share loaded textures.
+   * @return A reference to the texture cache.
+   */
+  TextureCache& GetTextureCache() {
+    return *m_TextureCache;
+  }
+
+  /**
+   * @brief Gets the cache that shares samplers between images.
+   * @return A reference to the sampler cache.
+   */
+  SamplerCache& GetSamplerCache() {
+    return *m_SamplerCache;
+  }
+
+  /**
+   * @brief Gets the queue that batches the image uploads of a frame.
+   * @return A reference to the upload queue.
+   */
+  UploadQueue& GetUploadQueue() {
+    return *m_UploadQueue;
+  }
+
+  /**
+   * @brief Gets the queue that reads images back to the CPU, see `Image::ReadbackAsync`.
+   * @return A reference to the readback queue.
+   */
+  ReadbackQueue& GetReadbackQueue() {
+    return *m_ReadbackQueue;
+  }
+
+  /**
+   * @brief Gets the scheduler that resumes coroutines on the main thread, see `Coroutine.h`.
+   * @return A reference to the coroutine scheduler.
+   */
+  CoroutineScheduler& GetCoroutineScheduler() {
+    return *m_Coroutines;
+  }
+  /**
+   * @brief Suspends a coroutine until the next frame: `co_await Canvas::NextFrame();`.
+   * @return The awaitable.
+   */
+  static NextFrameAwaiter NextFrame() {
+    return Weaver::NextFrame();
+  }
+
+  /**
+   * @brief Gets the bus that delivers window and input events to the layers, see `Events.h`.
+   * @return A reference to the event bus.
+   */
+  EventBus& GetEventBus() {
+    return m_EventBus;
+  }
+
+  /**
+   * @brief Gets the number of frames rendered since the application started. Safe on any thread.
+   * @return The frame count.
+   */
+  static uint64_t GetFrameCount();
+
  private:
   /**
    * @brief Initializes the canvas.
@@ -176,6 +431,25 @@ class Canvas {
    * @brief Sets the shape of the window.
    */
   void SetWindowShape();
+  /**
+   * @brief Publishes the Weaver event that corresponds to an SDL event, if any.
+   * @param event The SDL event.
+   */
+  void PublishEvent(const SDL_Event& event);
+  /**
+   * @brief Delivers the queued events to the layers, from the top of the stack down.
+   */
+  void DispatchEvents();
+  /**
+   * @brief Runs the tasks posted to the main thread before this call.
+   * @return The number of tasks run.
+   */
+  size_t RunMainThreadTasks();
+  /**
+   * @brief Runs the task graphs submitted this frame and waits for them.
+   * @param deadline The time after which skippable tasks are skipped.
+   */
+  void RunTaskGraphs(std::chrono::steady_clock::time_point deadline);
 
  private:
   CanvasSpecification m_Specification;
@@ -186,12 +460,27 @@ class Canvas {
   bool m_restore_in_progress = false;
   SDL_Rect m_SavedWindowRect;
 
-  float m_TimeStep = 0.0f;
-  float m_FrameTime = 0.0f;
-  float m_LastFrameTime = 0.0f;
+  bool m_LowLatency = false;
+  float m_InputLatency = 0.0f;
+  uint32_t m_IdleFrames = 0;
 
   std::vector<std::shared_ptr<Layer>> m_LayerStack;
+  std::unique_ptr<LayerScheduler> m_LayerScheduler;
+  std::mutex m_TaskGraphMutex;
+  std::vector<TaskGraph*> m_SubmittedTaskGraphs;
   std::function<void()> m_MenubarCallback;
+
+  EventBus m_EventBus;
+  std::vector<EventListener*> m_EventListeners;
+
+  std::unique_ptr<GpuTimeline> m_Timeline;
+  std::unique_ptr<CommandRecorder> m_CommandRecorder;
+  std::unique_ptr<SamplerCache> m_SamplerCache;
+  std::unique_ptr<UploadQueue> m_UploadQueue;
+  std::unique_ptr<AssetLoader> m_AssetLoader;
+  std::unique_ptr<TextureCache> m_TextureCache;
+  std::unique_ptr<ReadbackQueue> m_ReadbackQueue;
+  std::unique_ptr<CoroutineScheduler> m_Coroutines;
 };
 
 // Implemented by CLIENT
@@ -0,0 +1,131 @@
+/**
+ * @file Clock.cpp
+ * @author B.G. Smit
+ * @brief Implements the detection and calibration of the clock's time stamp counter.
+ * @copyright Copyright (c) 2025
+ */
+#include "Clock.h"
+
+#include <cstdlib>
+
+#if defined(WEAVER_CLOCK_X86) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#endif
+
+namespace Weaver {
+
+namespace Detail {
+
+ClockState g_ClockState;
+
+}  // namespace Detail
+
+namespace Utils {
+
+/** How long the TSC is compared with `steady_clock` at startup. */
+static constexpr auto kCalibrationTime = std::chrono::milliseconds(10);
+
+/**
+ * @brief Checks if the CPU has a TSC that ticks at a constant rate in every power state.
+ * @return True if the TSC can be used as a clock.
+ */
+static bool HasInvariantTsc() {
+#ifdef WEAVER_CLOCK_X86
+#if defined(__GNUC__) || defined(__clang__)
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007)
+    return false;
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return (edx & (1u << 8)) != 0;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0x80000000);
+  if ((unsigned int)info[0] < 0x80000007)
+    return false;
+  __cpuid(info, 0x80000007);
+  return (info[3] & (1 << 8)) != 0;
+#endif
+#endif
+  return false;
+}
+
+/**
+ * @brief Measures the TSC rate against `steady_clock`.
+ * @return The ticks per second, or 0 if the TSC is unusable.
+ */
+static uint64_t CalibrateTsc() {
+#ifdef WEAVER_CLOCK_X86
+  if (!HasInvariantTsc() || getenv("WEAVER_DISABLE_TSC") != nullptr)
+    return 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t start_ticks = __rdtsc();
+  auto end = start;
+  while (end - start < kCalibrationTime)
+    end = std::chrono::steady_clock::now();
+  const uint64_t end_ticks = __rdtsc();
+
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  const uint64_t frequency = (uint64_t)((double)(end_ticks - start_ticks) / seconds);
+  // A hypervisor may report an invariant TSC it does not provide.
+  if (end_ticks <= start_ticks || frequency < 100000000)
+    return 0;
+  return frequency;
+#else
+  return 0;
+#endif
+}
+
+static const uint64_t s_TscFrequency = CalibrateTsc();
+
+/**
+ * @brief Points the clock at a source.
+ * @param source The source, which must be supported.
+ * @return True, so the startup choice can initialize a static.
+ */
+static bool Apply(ClockSource source) {
+  Detail::ClockState state;
+  if (source == ClockSource::Tsc) {
+    state.UseTsc = true;
+    state.Frequency = s_TscFrequency;
+    state.NanosecondsPerTickQ32 =
+        (uint64_t)((1000000000.0 * 4294967296.0) / (double)s_TscFrequency);
+    state.SecondsPerTick = 1.0 / (double)s_TscFrequency;
+  }
+  Detail::g_ClockState = state;
+  return true;
+}
+
+static const bool s_Applied =
+    Apply(s_TscFrequency != 0 ? ClockSource::Tsc : ClockSource::SteadyClock);
+
+}  // namespace Utils
+
+/**
+ * @brief Gets the best source supported by the CPU.
+ * @return The supported source.
+ */
+ClockSource Clock::GetSupportedSource() {
+  return Utils::s_TscFrequency != 0 ? ClockSource::Tsc : ClockSource::SteadyClock;
+}
+
+/**
+ * @brief Gets the source the clock currently reads.
+ * @return The active source.
+ */
+ClockSource Clock::GetSource() {
+  return Detail::g_ClockState.UseTsc ? ClockSource::Tsc : ClockSource::SteadyClock;
+}
+
+/**
+ * @brief Overrides the source, e.g. for tests and benchmarks. Ticks read before the change
+ * must not be compared with ticks read after it, so nothing may be timed meanwhile.
+ * @param source The requested source, clamped to the supported source.
+ */
+void Clock::SetSource(ClockSource source) {
+  if (source == ClockSource::Tsc && Utils::s_TscFrequency == 0)
+    source = ClockSource::SteadyClock;
+  Utils::Apply(source);
+}
+
+}  // namespace Weaver
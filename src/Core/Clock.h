@@ -0,0 +1,132 @@
+/**
+ * @file Clock.h
+ * @author B.G. Smit
+ * @brief Declares the low-overhead clock used by the timers and the profiler.
+ *
+ * This file defines the `Clock` class, which counts integer ticks. On x86 CPUs with an invariant
+ * time stamp counter it reads the TSC, which takes a few nanoseconds and never enters the kernel;
+ * the tick rate is calibrated against `std::chrono::steady_clock` when the program starts. Other
+ * CPUs, and CPUs whose TSC may drift, fall back to `steady_clock` itself. Setting the
+ * `WEAVER_DISABLE_TSC` environment variable forces the fallback.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WEAVER_CLOCK_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace Weaver {
+
+/**
+ * @enum ClockSource
+ * @brief The counter the clock reads.
+ */
+enum class ClockSource {
+  SteadyClock = 0, /**< `std::chrono::steady_clock`, one tick per nanosecond. */
+  Tsc              /**< The invariant time stamp counter of the CPU. */
+};
+
+namespace Detail {
+
+/**
+ * @struct ClockState
+ * @brief The calibration of the clock. Written at startup and by `Clock::SetSource`.
+ */
+struct ClockState {
+  bool UseTsc = false;
+  uint64_t Frequency = 1000000000;
+  uint64_t NanosecondsPerTickQ32 = 1ull << 32;  // 32.32 fixed point.
+  double SecondsPerTick = 1e-9;
+};
+
+extern ClockState g_ClockState;
+
+}  // namespace Detail
+
+/**
+ * @class Clock
+ * @brief A monotonic clock that counts integer ticks.
+ * @details Ticks are only meaningful as differences and must be converted with `ToNanoseconds`
+ * or `ToSeconds`. Both sources count in 64 bits, so differences do not lose precision however
+ * long the program runs.
+ */
+class Clock {
+ public:
+  using Ticks = uint64_t;
+
+  /**
+   * @brief Reads the clock. Safe on any thread.
+   * @return The current tick count.
+   */
+  static Ticks Now() {
+#ifdef WEAVER_CLOCK_X86
+    if (Detail::g_ClockState.UseTsc)
+      return __rdtsc();
+#endif
+    return (Ticks)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /**
+   * @brief Converts ticks to nanoseconds.
+   * @param ticks A difference of tick counts.
+   * @return The duration in nanoseconds.
+   */
+  static uint64_t ToNanoseconds(Ticks ticks) {
+#ifdef __SIZEOF_INT128__
+    return (uint64_t)(((unsigned __int128)ticks * Detail::g_ClockState.NanosecondsPerTickQ32) >>
+                      32);
+#else
+    return (uint64_t)((double)ticks * Detail::g_ClockState.SecondsPerTick * 1e9);
+#endif
+  }
+  /**
+   * @brief Converts ticks to seconds.
+   * @param ticks A difference of tick counts.
+   * @return The duration in seconds.
+   */
+  static double ToSeconds(Ticks ticks) {
+    return (double)ticks * Detail::g_ClockState.SecondsPerTick;
+  }
+  /**
+   * @brief Gets the tick rate.
+   * @return The ticks per second.
+   */
+  static uint64_t GetFrequency() {
+    return Detail::g_ClockState.Frequency;
+  }
+
+  /**
+   * @brief Gets the best source supported by the CPU.
+   * @return The supported source.
+   */
+  static ClockSource GetSupportedSource();
+  /**
+   * @brief Gets the source the clock currently reads.
+   * @return The active source.
+   */
+  static ClockSource GetSource();
+  /**
+   * @brief Overrides the source, e.g. for tests and benchmarks. Ticks read before the change
+   * must not be compared with ticks read after it, so nothing may be timed meanwhile.
+   * @param source The requested source, clamped to the supported source.
+   */
+  static void SetSource(ClockSource source);
+};
+
+}  // namespace Weaver
+
+#endif
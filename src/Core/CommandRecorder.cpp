@@ -0,0 +1,260 @@
+/**
+ * @file CommandRecorder.cpp
+ * @author B.G. Smit
+ * @brief Implements the per-thread command pools used to record Vulkan commands on any thread.
+ * @copyright Copyright (c) 2025
+ */
+#include "CommandRecorder.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief Hands out a unique id to every recorder, so thread-local state of a destroyed recorder
+ * is never mistaken for the current one.
+ */
+static std::atomic<uint64_t> s_NextRecorderId{1};
+
+/**
+ * @brief The pools the calling thread registered, and the recorder they belong to.
+ */
+struct ThreadRegistration {
+  uint64_t RecorderId = 0;
+  void* Pools = nullptr;
+};
+static thread_local ThreadRegistration t_Registration;
+
+/**
+ * @brief Raises an atomic frame number to a later frame.
+ * @param value The atomic to raise.
+ * @param frame The frame.
+ */
+static void RaiseFrame(std::atomic<uint64_t>& value, uint64_t frame) {
+  uint64_t current = value.load(std::memory_order_relaxed);
+  while (current < frame &&
+         !value.compare_exchange_weak(current, frame, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new CommandRecorder.
+ */
+CommandRecorder::CommandRecorder() : m_Id(Utils::s_NextRecorderId.fetch_add(1)) {}
+
+/**
+ * @brief Destroys the CommandRecorder and the pools of every thread. The device must be idle.
+ */
+CommandRecorder::~CommandRecorder() {
+  VkDevice device = Canvas::GetDevice();
+  for (auto& thread : m_Threads) {
+    for (auto& pool : thread->Pools)
+      vkDestroyCommandPool(device, pool->CommandPool, nullptr);
+  }
+}
+
+/**
+ * @brief Begins a secondary command buffer to be executed ahead of the UI render pass.
+ * @return The command buffer, ready for recording.
+ */
+VkCommandBuffer CommandRecorder::Begin() {
+  VkCommandBuffer command_buffer = Allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+
+  VkCommandBufferInheritanceInfo inheritance = {};
+  inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  VkCommandBufferBeginInfo begin_info = {};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  begin_info.pInheritanceInfo = &inheritance;
+  VkResult err = vkBeginCommandBuffer(command_buffer, &begin_info);
+  check_vk_result(err);
+  return command_buffer;
+}
+
+/**
+ * @brief Ends a command buffer returned by `Begin` and queues it for the next frame.
+ * @param command_buffer The command buffer.
+ */
+void CommandRecorder::Submit(VkCommandBuffer command_buffer) {
+  VkResult err = vkEndCommandBuffer(command_buffer);
+  check_vk_result(err);
+  Pool* pool = Close(command_buffer);
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Submitted.emplace_back(command_buffer, pool);
+}
+
+/**
+ * @brief Records the submitted secondary command buffers into a primary command buffer.
+ * @param command_buffer The primary command buffer, outside of a render pass.
+ */
+void CommandRecorder::Execute(VkCommandBuffer command_buffer) {
+  std::vector<std::pair<VkCommandBuffer, Pool*>> submitted;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    submitted.swap(m_Submitted);
+  }
+  if (submitted.empty())
+    return;
+
+  std::vector<VkCommandBuffer> command_buffers;
+  command_buffers.reserve(submitted.size());
+  for (auto& [secondary, pool] : submitted)
+    command_buffers.push_back(secondary);
+  vkCmdExecuteCommands(command_buffer, (uint32_t)command_buffers.size(), command_buffers.data());
+
+  // The pools may be reset once the frame they were executed in has completed.
+  const uint64_t frame = Canvas::GetFrameCount();
+  for (auto& [secondary, pool] : submitted) {
+    Utils::RaiseFrame(pool->LastUsedFrame, frame);
+    pool->Outstanding.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+/**
+ * @brief Allocates a one-shot primary command buffer.
+ * @param begin Whether to begin the command buffer.
+ * @return The command buffer.
+ */
+VkCommandBuffer CommandRecorder::AllocatePrimary(bool begin) {
+  VkCommandBuffer command_buffer = Allocate(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+  if (begin) {
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkResult err = vkBeginCommandBuffer(command_buffer, &begin_info);
+    check_vk_result(err);
+  }
+  return command_buffer;
+}
+
+/**
+ * @brief Marks a primary command buffer from `AllocatePrimary` as no longer in use by the CPU.
+ * @param command_buffer The command buffer.
+ */
+void CommandRecorder::Release(VkCommandBuffer command_buffer) {
+  Pool* pool = Close(command_buffer);
+  Utils::RaiseFrame(pool->LastUsedFrame, Canvas::GetFrameCount());
+  pool->Outstanding.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Checks if secondary command buffers are waiting to be executed.
+ * @return True if command buffers were submitted since the last `Execute`.
+ */
+bool CommandRecorder::HasSubmissions() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return !m_Submitted.empty();
+}
+
+/**
+ * @brief Gets the number of threads that have recorded with this recorder.
+ * @return The number of threads.
+ */
+size_t CommandRecorder::GetThreadCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Threads.size();
+}
+
+/**
+ * @brief Gets the pools of the calling thread, registering them on first use.
+ * @return The pools.
+ */
+CommandRecorder::ThreadPools& CommandRecorder::GetThreadPools() {
+  Utils::ThreadRegistration& registration = Utils::t_Registration;
+  if (registration.RecorderId != m_Id) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Threads.push_back(std::make_unique<ThreadPools>());
+    registration.RecorderId = m_Id;
+    registration.Pools = m_Threads.back().get();
+  }
+  return *static_cast<ThreadPools*>(registration.Pools);
+}
+
+/**
+ * @brief Allocates a command buffer from the calling thread's pool for the current frame.
+ * @param level The command buffer level.
+ * @return The command buffer.
+ */
+VkCommandBuffer CommandRecorder::Allocate(VkCommandBufferLevel level) {
+  VkDevice device = Canvas::GetDevice();
+  const uint64_t frame = Canvas::GetFrameCount();
+  VkResult err;
+  ThreadPools& thread = GetThreadPools();
+
+  // Each frame records into its own pool; a pool is reset once nothing can still be using it.
+  if (!thread.Current || thread.Current->BeganFrame != frame) {
+    thread.Current = nullptr;
+    for (auto& pool : thread.Pools) {
+      if (pool->Outstanding.load(std::memory_order_acquire) == 0 &&
+          Canvas::IsFrameComplete(pool->LastUsedFrame.load(std::memory_order_relaxed))) {
+        err = vkResetCommandPool(device, pool->CommandPool, 0);
+        check_vk_result(err);
+        pool->PrimaryUsed = 0;
+        pool->SecondaryUsed = 0;
+        thread.Current = pool.get();
+        break;
+      }
+    }
+    if (!thread.Current) {
+      auto pool = std::make_unique<Pool>();
+      VkCommandPoolCreateInfo pool_info = {};
+      pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+      pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+      pool_info.queueFamilyIndex = Canvas::GetQueueFamilyIndex();
+      err = vkCreateCommandPool(device, &pool_info, nullptr, &pool->CommandPool);
+      check_vk_result(err);
+      thread.Pools.push_back(std::move(pool));
+      thread.Current = thread.Pools.back().get();
+    }
+    thread.Current->BeganFrame = frame;
+  }
+
+  Pool* pool = thread.Current;
+  const bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  std::vector<VkCommandBuffer>& command_buffers = primary ? pool->Primary : pool->Secondary;
+  size_t& used = primary ? pool->PrimaryUsed : pool->SecondaryUsed;
+  if (used == command_buffers.size()) {
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = pool->CommandPool;
+    alloc_info.level = level;
+    alloc_info.commandBufferCount = 1;
+    VkCommandBuffer command_buffer;
+    err = vkAllocateCommandBuffers(device, &alloc_info, &command_buffer);
+    check_vk_result(err);
+    command_buffers.push_back(command_buffer);
+  }
+
+  VkCommandBuffer command_buffer = command_buffers[used++];
+  pool->Outstanding.fetch_add(1, std::memory_order_relaxed);
+  thread.Open.emplace_back(command_buffer, pool);
+  return command_buffer;
+}
+
+/**
+ * @brief Removes a command buffer from the calling thread's open list.
+ * @param command_buffer The command buffer.
+ * @return The pool it was allocated from.
+ */
+CommandRecorder::Pool* CommandRecorder::Close(VkCommandBuffer command_buffer) {
+  ThreadPools& thread = GetThreadPools();
+  auto it = std::find_if(thread.Open.begin(), thread.Open.end(),
+      [command_buffer](const auto& open) { return open.first == command_buffer; });
+  if (it == thread.Open.end())
+    throw std::runtime_error("Command buffer was not allocated by the calling thread!");
+
+  Pool* pool = it->second;
+  *it = thread.Open.back();
+  thread.Open.pop_back();
+  return pool;
+}
+
+}  // namespace Weaver
@@ -0,0 +1,149 @@
+/**
+ * @file CommandRecorder.h
+ * @author B.G. Smit
+ * @brief Declares the per-thread command pools used to record Vulkan commands on any thread.
+ *
+ * This file defines the `CommandRecorder` class. A Vulkan command pool may only be used by one
+ * thread at a time, so every thread that records gets pools of its own. Worker threads record
+ * secondary command buffers and hand them back with `Submit`; the main thread executes all of
+ * them in the frame's command buffer, ahead of the UI render pass. Pools are reset by their own
+ * thread once no frame in flight uses them.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef COMMAND_RECORDER_H
+#define COMMAND_RECORDER_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @class CommandRecorder
+ * @brief Hands out command buffers from pools owned by the calling thread.
+ * @details Owned by the `Canvas`, see `Canvas::GetCommandRecorder`. `Begin`, `Submit`,
+ * `AllocatePrimary` and `Release` may be called from any thread; `Execute` must be called from
+ * the main thread. A command buffer must be submitted or released by the thread that got it.
+ */
+class CommandRecorder {
+ public:
+  /**
+   * @brief Constructs a new CommandRecorder.
+   */
+  CommandRecorder();
+  /**
+   * @brief Destroys the CommandRecorder and the pools of every thread. The device must be idle.
+   */
+  ~CommandRecorder();
+
+  CommandRecorder(const CommandRecorder&) = delete;
+  CommandRecorder& operator=(const CommandRecorder&) = delete;
+
+  /**
+   * @brief Begins a secondary command buffer to be executed ahead of the UI render pass.
+   * @details The command buffer is recorded outside of any render pass. It is executed in the
+   * first frame rendered after `Submit`, in submission order.
+   * @return The command buffer, ready for recording.
+   */
+  VkCommandBuffer Begin();
+  /**
+   * @brief Ends a command buffer returned by `Begin` and queues it for the next frame.
+   * @param command_buffer The command buffer.
+   */
+  void Submit(VkCommandBuffer command_buffer);
+
+  /**
+   * @brief Records the submitted secondary command buffers into a primary command buffer.
+   * @param command_buffer The primary command buffer, outside of a render pass.
+   */
+  void Execute(VkCommandBuffer command_buffer);
+
+  /**
+   * @brief Allocates a one-shot primary command buffer, see `Canvas::GetCommandBuffer`.
+   * @param begin Whether to begin the command buffer.
+   * @return The command buffer.
+   */
+  VkCommandBuffer AllocatePrimary(bool begin);
+  /**
+   * @brief Marks a primary command buffer from `AllocatePrimary` as no longer in use by the CPU.
+   * @details Its pool is reset once no frame in flight can still be executing it.
+   * @param command_buffer The command buffer.
+   */
+  void Release(VkCommandBuffer command_buffer);
+
+  /**
+   * @brief Checks if secondary command buffers are waiting to be executed.
+   * @return True if command buffers were submitted since the last `Execute`.
+   */
+  bool HasSubmissions() const;
+
+  /**
+   * @brief Gets the number of threads that have recorded with this recorder.
+   * @return The number of threads.
+   */
+  size_t GetThreadCount() const;
+
+ private:
+  /**
+   * @struct Pool
+   * @brief A command pool and the frame its command buffers were last used in.
+   */
+  struct Pool {
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    // Command buffers are kept across resets and handed out again in order.
+    std::vector<VkCommandBuffer> Primary, Secondary;
+    size_t PrimaryUsed = 0, SecondaryUsed = 0;
+    uint64_t BeganFrame = 0;
+    // Written by the main thread when the pool's command buffers are executed.
+    std::atomic<uint64_t> LastUsedFrame{0};
+    // The number of command buffers handed out that were not executed or released yet.
+    std::atomic<uint32_t> Outstanding{0};
+  };
+
+  /**
+   * @struct ThreadPools
+   * @brief The pools owned by one thread. Only that thread touches them, except for the atomics.
+   */
+  struct ThreadPools {
+    std::vector<std::unique_ptr<Pool>> Pools;
+    Pool* Current = nullptr;
+    std::vector<std::pair<VkCommandBuffer, Pool*>> Open;
+  };
+
+  /**
+   * @brief Gets the pools of the calling thread, registering them on first use.
+   * @return The pools.
+   */
+  ThreadPools& GetThreadPools();
+  /**
+   * @brief Allocates a command buffer from the calling thread's pool for the current frame.
+   * @param level The command buffer level.
+   * @return The command buffer.
+   */
+  VkCommandBuffer Allocate(VkCommandBufferLevel level);
+  /**
+   * @brief Removes a command buffer from the calling thread's open list.
+   * @param command_buffer The command buffer.
+   * @return The pool it was allocated from.
+   */
+  Pool* Close(VkCommandBuffer command_buffer);
+
+ private:
+  const uint64_t m_Id;
+
+  mutable std::mutex m_Mutex;
+  std::vector<std::unique_ptr<ThreadPools>> m_Threads;
+  std::vector<std::pair<VkCommandBuffer, Pool*>> m_Submitted;
+};
+
+}  // namespace Weaver
+
+#endif
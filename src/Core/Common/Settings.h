@@ -127,7 +127,58 @@ constexpr Uint8 SHAPE_BINARIZATION_CUTOFF = 255;
  * @brief The size of the command buffer.
  */
 constexpr uint32_t COMMAND_BUFFER_SIZE = 1000;
+/**
+ * @brief The maximum number of asynchronously loaded images uploaded to the GPU per frame.
+ */
+constexpr uint32_t MAX_IMAGE_UPLOADS_PER_FRAME = 8;
+/**
+ * @brief The default device memory budget of the texture cache in bytes.
+ */
+constexpr uint64_t TEXTURE_CACHE_BUDGET = 512ull * 1024ull * 1024ull;
+/**
+ * @brief The number of frames a cached texture must go undrawn before it can be evicted.
+ */
+constexpr uint32_t TEXTURE_CACHE_EVICTION_FRAMES = 120;
+/**
+ * @brief The number of bytes of idle readback buffers kept for reuse.
+ */
+constexpr uint64_t READBACK_POOL_BUDGET = 64ull * 1024ull * 1024ull;
+/**
+ * @brief The size of the staging chunks image uploads are batched into.
+ */
+constexpr uint64_t UPLOAD_CHUNK_SIZE = 16ull * 1024ull * 1024ull;
+/**
+ * @brief The number of bytes of idle upload staging chunks kept for reuse.
+ */
+constexpr uint64_t UPLOAD_POOL_BUDGET = 64ull * 1024ull * 1024ull;
+/**
+ * @brief The milliseconds after the start of a frame after which skippable task graph tasks are
+ * skipped.
+ */
+constexpr float TASK_GRAPH_DEADLINE_MS = 10.0f;
+/**
+ * @brief The number of tasks that can be posted to the main thread without allocating. Must be
+ * a power of two.
+ */
+constexpr uint32_t MAIN_THREAD_QUEUE_CAPACITY = 4096;
+static_assert((MAIN_THREAD_QUEUE_CAPACITY & (MAIN_THREAD_QUEUE_CAPACITY - 1)) == 0,
+    "MAIN_THREAD_QUEUE_CAPACITY must be a power of two");
+/**
+ * @brief The frames rendered after the last event before on-demand rendering goes idle.
+ */
+constexpr uint32_t ON_DEMAND_IDLE_FRAMES = 3;
+/**
+ * @brief The milliseconds an idle on-demand loop sleeps at most, so timers keep running.
+ */
+constexpr int ON_DEMAND_TIMEOUT_MS = 250;
 }  // namespace Rendering
 
+namespace Profiling {
+/**
+ * @brief The seconds between the dumps of the named timers to the log, zero to disable them.
+ */
+constexpr float TIMER_DUMP_INTERVAL = 10.0f;
+}  // namespace Profiling
+
 } // namespace Settings
 } // namespace Weaver
@@ -0,0 +1,322 @@
+/**
+ * @file ComputePass.cpp
+ * @author B.G. Smit
+ * @brief Implements the ComputePass class, which dispatches a compute shader within the frame.
+ * @copyright Copyright (c) 2025
+ */
+#include "ComputePass.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+/**
+ * @brief Constructs a new ComputePass.
+ * @param shader The shader to dispatch.
+ */
+ComputePass::ComputePass(const ComputeShader& shader) : m_Shader(shader) {}
+
+/**
+ * @brief Destroys the ComputePass once the GPU is done with it.
+ */
+ComputePass::~ComputePass() {
+  std::vector<VkDescriptorPool> pools;
+  for (const DescriptorSlot& slot : m_DescriptorSlots)
+    pools.push_back(slot.Pool);
+
+  Canvas::SubmitResourceFree([pools]() {
+    VkDevice device = Canvas::GetDevice();
+
+    for (VkDescriptorPool pool : pools)
+      vkDestroyDescriptorPool(device, pool, nullptr);
+  });
+}
+
+/**
+ * @brief Binds an image the shader reads and writes.
+ * @param binding The binding.
+ * @param image The image.
+ */
+void ComputePass::SetStorageImage(uint32_t binding, Image& image) {
+  if (image.GetStorageView() == VK_NULL_HANDLE)
+    throw std::runtime_error("The device cannot store to this image format from shaders");
+  if (IsBoundElsewhere(binding, image, ComputeBindingType::SampledImage))
+    throw std::runtime_error("An image cannot be bound as both a storage and a sampled image");
+
+  BoundResource& resource = m_Resources[binding];
+  resource = BoundResource();
+  resource.Type = ComputeBindingType::StorageImage;
+  resource.StorageImage = &image;
+  resource.ImageInfo.imageView = image.GetStorageView();
+  resource.ImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+}
+
+/**
+ * @brief Binds an image the shader samples.
+ * @param binding The binding.
+ * @param image The image.
+ */
+void ComputePass::SetSampledImage(uint32_t binding, const Image& image) {
+  if (IsBoundElsewhere(binding, image, ComputeBindingType::StorageImage))
+    throw std::runtime_error("An image cannot be bound as both a storage and a sampled image");
+
+  BoundResource& resource = m_Resources[binding];
+  resource = BoundResource();
+  resource.Type = ComputeBindingType::SampledImage;
+  resource.SampledImage = &image;
+  resource.ImageInfo.sampler = image.GetVulkanSampler();
+  resource.ImageInfo.imageView = image.GetImageView();
+  resource.ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+/**
+ * @brief Binds a buffer the shader reads and writes.
+ * @param binding The binding.
+ * @param buffer The buffer.
+ */
+void ComputePass::SetStorageBuffer(uint32_t binding, const ComputeBuffer& buffer) {
+  BoundResource& resource = m_Resources[binding];
+  resource = BoundResource();
+  resource.Type = ComputeBindingType::StorageBuffer;
+  resource.BufferInfo.buffer = buffer.GetVulkanBuffer();
+  resource.BufferInfo.range = VK_WHOLE_SIZE;
+}
+
+/**
+ * @brief Checks if an image is bound to a binding other than the given one in a role.
+ * @param binding The binding that is being bound.
+ * @param image The image.
+ * @param type The role to look for.
+ * @return True if the image is bound in that role elsewhere.
+ */
+bool ComputePass::IsBoundElsewhere(
+    uint32_t binding, const Image& image, ComputeBindingType type) const {
+  // Storage images are transitioned to the general layout and sampled images are read in the
+  // shader read only layout, so one image in both roles would get two conflicting barriers.
+  for (const auto& [other, resource] : m_Resources) {
+    if (other == binding || resource.Type != type)
+      continue;
+    if (resource.StorageImage == &image || resource.SampledImage == &image)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Sets the push constants of the following dispatches.
+ * @param data The push constant data.
+ * @param size The size of the data.
+ */
+void ComputePass::SetPushConstants(const void* data, uint32_t size) {
+  if (size > m_Shader.GetPushConstantSize())
+    throw std::runtime_error("Push constants exceed the size declared by the compute shader");
+  m_PushConstants.assign((const uint8_t*)data, (const uint8_t*)data + size);
+}
+
+/**
+ * @brief Records a dispatch into the current frame.
+ * @param group_count_x The number of work groups in X.
+ * @param group_count_y The number of work groups in Y.
+ * @param group_count_z The number of work groups in Z.
+ */
+void ComputePass::Dispatch(
+    uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) {
+  for (const ComputeBinding& binding : m_Shader.GetBindings()) {
+    auto it = m_Resources.find(binding.Binding);
+    if (it == m_Resources.end() || it->second.Type != binding.Type)
+      throw std::runtime_error("Compute shader binding " + std::to_string(binding.Binding) +
+                               " is not bound to a resource of the declared type");
+  }
+
+  // Shaders without resources need no descriptor set.
+  VkDescriptorSet set = VK_NULL_HANDLE;
+  if (!m_Shader.GetBindings().empty())
+    set = AcquireDescriptorSlot().Set;
+
+  // Write the Descriptor Set, no frame in flight uses this one.
+  std::vector<VkWriteDescriptorSet> writes;
+  std::vector<VkImageMemoryBarrier> before, after;
+  for (const ComputeBinding& binding : m_Shader.GetBindings()) {
+    BoundResource& resource = m_Resources[binding.Binding];
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = binding.Binding;
+    write.descriptorCount = 1;
+    switch (binding.Type) {
+      case ComputeBindingType::StorageImage:
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.pImageInfo = &resource.ImageInfo;
+        break;
+      case ComputeBindingType::SampledImage:
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &resource.ImageInfo;
+        break;
+      case ComputeBindingType::StorageBuffer:
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &resource.BufferInfo;
+        break;
+    }
+    writes.push_back(write);
+
+    // Storage images are written in the general layout and handed back to the UI for sampling.
+    if (binding.Type == ComputeBindingType::StorageImage) {
+      Image& image = *resource.StorageImage;
+
+      VkImageMemoryBarrier barrier = {};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+      barrier.oldLayout = image.m_HasContents ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                              : VK_IMAGE_LAYOUT_UNDEFINED;
+      barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = image.GetVulkanImage();
+      barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      barrier.subresourceRange.levelCount = 1;
+      barrier.subresourceRange.layerCount = 1;
+      before.push_back(barrier);
+
+      barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+      after.push_back(barrier);
+
+      image.m_HasContents = true;
+    }
+  }
+  if (!writes.empty())
+    vkUpdateDescriptorSets(
+        Canvas::GetDevice(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+
+  Canvas::SubmitCompute([pipeline = m_Shader.GetPipeline(),
+                            layout = m_Shader.GetPipelineLayout(),
+                            set,
+                            push_constants = m_PushConstants,
+                            before,
+                            after,
+                            group_count_x,
+                            group_count_y,
+                            group_count_z](VkCommandBuffer command_buffer) {
+    // Earlier uploads, dispatches and host writes to buffers must land before the shader runs.
+    VkMemoryBarrier memory_barrier = {};
+    memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memory_barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        1,
+        &memory_barrier,
+        0,
+        NULL,
+        (uint32_t)before.size(),
+        before.data());
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    if (set != VK_NULL_HANDLE)
+      vkCmdBindDescriptorSets(
+          command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+    if (!push_constants.empty()) {
+      vkCmdPushConstants(command_buffer,
+          layout,
+          VK_SHADER_STAGE_COMPUTE_BIT,
+          0,
+          (uint32_t)push_constants.size(),
+          push_constants.data());
+    }
+    vkCmdDispatch(command_buffer, group_count_x, group_count_y, group_count_z);
+
+    // Make the results visible to the UI, later dispatches, transfers and the host.
+    memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memory_barrier.dstAccessMask =
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+        0,
+        1,
+        &memory_barrier,
+        0,
+        NULL,
+        (uint32_t)after.size(),
+        after.data());
+  });
+}
+
+/**
+ * @brief Gets a descriptor set no frame in flight uses, creating one if needed.
+ * @return The descriptor slot.
+ */
+ComputePass::DescriptorSlot& ComputePass::AcquireDescriptorSlot() {
+  const uint64_t frame = Canvas::GetFrameCount();
+
+  for (DescriptorSlot& slot : m_DescriptorSlots) {
+    if (!slot.Used || Canvas::IsFrameComplete(slot.LastUsedFrame)) {
+      slot.Used = true;
+      slot.LastUsedFrame = frame;
+      return slot;
+    }
+  }
+
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+  DescriptorSlot slot;
+
+  // Create the Descriptor Pool, sized for exactly one set of this shader.
+  {
+    std::vector<VkDescriptorPoolSize> pool_sizes;
+    for (const ComputeBinding& binding : m_Shader.GetBindings()) {
+      VkDescriptorPoolSize size = {};
+      switch (binding.Type) {
+        case ComputeBindingType::StorageImage:
+          size.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+          break;
+        case ComputeBindingType::SampledImage:
+          size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+          break;
+        case ComputeBindingType::StorageBuffer:
+          size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+          break;
+      }
+      size.descriptorCount = 1;
+      pool_sizes.push_back(size);
+    }
+
+    VkDescriptorPoolCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    info.maxSets = 1;
+    info.poolSizeCount = (uint32_t)pool_sizes.size();
+    info.pPoolSizes = pool_sizes.data();
+    err = vkCreateDescriptorPool(device, &info, nullptr, &slot.Pool);
+    check_vk_result(err);
+  }
+
+  // Allocate the Descriptor Set
+  {
+    VkDescriptorSetLayout layout = m_Shader.GetDescriptorSetLayout();
+    VkDescriptorSetAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    info.descriptorPool = slot.Pool;
+    info.descriptorSetCount = 1;
+    info.pSetLayouts = &layout;
+    err = vkAllocateDescriptorSets(device, &info, &slot.Set);
+    check_vk_result(err);
+  }
+
+  slot.Used = true;
+  slot.LastUsedFrame = frame;
+  m_DescriptorSlots.push_back(slot);
+  return m_DescriptorSlots.back();
+}
+
+}  // namespace Weaver
@@ -0,0 +1,145 @@
+/**
+ * @file ComputePass.h
+ * @author B.G. Smit
+ * @brief Declares the ComputePass class, which dispatches a compute shader within the frame.
+ *
+ * A pass binds images and buffers to the bindings declared by a `ComputeShader` and records
+ * dispatches into the frame's command buffer, ahead of the UI render pass. The barriers
+ * between the dispatch and the UI sampling its output images are inserted automatically.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef COMPUTE_PASS_H
+#define COMPUTE_PASS_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "ComputeShader.h"
+#include "Image.h"
+
+namespace Weaver {
+
+/**
+ * @class ComputePass
+ * @brief Binds resources to a compute shader and dispatches it.
+ * @details Must be used from the main thread. The shader and every bound resource must stay
+ * alive until the frame of the last dispatch is rendered.
+ */
+class ComputePass {
+ public:
+  /**
+   * @brief Constructs a new ComputePass.
+   * @param shader The shader to dispatch.
+   */
+  explicit ComputePass(const ComputeShader& shader);
+  /**
+   * @brief Destroys the ComputePass once the GPU is done with it.
+   */
+  ~ComputePass();
+
+  ComputePass(const ComputePass&) = delete;
+  ComputePass& operator=(const ComputePass&) = delete;
+
+  /**
+   * @brief Binds an image the shader reads and writes.
+   * @details Throws a `std::runtime_error` if the device cannot store the image format, or if
+   * the image is bound as a sampled image to another binding: a dispatch cannot both sample and
+   * store an image, as the two need it in different layouts.
+   * @param binding The binding declared as `ComputeBindingType::StorageImage`.
+   * @param image The image.
+   */
+  void SetStorageImage(uint32_t binding, Image& image);
+  /**
+   * @brief Binds an image the shader samples.
+   * @details Throws a `std::runtime_error` if the image is bound as a storage image to another
+   * binding. Read such an image through its storage binding instead.
+   * @param binding The binding declared as `ComputeBindingType::SampledImage`.
+   * @param image The image, which must have contents.
+   */
+  void SetSampledImage(uint32_t binding, const Image& image);
+  /**
+   * @brief Binds a buffer the shader reads and writes.
+   * @param binding The binding declared as `ComputeBindingType::StorageBuffer`.
+   * @param buffer The buffer.
+   */
+  void SetStorageBuffer(uint32_t binding, const ComputeBuffer& buffer);
+  /**
+   * @brief Sets the push constants of the following dispatches.
+   * @param data The push constant data.
+   * @param size The size of the data, at most the shader's push constant size.
+   */
+  void SetPushConstants(const void* data, uint32_t size);
+
+  /**
+   * @brief Records a dispatch into the current frame.
+   * @details The dispatch executes before the UI of this frame is drawn, so images written by
+   * it can be drawn in the same frame. Every declared binding must be bound.
+   * @param group_count_x The number of work groups in X.
+   * @param group_count_y The number of work groups in Y.
+   * @param group_count_z The number of work groups in Z.
+   */
+  void Dispatch(uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1);
+
+  /**
+   * @brief Gets the number of work groups needed to cover a size.
+   * @param size The number of invocations needed, e.g. the width of an image.
+   * @param group_size The local size of the shader in that dimension.
+   * @return The number of work groups.
+   */
+  static uint32_t GetGroupCount(uint32_t size, uint32_t group_size) {
+    return (size + group_size - 1) / group_size;
+  }
+
+ private:
+  /**
+   * @struct BoundResource
+   * @brief A resource bound to one binding.
+   */
+  struct BoundResource {
+    ComputeBindingType Type = ComputeBindingType::StorageImage;
+    Image* StorageImage = nullptr;
+    const Image* SampledImage = nullptr;
+    VkDescriptorImageInfo ImageInfo = {};
+    VkDescriptorBufferInfo BufferInfo = {};
+  };
+
+  /**
+   * @struct DescriptorSlot
+   * @brief A descriptor set with its own pool, reused once the frames using it completed.
+   */
+  struct DescriptorSlot {
+    VkDescriptorPool Pool = VK_NULL_HANDLE;
+    VkDescriptorSet Set = VK_NULL_HANDLE;
+    uint64_t LastUsedFrame = 0;
+    bool Used = false;
+  };
+
+  /**
+   * @brief Checks if an image is bound to a binding other than the given one in a role.
+   * @param binding The binding that is being bound.
+   * @param image The image.
+   * @param type The role to look for.
+   * @return True if the image is bound in that role elsewhere.
+   */
+  bool IsBoundElsewhere(uint32_t binding, const Image& image, ComputeBindingType type) const;
+  /**
+   * @brief Gets a descriptor set no frame in flight uses, creating one if needed.
+   * @return The descriptor slot.
+   */
+  DescriptorSlot& AcquireDescriptorSlot();
+
+ private:
+  const ComputeShader& m_Shader;
+  std::map<uint32_t, BoundResource> m_Resources;
+  std::vector<uint8_t> m_PushConstants;
+  std::vector<DescriptorSlot> m_DescriptorSlots;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * @file ComputeShader.cpp
+ * @author B.G. Smit
+ * @brief Implements compute pipelines and the buffers they read and write.
+ * @copyright Copyright (c) 2025
+ */
+#include "ComputeShader.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief The first word of every SPIR-V module.
+ */
+static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+/**
+ * @brief Gets the Vulkan descriptor type of a compute binding type.
+ * @param type The compute binding type.
+ * @return The Vulkan descriptor type.
+ */
+static VkDescriptorType ComputeBindingTypeToDescriptorType(ComputeBindingType type) {
+  switch (type) {
+    case ComputeBindingType::StorageImage:
+      return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    case ComputeBindingType::SampledImage:
+      return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    case ComputeBindingType::StorageBuffer:
+      return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  }
+  return (VkDescriptorType)0;
+}
+
+/**
+ * @brief Gets the Vulkan memory type index for a given memory type and properties.
+ * @param properties The memory properties.
+ * @param type_bits The memory type bits.
+ * @return The memory type index.
+ */
+static uint32_t GetComputeMemoryType(VkMemoryPropertyFlags properties, uint32_t type_bits) {
+  VkPhysicalDeviceMemoryProperties prop;
+  vkGetPhysicalDeviceMemoryProperties(Canvas::GetPhysicalDevice(), &prop);
+  for (uint32_t i = 0; i < prop.memoryTypeCount; i++) {
+    if ((prop.memoryTypes[i].propertyFlags & properties) == properties && type_bits & (1 << i))
+      return i;
+  }
+
+  return 0xffffffff;
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a ComputeShader from a SPIR-V file.
+ * @param path The path to the `.spv` file.
+ * @param bindings The resources the shader uses.
+ * @param push_constant_size The size of the shader's push constant block in bytes.
+ */
+ComputeShader::ComputeShader(std::string_view path,
+    const std::vector<ComputeBinding>& bindings,
+    uint32_t push_constant_size)
+    : m_Bindings(bindings),
+      m_PushConstantSize(push_constant_size) {
+  std::vector<uint32_t> spirv;
+  if (!LoadSpirv(path, spirv))
+    throw std::runtime_error("Failed to load compute shader: " + std::string(path));
+  Create(spirv);
+}
+
+/**
+ * @brief Constructs a ComputeShader from SPIR-V code in memory.
+ * @param spirv The SPIR-V words.
+ * @param bindings The resources the shader uses.
+ * @param push_constant_size The size of the shader's push constant block in bytes.
+ */
+ComputeShader::ComputeShader(const std::vector<uint32_t>& spirv,
+    const std::vector<ComputeBinding>& bindings,
+    uint32_t push_constant_size)
+    : m_Bindings(bindings),
+      m_PushConstantSize(push_constant_size) {
+  if (spirv.empty() || spirv[0] != Utils::SPIRV_MAGIC)
+    throw std::runtime_error("Compute shader code is not SPIR-V");
+  Create(spirv);
+}
+
+/**
+ * @brief Destroys the ComputeShader once the GPU is done with it.
+ */
+ComputeShader::~ComputeShader() {
+  Canvas::SubmitResourceFree([pipeline = m_Pipeline,
+                                 pipeline_layout = m_PipelineLayout,
+                                 set_layout = m_DescriptorSetLayout]() {
+    VkDevice device = Canvas::GetDevice();
+
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, set_layout, nullptr);
+  });
+}
+
+/**
+ * @brief Reads a SPIR-V file.
+ * @param path The path to the `.spv` file.
+ * @param out Receives the SPIR-V words.
+ * @return True if the file was read and starts with the SPIR-V magic number.
+ */
+bool ComputeShader::LoadSpirv(std::string_view path, std::vector<uint32_t>& out) {
+  std::ifstream file(std::string(path), std::ios::binary | std::ios::ate);
+  if (!file)
+    return false;
+
+  const std::streamsize size = file.tellg();
+  if (size <= 0 || size % sizeof(uint32_t) != 0)
+    return false;
+
+  out.resize((size_t)size / sizeof(uint32_t));
+  file.seekg(0);
+  if (!file.read((char*)out.data(), size))
+    return false;
+  return out[0] == Utils::SPIRV_MAGIC;
+}
+
+/**
+ * @brief Creates the pipeline.
+ * @param spirv The SPIR-V words.
+ */
+void ComputeShader::Create(const std::vector<uint32_t>& spirv) {
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+
+  // Create the Descriptor Set Layout
+  {
+    std::vector<VkDescriptorSetLayoutBinding> layout_bindings;
+    for (const ComputeBinding& binding : m_Bindings) {
+      VkDescriptorSetLayoutBinding layout_binding = {};
+      layout_binding.binding = binding.Binding;
+      layout_binding.descriptorType = Utils::ComputeBindingTypeToDescriptorType(binding.Type);
+      layout_binding.descriptorCount = 1;
+      layout_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+      layout_bindings.push_back(layout_binding);
+    }
+
+    VkDescriptorSetLayoutCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    info.bindingCount = (uint32_t)layout_bindings.size();
+    info.pBindings = layout_bindings.data();
+    err = vkCreateDescriptorSetLayout(device, &info, nullptr, &m_DescriptorSetLayout);
+    check_vk_result(err);
+  }
+
+  // Create the Pipeline Layout
+  {
+    VkPushConstantRange push_constants = {};
+    push_constants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constants.size = m_PushConstantSize;
+
+    VkPipelineLayoutCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    info.setLayoutCount = 1;
+    info.pSetLayouts = &m_DescriptorSetLayout;
+    info.pushConstantRangeCount = m_PushConstantSize > 0 ? 1 : 0;
+    info.pPushConstantRanges = &push_constants;
+    err = vkCreatePipelineLayout(device, &info, nullptr, &m_PipelineLayout);
+    check_vk_result(err);
+  }
+
+  // Create the Pipeline, the shader module is only needed while it is being created.
+  {
+    VkShaderModuleCreateInfo module_info = {};
+    module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_info.codeSize = spirv.size() * sizeof(uint32_t);
+    module_info.pCode = spirv.data();
+    VkShaderModule module;
+    err = vkCreateShaderModule(device, &module_info, nullptr, &module);
+    check_vk_result(err);
+
+    VkComputePipelineCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    info.stage.module = module;
+    info.stage.pName = "main";
+    info.layout = m_PipelineLayout;
+    err = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &m_Pipeline);
+    vkDestroyShaderModule(device, module, nullptr);
+    check_vk_result(err);
+  }
+}
+
+/**
+ * @brief Constructs a new ComputeBuffer.
+ * @param size The size of the buffer in bytes.
+ */
+ComputeBuffer::ComputeBuffer(uint64_t size) : m_Size(size) {
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+
+  VkBufferCreateInfo buffer_info = {};
+  buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  buffer_info.size = m_Size;
+  buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                      VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  err = vkCreateBuffer(device, &buffer_info, nullptr, &m_Buffer);
+  check_vk_result(err);
+  VkMemoryRequirements req;
+  vkGetBufferMemoryRequirements(device, m_Buffer, &req);
+  VkMemoryAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  alloc_info.allocationSize = req.size;
+  alloc_info.memoryTypeIndex = Utils::GetComputeMemoryType(
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      req.memoryTypeBits);
+  if (alloc_info.memoryTypeIndex == 0xffffffff)
+    throw std::runtime_error("Failed to find a suitable memory type!");
+  err = vkAllocateMemory(device, &alloc_info, nullptr, &m_Memory);
+  check_vk_result(err);
+  err = vkBindBufferMemory(device, m_Buffer, m_Memory, 0);
+  check_vk_result(err);
+  err = vkMapMemory(device, m_Memory, 0, VK_WHOLE_SIZE, 0, (void**)&m_Mapped);
+  check_vk_result(err);
+}
+
+/**
+ * @brief Destroys the ComputeBuffer once the GPU is done with it.
+ */
+ComputeBuffer::~ComputeBuffer() {
+  Canvas::SubmitResourceFree([buffer = m_Buffer, memory = m_Memory]() {
+    VkDevice device = Canvas::GetDevice();
+
+    vkDestroyBuffer(device, buffer, nullptr);
+    vkFreeMemory(device, memory, nullptr);
+  });
+}
+
+/**
+ * @brief Copies data into the buffer.
+ * @param data The data to copy.
+ * @param size The number of bytes to copy.
+ * @param offset The offset into the buffer in bytes.
+ */
+void ComputeBuffer::SetData(const void* data, uint64_t size, uint64_t offset) {
+  if (offset + size > m_Size)
+    throw std::runtime_error("ComputeBuffer write is out of range");
+  memcpy(m_Mapped + offset, data, (size_t)size);
+}
+
+}  // namespace Weaver
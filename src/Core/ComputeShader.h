@@ -0,0 +1,197 @@
+/**
+ * @file ComputeShader.h
+ * @author B.G. Smit
+ * @brief Declares compute pipelines and the buffers they read and write.
+ *
+ * This file defines the `ComputeShader` class, which loads a SPIR-V compute shader and builds
+ * its pipeline from a list of declared bindings, and the `ComputeBuffer` class, a host-visible
+ * storage buffer. Shaders are dispatched through a `ComputePass`.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef COMPUTE_SHADER_H
+#define COMPUTE_SHADER_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @enum ComputeBindingType
+ * @brief The kind of resource bound to a compute shader binding.
+ */
+enum class ComputeBindingType {
+  StorageImage = 0, /**< An `Image` the shader reads and writes (`image2D`). */
+  SampledImage,     /**< An `Image` the shader samples with the image's sampler (`sampler2D`). */
+  StorageBuffer     /**< A `ComputeBuffer` the shader reads and writes (`buffer`). */
+};
+
+/**
+ * @struct ComputeBinding
+ * @brief Declares one resource binding of descriptor set 0 of a compute shader.
+ */
+struct ComputeBinding {
+  uint32_t Binding = 0; /**< The `binding` in the shader. */
+  ComputeBindingType Type = ComputeBindingType::StorageImage; /**< The kind of resource. */
+};
+
+/**
+ * @class ComputeShader
+ * @brief A compute pipeline built from SPIR-V and its declared bindings.
+ * @details The shader entry point must be `main`, and all resources must be in descriptor set 0.
+ */
+class ComputeShader {
+ public:
+  /**
+   * @brief Constructs a ComputeShader from a SPIR-V file.
+   * @details Throws a `std::runtime_error` if the file cannot be read or is not SPIR-V.
+   * @param path The path to the `.spv` file.
+   * @param bindings The resources the shader uses.
+   * @param push_constant_size The size of the shader's push constant block in bytes.
+   */
+  ComputeShader(std::string_view path,
+      const std::vector<ComputeBinding>& bindings,
+      uint32_t push_constant_size = 0);
+  /**
+   * @brief Constructs a ComputeShader from SPIR-V code in memory.
+   * @param spirv The SPIR-V words.
+   * @param bindings The resources the shader uses.
+   * @param push_constant_size The size of the shader's push constant block in bytes.
+   */
+  ComputeShader(const std::vector<uint32_t>& spirv,
+      const std::vector<ComputeBinding>& bindings,
+      uint32_t push_constant_size = 0);
+  /**
+   * @brief Destroys the ComputeShader once the GPU is done with it.
+   */
+  ~ComputeShader();
+
+  ComputeShader(const ComputeShader&) = delete;
+  ComputeShader& operator=(const ComputeShader&) = delete;
+
+  /**
+   * @brief Reads a SPIR-V file.
+   * @param path The path to the `.spv` file.
+   * @param out Receives the SPIR-V words.
+   * @return True if the file was read and starts with the SPIR-V magic number.
+   */
+  static bool LoadSpirv(std::string_view path, std::vector<uint32_t>& out);
+
+  /**
+   * @brief Gets the declared bindings.
+   * @return The bindings.
+   */
+  const std::vector<ComputeBinding>& GetBindings() const {
+    return m_Bindings;
+  }
+  /**
+   * @brief Gets the size of the push constant block.
+   * @return The size in bytes.
+   */
+  uint32_t GetPushConstantSize() const {
+    return m_PushConstantSize;
+  }
+  /**
+   * @brief Gets the Vulkan pipeline.
+   * @return The Vulkan pipeline.
+   */
+  VkPipeline GetPipeline() const {
+    return m_Pipeline;
+  }
+  /**
+   * @brief Gets the Vulkan pipeline layout.
+   * @return The Vulkan pipeline layout.
+   */
+  VkPipelineLayout GetPipelineLayout() const {
+    return m_PipelineLayout;
+  }
+  /**
+   * @brief Gets the layout of descriptor set 0.
+   * @return The Vulkan descriptor set layout.
+   */
+  VkDescriptorSetLayout GetDescriptorSetLayout() const {
+    return m_DescriptorSetLayout;
+  }
+
+ private:
+  /**
+   * @brief Creates the pipeline.
+   * @param spirv The SPIR-V words.
+   */
+  void Create(const std::vector<uint32_t>& spirv);
+
+ private:
+  std::vector<ComputeBinding> m_Bindings;
+  uint32_t m_PushConstantSize = 0;
+
+  VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+  VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+  VkPipeline m_Pipeline = VK_NULL_HANDLE;
+};
+
+/**
+ * @class ComputeBuffer
+ * @brief A storage buffer in host-visible memory, mapped for its lifetime.
+ * @details Writes from the CPU are seen by the next dispatch. Results written by a shader can be
+ * read from `GetMapped` once the frame that dispatched it has completed.
+ */
+class ComputeBuffer {
+ public:
+  /**
+   * @brief Constructs a new ComputeBuffer.
+   * @param size The size of the buffer in bytes.
+   */
+  explicit ComputeBuffer(uint64_t size);
+  /**
+   * @brief Destroys the ComputeBuffer once the GPU is done with it.
+   */
+  ~ComputeBuffer();
+
+  ComputeBuffer(const ComputeBuffer&) = delete;
+  ComputeBuffer& operator=(const ComputeBuffer&) = delete;
+
+  /**
+   * @brief Copies data into the buffer.
+   * @param data The data to copy.
+   * @param size The number of bytes to copy.
+   * @param offset The offset into the buffer in bytes.
+   */
+  void SetData(const void* data, uint64_t size, uint64_t offset = 0);
+
+  /**
+   * @brief Gets the mapped memory of the buffer.
+   * @return A pointer to the first byte of the buffer.
+   */
+  uint8_t* GetMapped() const {
+    return m_Mapped;
+  }
+  /**
+   * @brief Gets the size of the buffer.
+   * @return The size in bytes.
+   */
+  uint64_t GetSize() const {
+    return m_Size;
+  }
+  /**
+   * @brief Gets the Vulkan buffer.
+   * @return The Vulkan buffer.
+   */
+  VkBuffer GetVulkanBuffer() const {
+    return m_Buffer;
+  }
+
+ private:
+  uint64_t m_Size = 0;
+  VkBuffer m_Buffer = VK_NULL_HANDLE;
+  VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+  uint8_t* m_Mapped = nullptr;
+};
+
+}  // namespace Weaver
+
+#endif
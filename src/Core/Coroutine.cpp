@@ -0,0 +1,215 @@
+/**
+ * @file Coroutine.cpp
+ * @author B.G. Smit
+ * @brief Implements the scheduler that resumes coroutines on the main thread.
+ * @copyright Copyright (c) 2025
+ */
+#include "Coroutine.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Weaver {
+
+namespace Utils {
+
+static CoroutineScheduler* s_Instance = nullptr;
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new CoroutineScheduler.
+ */
+CoroutineScheduler::CoroutineScheduler() : m_Mailbox(std::make_shared<Mailbox>()) {
+  Utils::s_Instance = this;
+}
+
+/**
+ * @brief Waits for the outstanding resumers, then destroys the CoroutineScheduler and the
+ * coroutines suspended on it.
+ */
+CoroutineScheduler::~CoroutineScheduler() {
+  std::vector<std::coroutine_handle<>> posted;
+  {
+    // A job that finishes after the mailbox closed would destroy its coroutine on the worker,
+    // together with the layer state the coroutine references. Wait for those jobs instead.
+    std::unique_lock<std::mutex> lock(m_Mailbox->Mutex);
+    m_Mailbox->Released.wait(lock, [this]() { return m_Mailbox->Outstanding == 0; });
+    m_Mailbox->Closed = true;
+    posted.swap(m_Mailbox->Handles);
+  }
+
+  // Destroying a coroutine also destroys the coroutines that await it.
+  for (auto handle : m_NextFrame)
+    handle.destroy();
+  for (auto& timer : m_Timers)
+    timer.second.destroy();
+  for (auto& frame : m_Frames)
+    frame.second.destroy();
+  for (auto handle : posted)
+    handle.destroy();
+
+  if (Utils::s_Instance == this)
+    Utils::s_Instance = nullptr;
+}
+
+/**
+ * @brief Gets the scheduler of the `Canvas`.
+ * @return A reference to the scheduler.
+ */
+CoroutineScheduler& CoroutineScheduler::Get() {
+  if (!Utils::s_Instance)
+    throw std::runtime_error("The coroutine scheduler has not been created!");
+  return *Utils::s_Instance;
+}
+
+/**
+ * @brief Resumes a coroutine at the next `ResumeReady`.
+ * @param handle The coroutine.
+ */
+void CoroutineScheduler::ResumeNextFrame(std::coroutine_handle<> handle) {
+  m_NextFrame.push_back(handle);
+}
+
+/**
+ * @brief Resumes a coroutine at the first `ResumeReady` after a point in time.
+ * @param time The point in time.
+ * @param handle The coroutine.
+ */
+void CoroutineScheduler::ResumeAt(Clock::time_point time, std::coroutine_handle<> handle) {
+  m_Timers.emplace_back(time, handle);
+}
+
+/**
+ * @brief Resumes a coroutine once the GPU has finished a frame.
+ * @param frame The frame.
+ * @param handle The coroutine.
+ */
+void CoroutineScheduler::ResumeAfterFrame(uint64_t frame, std::coroutine_handle<> handle) {
+  m_Frames.emplace_back(frame, handle);
+}
+
+/**
+ * @brief Resumes a coroutine at the next `ResumeReady`. Safe on any thread.
+ * @param handle The coroutine.
+ */
+void CoroutineScheduler::Post(std::coroutine_handle<> handle) {
+  Post(*m_Mailbox, handle);
+}
+
+/**
+ * @brief Creates a function that posts a coroutine, for completion callbacks on other threads.
+ * @param handle The coroutine.
+ * @return The function.
+ */
+std::function<void()> CoroutineScheduler::MakeResumer(std::coroutine_handle<> handle) const {
+  {
+    std::lock_guard<std::mutex> lock(m_Mailbox->Mutex);
+    m_Mailbox->Outstanding++;
+  }
+  // The ticket is released when the last copy of the function is destroyed, which the job
+  // system does right after calling it, or when the job is dropped without running.
+  std::shared_ptr<Mailbox> ticket(m_Mailbox.get(), [mailbox = m_Mailbox](Mailbox*) {
+    std::lock_guard<std::mutex> lock(mailbox->Mutex);
+    if (--mailbox->Outstanding == 0)
+      mailbox->Released.notify_all();
+  });
+  return [ticket = std::move(ticket), handle]() { Post(*ticket, handle); };
+}
+
+/**
+ * @brief Resumes a coroutine at the next `ResumeReady`, or destroys it if the scheduler is closed.
+ * @param mailbox The mailbox of the scheduler.
+ * @param handle The coroutine.
+ */
+void CoroutineScheduler::Post(Mailbox& mailbox, std::coroutine_handle<> handle) {
+  {
+    std::lock_guard<std::mutex> lock(mailbox.Mutex);
+    if (!mailbox.Closed) {
+      mailbox.Handles.push_back(handle);
+      return;
+    }
+  }
+  handle.destroy();
+}
+
+/**
+ * @brief Resumes the coroutines that are ready.
+ * @param completed_frames The number of frames the GPU has finished.
+ * @return The number of coroutines resumed.
+ */
+size_t CoroutineScheduler::ResumeReady(uint64_t completed_frames) {
+  // Collect first, so coroutines that suspend again are not resumed twice in one call.
+  m_Resuming.clear();
+  m_Resuming.swap(m_NextFrame);
+  {
+    std::lock_guard<std::mutex> lock(m_Mailbox->Mutex);
+    m_Resuming.insert(m_Resuming.end(), m_Mailbox->Handles.begin(), m_Mailbox->Handles.end());
+    m_Mailbox->Handles.clear();
+  }
+
+  const Clock::time_point now = Clock::now();
+  auto timer = m_Timers.begin();
+  while (timer != m_Timers.end()) {
+    if (timer->first <= now) {
+      m_Resuming.push_back(timer->second);
+      *timer = m_Timers.back();
+      m_Timers.pop_back();
+    } else {
+      ++timer;
+    }
+  }
+  auto frame = m_Frames.begin();
+  while (frame != m_Frames.end()) {
+    if (frame->first < completed_frames) {
+      m_Resuming.push_back(frame->second);
+      *frame = m_Frames.back();
+      m_Frames.pop_back();
+    } else {
+      ++frame;
+    }
+  }
+
+  // Resuming may add to m_NextFrame, so iterate over a local copy.
+  std::vector<std::coroutine_handle<>> resuming;
+  resuming.swap(m_Resuming);
+  for (auto handle : resuming)
+    handle.resume();
+  const size_t resumed = resuming.size();
+  resuming.clear();
+  m_Resuming.swap(resuming);
+  return resumed;
+}
+
+/**
+ * @brief Gets the number of suspended coroutines.
+ * @return The number of coroutines waiting to be resumed.
+ */
+size_t CoroutineScheduler::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(m_Mailbox->Mutex);
+  return m_NextFrame.size() + m_Timers.size() + m_Frames.size() + m_Mailbox->Handles.size();
+}
+
+/**
+ * @brief Checks if a coroutine waits for the next frame, a GPU frame, or has been posted.
+ * @return True if the next frames should be rendered.
+ */
+bool CoroutineScheduler::IsWaitingForFrames() const {
+  if (!m_NextFrame.empty() || !m_Frames.empty())
+    return true;
+  std::lock_guard<std::mutex> lock(m_Mailbox->Mutex);
+  return !m_Mailbox->Handles.empty();
+}
+
+/**
+ * @brief Gets the earliest point in time a delayed coroutine resumes at.
+ * @return The point in time, or `Clock::time_point::max()` if no coroutine is delayed.
+ */
+CoroutineScheduler::Clock::time_point CoroutineScheduler::GetNextResumeTime() const {
+  Clock::time_point next = Clock::time_point::max();
+  for (const auto& timer : m_Timers)
+    next = std::min(next, timer.first);
+  return next;
+}
+
+}  // namespace Weaver
@@ -0,0 +1,490 @@
+/**
+ * @file Coroutine.h
+ * @author B.G. Smit
+ * @brief Declares the C++20 coroutine support for multi-step work in layers.
+ *
+ * This file defines `AsyncTask`, the return type of coroutines, the `CoroutineScheduler` that
+ * resumes them, and the awaitables: `NextFrame()`, `Delay(ms)`, `WaitForGpuFrame(frame)`,
+ * `RunInBackground(func)` and `co_await` on a `JobHandle`. A coroutine starts running when it is
+ * called and is always resumed on the main thread, once per frame in `Canvas::Run` after the
+ * events have been dispatched and before the layers update, so it may touch layer state and
+ * ImGui-free Core objects without locks. Work that must not block the UI goes to a worker with
+ * `RunInBackground` or the `JobSystem`. For example:
+ *
+ *     Weaver::AsyncTask<> Load(std::string path) {
+ *       Weaver::ImageData data = co_await Weaver::RunInBackground([path]() { ... });
+ *       co_await m_Image->UploadAsync(data.Pixels.get());
+ *       co_await Weaver::Delay(500.0f);
+ *     }
+ * @copyright Copyright (c) 2025
+ */
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace Weaver {
+
+/**
+ * @class CoroutineScheduler
+ * @brief Keeps suspended coroutines until the main thread resumes them.
+ * @details Owned by the `Canvas` and available through `Get`. Every method but `Post` and
+ * `MakeResumer` must be called on the main thread. Coroutines still suspended when the scheduler
+ * is destroyed are destroyed without being resumed. The destructor first waits for the resumers
+ * handed to background jobs (`RunInBackground`, `co_await` on a `JobHandle`) to be called or
+ * dropped, so every coroutine is destroyed on the main thread; those jobs must therefore not
+ * wait for the main thread.
+ */
+class CoroutineScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Constructs a new CoroutineScheduler. Becomes the instance of `Get`.
+   */
+  CoroutineScheduler();
+  /**
+   * @brief Waits for the outstanding resumers, then destroys the CoroutineScheduler and the
+   * coroutines suspended on it.
+   */
+  ~CoroutineScheduler();
+
+  CoroutineScheduler(const CoroutineScheduler&) = delete;
+  CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+  /**
+   * @brief Gets the scheduler of the `Canvas`.
+   * @return A reference to the scheduler.
+   */
+  static CoroutineScheduler& Get();
+
+  /**
+   * @brief Resumes a coroutine at the next `ResumeReady`.
+   * @param handle The coroutine.
+   */
+  void ResumeNextFrame(std::coroutine_handle<> handle);
+  /**
+   * @brief Resumes a coroutine at the first `ResumeReady` after a point in time.
+   * @param time The point in time.
+   * @param handle The coroutine.
+   */
+  void ResumeAt(Clock::time_point time, std::coroutine_handle<> handle);
+  /**
+   * @brief Resumes a coroutine once the GPU has finished a frame.
+   * @param frame The frame, see `Canvas::GetFrameCount`.
+   * @param handle The coroutine.
+   */
+  void ResumeAfterFrame(uint64_t frame, std::coroutine_handle<> handle);
+  /**
+   * @brief Resumes a coroutine at the next `ResumeReady`. Safe on any thread.
+   * @param handle The coroutine.
+   */
+  void Post(std::coroutine_handle<> handle);
+  /**
+   * @brief Creates a function that posts a coroutine, for completion callbacks on other threads.
+   * @details The function may be called on any thread, at most once. The scheduler's destructor
+   * waits until the function and its copies are destroyed.
+   * @param handle The coroutine.
+   * @return The function.
+   */
+  std::function<void()> MakeResumer(std::coroutine_handle<> handle) const;
+
+  /**
+   * @brief Resumes the coroutines that are ready. Called once per frame by the `Canvas`.
+   * @details Coroutines that suspend again while being resumed wait for the next call.
+   * @param completed_frames The number of frames the GPU has finished, see
+   * `Canvas::IsFrameComplete`.
+   * @return The number of coroutines resumed.
+   */
+  size_t ResumeReady(uint64_t completed_frames);
+
+  /**
+   * @brief Gets the number of suspended coroutines.
+   * @return The number of coroutines waiting to be resumed.
+   */
+  size_t GetPendingCount() const;
+  /**
+   * @brief Checks if a coroutine waits for the next frame, a GPU frame, or has been posted.
+   * @details Unlike delays, these only advance while frames are rendered.
+   * @return True if the next frames should be rendered.
+   */
+  bool IsWaitingForFrames() const;
+  /**
+   * @brief Gets the earliest point in time a delayed coroutine resumes at.
+   * @return The point in time, or `Clock::time_point::max()` if no coroutine is delayed.
+   */
+  Clock::time_point GetNextResumeTime() const;
+
+ private:
+  /**
+   * @struct Mailbox
+   * @brief The coroutines posted from other threads, and the number of resumers alive.
+   */
+  struct Mailbox {
+    std::mutex Mutex;
+    std::condition_variable Released;
+    std::vector<std::coroutine_handle<>> Handles;
+    size_t Outstanding = 0;
+    bool Closed = false;
+  };
+
+  /**
+   * @brief Resumes a coroutine at the next `ResumeReady`, or destroys it if the scheduler is
+   * closed.
+   * @param mailbox The mailbox of the scheduler.
+   * @param handle The coroutine.
+   */
+  static void Post(Mailbox& mailbox, std::coroutine_handle<> handle);
+
+ private:
+  std::vector<std::coroutine_handle<>> m_NextFrame;
+  std::vector<std::pair<Clock::time_point, std::coroutine_handle<>>> m_Timers;
+  std::vector<std::pair<uint64_t, std::coroutine_handle<>>> m_Frames;
+  std::shared_ptr<Mailbox> m_Mailbox;
+  std::vector<std::coroutine_handle<>> m_Resuming;
+};
+
+namespace Detail {
+
+/**
+ * @struct AsyncState
+ * @brief The result of an `AsyncTask`, shared by the coroutine and its task object.
+ */
+template <typename T>
+struct AsyncState {
+  std::optional<T> Value;
+  std::exception_ptr Error;
+  bool Done = false;
+  // The coroutine that awaits the task.
+  std::coroutine_handle<> Continuation;
+};
+
+template <>
+struct AsyncState<void> {
+  std::exception_ptr Error;
+  bool Done = false;
+  std::coroutine_handle<> Continuation;
+};
+
+/**
+ * @struct AsyncPromiseBase
+ * @brief The parts of the promise of an `AsyncTask` that do not depend on the result.
+ */
+template <typename T>
+struct AsyncPromiseBase {
+  std::shared_ptr<AsyncState<T>> State = std::make_shared<AsyncState<T>>();
+
+  /**
+   * @struct FinalAwaiter
+   * @brief Frees the finished coroutine and resumes the coroutine that awaited it.
+   */
+  struct FinalAwaiter {
+    bool await_ready() noexcept {
+      return false;
+    }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      std::shared_ptr<AsyncState<T>> state = std::move(handle.promise().State);
+      handle.destroy();
+      state->Done = true;
+      if (state->Continuation)
+        return std::exchange(state->Continuation, nullptr);
+      return std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+  };
+
+  ~AsyncPromiseBase() {
+    // Destroyed while suspended, the awaiting coroutine will never be resumed either.
+    if (State && State->Continuation)
+      std::exchange(State->Continuation, nullptr).destroy();
+  }
+
+  std::suspend_never initial_suspend() noexcept {
+    return {};
+  }
+  FinalAwaiter final_suspend() noexcept {
+    return {};
+  }
+  void unhandled_exception() {
+    State->Error = std::current_exception();
+  }
+};
+
+}  // namespace Detail
+
+/**
+ * @class AsyncTask
+ * @brief The return type of a coroutine, and an awaitable for its result.
+ * @details The coroutine starts when called and keeps running, resumed on the main thread, even
+ * if the task object is dropped. Another coroutine can `co_await` the task to receive its
+ * result; exceptions thrown by the coroutine are rethrown there or by `GetResult`.
+ */
+template <typename T = void>
+class AsyncTask {
+ public:
+  struct promise_type : Detail::AsyncPromiseBase<T> {
+    AsyncTask get_return_object() {
+      return AsyncTask(this->State);
+    }
+    template <typename Value>
+    void return_value(Value&& value) {
+      this->State->Value.emplace(std::forward<Value>(value));
+    }
+  };
+
+  AsyncTask() = default;
+
+  /**
+   * @brief Checks if the coroutine has finished.
+   * @return True if it has returned or thrown.
+   */
+  bool IsDone() const {
+    return m_State && m_State->Done;
+  }
+  /**
+   * @brief Gets the result of a finished coroutine, rethrowing its exception.
+   * @return The value the coroutine returned.
+   */
+  T& GetResult() {
+    if (m_State->Error)
+      std::rethrow_exception(m_State->Error);
+    return *m_State->Value;
+  }
+
+  bool await_ready() const {
+    return IsDone();
+  }
+  void await_suspend(std::coroutine_handle<> handle) {
+    m_State->Continuation = handle;
+  }
+  T await_resume() {
+    return std::move(GetResult());
+  }
+
+ private:
+  explicit AsyncTask(std::shared_ptr<Detail::AsyncState<T>> state) : m_State(std::move(state)) {}
+
+  std::shared_ptr<Detail::AsyncState<T>> m_State;
+};
+
+/**
+ * @class AsyncTask<void>
+ * @brief The return type of a coroutine that returns nothing.
+ */
+template <>
+class AsyncTask<void> {
+ public:
+  struct promise_type : Detail::AsyncPromiseBase<void> {
+    AsyncTask get_return_object() {
+      return AsyncTask(State);
+    }
+    void return_void() {}
+  };
+
+  AsyncTask() = default;
+
+  /**
+   * @brief Checks if the coroutine has finished.
+   * @return True if it has returned or thrown.
+   */
+  bool IsDone() const {
+    return m_State && m_State->Done;
+  }
+  /**
+   * @brief Rethrows the exception of a finished coroutine, if any.
+   */
+  void GetResult() const {
+    if (m_State->Error)
+      std::rethrow_exception(m_State->Error);
+  }
+
+  bool await_ready() const {
+    return IsDone();
+  }
+  void await_suspend(std::coroutine_handle<> handle) {
+    m_State->Continuation = handle;
+  }
+  void await_resume() const {
+    GetResult();
+  }
+
+ private:
+  explicit AsyncTask(std::shared_ptr<Detail::AsyncState<void>> state) : m_State(std::move(state)) {}
+
+  std::shared_ptr<Detail::AsyncState<void>> m_State;
+};
+
+/**
+ * @struct NextFrameAwaiter
+ * @brief Resumes the coroutine in the next frame.
+ */
+struct NextFrameAwaiter {
+  bool await_ready() const noexcept {
+    return false;
+  }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    CoroutineScheduler::Get().ResumeNextFrame(handle);
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @struct DelayAwaiter
+ * @brief Resumes the coroutine in the first frame after a point in time.
+ */
+struct DelayAwaiter {
+  CoroutineScheduler::Clock::time_point Time;
+
+  bool await_ready() const noexcept {
+    return CoroutineScheduler::Clock::now() >= Time;
+  }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    CoroutineScheduler::Get().ResumeAt(Time, handle);
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @struct GpuFrameAwaiter
+ * @brief Resumes the coroutine once the GPU has finished a frame.
+ */
+struct GpuFrameAwaiter {
+  uint64_t Frame = 0;
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    CoroutineScheduler::Get().ResumeAfterFrame(Frame, handle);
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * @struct JobAwaiter
+ * @brief Resumes the coroutine on the main thread once a job has finished.
+ */
+struct JobAwaiter {
+  JobHandle Job;
+
+  bool await_ready() const noexcept {
+    return Job.IsDone();
+  }
+  void await_suspend(std::coroutine_handle<> handle) const {
+    JobSystem::Get().Then(Job, CoroutineScheduler::Get().MakeResumer(handle));
+  }
+  void await_resume() const {
+    // The job has finished, so this only rethrows its exception.
+    JobSystem::Get().Wait(Job);
+  }
+};
+
+/**
+ * @class BackgroundAwaiter
+ * @brief Runs a function on a worker and resumes the coroutine on the main thread with its result.
+ */
+template <typename Result>
+class BackgroundAwaiter {
+ public:
+  explicit BackgroundAwaiter(std::function<Result()> func) : m_Func(std::move(func)) {}
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+  void await_suspend(std::coroutine_handle<> handle) {
+    // The awaiter lives in the suspended coroutine, so the job can write into it.
+    JobSystem::Get().Schedule([this, resume = CoroutineScheduler::Get().MakeResumer(handle)]() {
+      try {
+        if constexpr (std::is_void_v<Result>)
+          m_Func();
+        else
+          m_Result.emplace(m_Func());
+      } catch (...) {
+        m_Error = std::current_exception();
+      }
+      resume();
+    });
+  }
+  Result await_resume() {
+    if (m_Error)
+      std::rethrow_exception(m_Error);
+    if constexpr (!std::is_void_v<Result>)
+      return std::move(*m_Result);
+  }
+
+ private:
+  struct Empty {};
+
+  std::function<Result()> m_Func;
+  std::optional<std::conditional_t<std::is_void_v<Result>, Empty, Result>> m_Result;
+  std::exception_ptr m_Error;
+};
+
+/**
+ * @brief Suspends the coroutine until the next frame.
+ * @return The awaitable.
+ */
+inline NextFrameAwaiter NextFrame() {
+  return {};
+}
+
+/**
+ * @brief Suspends the coroutine for at least a time, without blocking the main thread.
+ * @param milliseconds The time to wait.
+ * @return The awaitable.
+ */
+inline DelayAwaiter Delay(float milliseconds) {
+  return {CoroutineScheduler::Clock::now() +
+          std::chrono::duration_cast<CoroutineScheduler::Clock::duration>(
+              std::chrono::duration<float, std::milli>(milliseconds))};
+}
+
+/**
+ * @brief Suspends the coroutine until the GPU has finished a frame, e.g. the one that uploaded
+ * an image.
+ * @param frame The frame, see `Canvas::GetFrameCount`.
+ * @return The awaitable.
+ */
+inline GpuFrameAwaiter WaitForGpuFrame(uint64_t frame) {
+  return {frame};
+}
+
+/**
+ * @brief Runs a function on the job system and resumes the coroutine with its result.
+ * @param func The function, run on a worker.
+ * @return The awaitable. `co_await` returns the result of `func` or rethrows its exception.
+ */
+template <typename Func>
+auto RunInBackground(Func func) {
+  using Result = std::invoke_result_t<Func>;
+  return BackgroundAwaiter<Result>(std::function<Result()>(std::move(func)));
+}
+
+/**
+ * @brief Makes a job awaitable: `co_await jobs.Schedule(...)` resumes once the job has finished.
+ * @param job The job.
+ * @return The awaitable, which rethrows the exception of the job.
+ */
+inline JobAwaiter operator co_await(const JobHandle& job) {
+  return {job};
+}
+
+}  // namespace Weaver
+
+#endif
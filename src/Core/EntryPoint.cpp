@@ -13,6 +13,7 @@
 bool g_CanvasRunning = true;
 
 #include "Common/Settings.h"
+#include "JobSystem.h"
 #include "Log.h"
 #include "absl/flags/parse.h"
 
@@ -28,6 +29,10 @@ int Main(int argc, char** argv) {
   absl::ParseCommandLine(argc, argv);
   Log::Init();
 
+  // Started before the canvas and stopped after it, so layers can use it for their whole life.
+  JobSystem jobs;
+  WEAVER_LOG_INFO("Job system started with ") << jobs.GetWorkerCount() << " workers.";
+
   WEAVER_LOG_INFO "This is an info message.";
   WEAVER_LOG_WARN "This is a warning message.";
   WEAVER_LOG_ERROR "This is an error message.";
@@ -0,0 +1,57 @@
+/**
+ * @file EventBus.cpp
+ * @author B.G. Smit
+ * @brief Implements the typed event bus.
+ * @copyright Copyright (c) 2025
+ */
+#include "EventBus.h"
+
+#include <atomic>
+
+namespace Weaver {
+
+namespace Detail {
+
+/**
+ * @brief Hands out the next unused event type id.
+ * @return The id.
+ */
+EventTypeId NextEventTypeId() {
+  static std::atomic<EventTypeId> next{0};
+  return next++;
+}
+
+}  // namespace Detail
+
+/**
+ * @brief Delivers the queued events and clears the queue.
+ * @param listeners The listeners in delivery order, from the top of the layer stack down.
+ */
+void EventBus::Dispatch(const std::vector<EventListener*>& listeners) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::swap(m_Pending, m_Delivering);
+  }
+
+  m_DispatchedCount = 0;
+  m_CoalescedCount = m_Delivering.Coalesced;
+  for (const Batch::Entry& entry : m_Delivering.Order) {
+    if (entry.Type == kNoType)
+      continue;
+    const void* event = m_Delivering.Queues[entry.Type]->Get(entry.Index);
+    for (EventListener* listener : listeners) {
+      if (listener->Invoke(entry.Type, event))
+        break;
+    }
+    m_DispatchedCount++;
+  }
+
+  m_Delivering.Order.clear();
+  for (auto& queue : m_Delivering.Queues) {
+    if (queue)
+      queue->Clear();
+  }
+  m_Delivering.Coalesced = 0;
+}
+
+}  // namespace Weaver
@@ -0,0 +1,238 @@
+/**
+ * @file EventBus.h
+ * @author B.G. Smit
+ * @brief Declares the typed event bus that delivers window and input events to the layers.
+ *
+ * This file defines the `EventBus` class and the `EventListener` a subscriber registers its
+ * handlers with. Events are plain structs, see `Events.h`. They are queued when published and
+ * delivered in a batch once per frame, in the order they were published, to the listeners from
+ * the top of the layer stack down; a handler that returns true marks the event as handled and
+ * stops it from reaching the listeners below. An event type that declares
+ * `static constexpr bool Coalesce = true` keeps only its latest event per frame, which collapses
+ * high-frequency events such as mouse motion and resizing; if it also has a
+ * `void Merge(const T& older)` member, the replaced event is folded into the newer one, e.g. to
+ * sum the motion of the dropped events. A listener only stores handlers for
+ * the types it subscribed to, indexed by type, so other events cost a bounds check.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Weaver {
+
+using EventTypeId = uint32_t;
+
+namespace Detail {
+
+/**
+ * @brief Hands out the next unused event type id.
+ * @return The id.
+ */
+EventTypeId NextEventTypeId();
+
+/**
+ * @brief Whether events of a type replace the previous event of the type queued in a frame.
+ */
+template <typename T, typename = void>
+struct IsCoalesced : std::false_type {};
+template <typename T>
+struct IsCoalesced<T, std::void_t<decltype(T::Coalesce)>> : std::bool_constant<T::Coalesce> {};
+
+/**
+ * @brief Whether a coalesced event type folds the event it replaces into the newer one.
+ */
+template <typename T, typename = void>
+struct HasMerge : std::false_type {};
+template <typename T>
+struct HasMerge<T, std::void_t<decltype(std::declval<T&>().Merge(std::declval<const T&>()))>>
+    : std::true_type {};
+
+}  // namespace Detail
+
+/**
+ * @brief Gets the id of an event type. The ids are dense and start at zero.
+ * @return The id of `T`.
+ */
+template <typename T>
+EventTypeId GetEventTypeId() {
+  static const EventTypeId id = Detail::NextEventTypeId();
+  return id;
+}
+
+/**
+ * @class EventListener
+ * @brief The handlers of one subscriber, at most one per event type.
+ * @details Every `Layer` owns one. Handlers are added on the main thread, outside of a handler.
+ */
+class EventListener {
+ public:
+  /**
+   * @brief Registers the handler of an event type, replacing the previous one.
+   * @param handler Called with each event of the type. Returns true if it handled the event.
+   */
+  template <typename T>
+  void Subscribe(std::function<bool(const T&)> handler) {
+    const EventTypeId type = GetEventTypeId<T>();
+    if (type >= m_Handlers.size())
+      m_Handlers.resize(type + 1);
+    m_Handlers[type] = [handler = std::move(handler)](const void* event) {
+      return handler(*static_cast<const T*>(event));
+    };
+  }
+  /**
+   * @brief Removes the handler of an event type.
+   */
+  template <typename T>
+  void Unsubscribe() {
+    const EventTypeId type = GetEventTypeId<T>();
+    if (type < m_Handlers.size())
+      m_Handlers[type] = nullptr;
+  }
+  /**
+   * @brief Checks if a handler is registered for an event type.
+   * @param type The id of the event type.
+   * @return True if the listener handles the type.
+   */
+  bool IsSubscribed(EventTypeId type) const {
+    return type < m_Handlers.size() && m_Handlers[type];
+  }
+  /**
+   * @brief Calls the handler of an event's type, if any.
+   * @param type The id of the event type.
+   * @param event The event.
+   * @return True if the handler handled the event.
+   */
+  bool Invoke(EventTypeId type, const void* event) const {
+    return IsSubscribed(type) && m_Handlers[type](event);
+  }
+
+ private:
+  std::vector<std::function<bool(const void*)>> m_Handlers;
+};
+
+/**
+ * @class EventBus
+ * @brief Queues typed events and delivers them in a batch.
+ * @details Owned by the `Canvas`, which publishes the SDL window and input events and dispatches
+ * them to the layers after polling. `Publish` is thread-safe; `Dispatch` runs on the main thread.
+ */
+class EventBus {
+ public:
+  /**
+   * @brief Queues an event for the next `Dispatch`. Thread-safe.
+   * @param event The event.
+   */
+  template <typename T>
+  void Publish(const T& event) {
+    const EventTypeId type = GetEventTypeId<T>();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Queue<T>& queue = GetQueue<T>(m_Pending, type);
+    T queued = event;
+    if (Detail::IsCoalesced<T>::value && queue.Slot != kNoSlot) {
+      // The newer event takes the place of the older one in the publishing order.
+      Batch::Entry& older = m_Pending.Order[queue.Slot];
+      older.Type = kNoType;
+      m_Pending.Coalesced++;
+      if constexpr (Detail::HasMerge<T>::value)
+        queued.Merge(queue.Events[older.Index]);
+    }
+    queue.Slot = m_Pending.Order.size();
+    m_Pending.Order.push_back({type, (uint32_t)queue.Events.size()});
+    queue.Events.push_back(std::move(queued));
+  }
+
+  /**
+   * @brief Delivers the queued events and clears the queue.
+   * @param listeners The listeners in delivery order, from the top of the layer stack down.
+   */
+  void Dispatch(const std::vector<EventListener*>& listeners);
+
+  /**
+   * @brief Gets the number of events delivered by the last `Dispatch`.
+   * @return The number of events.
+   */
+  size_t GetDispatchedCount() const {
+    return m_DispatchedCount;
+  }
+  /**
+   * @brief Gets the number of events the last `Dispatch` dropped because a newer one replaced them.
+   * @return The number of coalesced events.
+   */
+  size_t GetCoalescedCount() const {
+    return m_CoalescedCount;
+  }
+
+ private:
+  static constexpr EventTypeId kNoType = ~EventTypeId(0);
+  static constexpr size_t kNoSlot = ~size_t(0);
+
+  /**
+   * @struct QueueBase
+   * @brief The events of one type queued in a frame.
+   */
+  struct QueueBase {
+    virtual ~QueueBase() = default;
+    virtual const void* Get(uint32_t index) const = 0;
+    virtual void Clear() = 0;
+    // The position in `Batch::Order` of the newest event, for coalescing.
+    size_t Slot = kNoSlot;
+  };
+  template <typename T>
+  struct Queue : QueueBase {
+    std::vector<T> Events;
+    const void* Get(uint32_t index) const override {
+      return &Events[index];
+    }
+    void Clear() override {
+      Events.clear();
+      Slot = kNoSlot;
+    }
+  };
+
+  /**
+   * @struct Batch
+   * @brief The events of a frame, stored per type, and the order they were published in.
+   */
+  struct Batch {
+    struct Entry {
+      EventTypeId Type;
+      uint32_t Index;
+    };
+    std::vector<Entry> Order;
+    std::vector<std::unique_ptr<QueueBase>> Queues;
+    size_t Coalesced = 0;
+  };
+
+  template <typename T>
+  static Queue<T>& GetQueue(Batch& batch, EventTypeId type) {
+    if (type >= batch.Queues.size())
+      batch.Queues.resize(type + 1);
+    if (!batch.Queues[type])
+      batch.Queues[type] = std::make_unique<Queue<T>>();
+    return static_cast<Queue<T>&>(*batch.Queues[type]);
+  }
+
+ private:
+  std::mutex m_Mutex;
+  // Events published since the last dispatch. Swapped with `m_Delivering` by `Dispatch`, so the
+  // queues keep their capacity and events published by handlers go to the next dispatch.
+  Batch m_Pending;
+  Batch m_Delivering;
+
+  size_t m_DispatchedCount = 0;
+  size_t m_CoalescedCount = 0;
+};
+
+}  // namespace Weaver
+
+#endif
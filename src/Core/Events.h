@@ -0,0 +1,127 @@
+/**
+ * @file Events.h
+ * @author B.G. Smit
+ * @brief Defines the window and input events published by the Canvas.
+ *
+ * Layers subscribe to these with `Layer::Subscribe` and receive them through the `EventBus` once
+ * per frame, before `OnUpdate`. Mouse positions are in window coordinates. Input events are
+ * delivered even when ImGui wants the input; `CapturedByUI` tells a layer that acts on input
+ * outside of its windows to ignore them.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#pragma once
+
+#include <cstdint>
+
+#include "Input/KeyCodes.h"
+
+namespace Weaver {
+
+/**
+ * @struct WindowResizeEvent
+ * @brief The window was resized. Coalesced, only the final size of a frame is delivered.
+ */
+struct WindowResizeEvent {
+  static constexpr bool Coalesce = true;
+  uint32_t Width = 0;
+  uint32_t Height = 0;
+};
+
+/**
+ * @struct WindowMinimizeEvent
+ * @brief The window was minimized.
+ */
+struct WindowMinimizeEvent {};
+
+/**
+ * @struct WindowMaximizeEvent
+ * @brief The window was maximized.
+ */
+struct WindowMaximizeEvent {};
+
+/**
+ * @struct WindowRestoreEvent
+ * @brief The window was restored from being minimized or maximized.
+ */
+struct WindowRestoreEvent {};
+
+/**
+ * @struct KeyPressedEvent
+ * @brief A key was pressed, or is repeating while held.
+ */
+struct KeyPressedEvent {
+  KeyCode Key;
+  bool Repeat = false;
+  bool CapturedByUI = false; /**< ImGui wants the keyboard (`ImGuiIO::WantCaptureKeyboard`). */
+};
+
+/**
+ * @struct KeyReleasedEvent
+ * @brief A key was released.
+ */
+struct KeyReleasedEvent {
+  KeyCode Key;
+  bool CapturedByUI = false; /**< ImGui wants the keyboard (`ImGuiIO::WantCaptureKeyboard`). */
+};
+
+/**
+ * @struct MouseMovedEvent
+ * @brief The mouse moved. Coalesced, only the final position of a frame is delivered, with the
+ * movement of the whole frame.
+ */
+struct MouseMovedEvent {
+  static constexpr bool Coalesce = true;
+  float X = 0.0f;
+  float Y = 0.0f;
+  float DeltaX = 0.0f;       /**< The movement since the previous event. */
+  float DeltaY = 0.0f;       /**< The movement since the previous event. */
+  bool CapturedByUI = false; /**< ImGui wants the mouse (`ImGuiIO::WantCaptureMouse`). */
+
+  /**
+   * @brief Adds the movement of the event this one replaces.
+   * @param older The replaced event.
+   */
+  void Merge(const MouseMovedEvent& older) {
+    DeltaX += older.DeltaX;
+    DeltaY += older.DeltaY;
+  }
+};
+
+/**
+ * @struct MouseButtonPressedEvent
+ * @brief A mouse button was pressed.
+ */
+struct MouseButtonPressedEvent {
+  MouseButton Button;
+  float X = 0.0f;
+  float Y = 0.0f;
+  bool CapturedByUI = false; /**< ImGui wants the mouse (`ImGuiIO::WantCaptureMouse`). */
+};
+
+/**
+ * @struct MouseButtonReleasedEvent
+ * @brief A mouse button was released.
+ */
+struct MouseButtonReleasedEvent {
+  MouseButton Button;
+  float X = 0.0f;
+  float Y = 0.0f;
+  bool CapturedByUI = false; /**< ImGui wants the mouse (`ImGuiIO::WantCaptureMouse`). */
+};
+
+/**
+ * @struct MouseScrolledEvent
+ * @brief The mouse wheel was scrolled.
+ */
+struct MouseScrolledEvent {
+  float XOffset = 0.0f;
+  float YOffset = 0.0f;
+  bool CapturedByUI = false; /**< ImGui wants the mouse (`ImGuiIO::WantCaptureMouse`). */
+};
+
+}  // namespace Weaver
+
+#endif
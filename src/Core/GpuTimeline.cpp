@@ -0,0 +1,196 @@
+/**
+ * @file GpuTimeline.cpp
+ * @author B.G. Smit
+ * @brief Implements the timeline that orders every queue submission of the application.
+ * @copyright Copyright (c) 2025
+ */
+#include "GpuTimeline.h"
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief Raises an atomic timeline value to a later value.
+ * @param value The atomic to raise.
+ * @param reached The value that was reached.
+ */
+static void RaiseValue(std::atomic<uint64_t>& value, uint64_t reached) {
+  uint64_t current = value.load(std::memory_order_relaxed);
+  while (current < reached &&
+         !value.compare_exchange_weak(current, reached, std::memory_order_release)) {
+  }
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new GpuTimeline.
+ * @param use_timeline_semaphore Whether the device has `VK_KHR_timeline_semaphore` enabled.
+ */
+GpuTimeline::GpuTimeline(bool use_timeline_semaphore) {
+  if (!use_timeline_semaphore)
+    return;
+
+  VkDevice device = Canvas::GetDevice();
+  VkSemaphoreTypeCreateInfoKHR type_info = {};
+  type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+  type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+  type_info.initialValue = 0;
+  VkSemaphoreCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  create_info.pNext = &type_info;
+  VkResult err = vkCreateSemaphore(device, &create_info, nullptr, &m_Semaphore);
+  check_vk_result(err);
+
+  m_GetCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(
+      device, "vkGetSemaphoreCounterValueKHR");
+  m_WaitSemaphores =
+      (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+}
+
+/**
+ * @brief Destroys the GpuTimeline. The device must be idle.
+ */
+GpuTimeline::~GpuTimeline() {
+  VkDevice device = Canvas::GetDevice();
+  if (m_Semaphore)
+    vkDestroySemaphore(device, m_Semaphore, nullptr);
+  for (auto& [value, fence] : m_Pending)
+    vkDestroyFence(device, fence, nullptr);
+  for (VkFence fence : m_FreeFences)
+    vkDestroyFence(device, fence, nullptr);
+}
+
+/**
+ * @brief Submits a batch that additionally signals the next timeline value.
+ * @param queue The queue to submit to.
+ * @param info The batch.
+ * @return The value signaled when the batch completes.
+ */
+uint64_t GpuTimeline::Submit(VkQueue queue, const VkSubmitInfo& info) {
+  const uint64_t value = m_Submitted.load(std::memory_order_relaxed) + 1;
+  VkResult err;
+
+  if (m_Semaphore) {
+    // Binary semaphores ignore their value, only the timeline's is read.
+    std::vector<VkSemaphore> signal_semaphores(
+        info.pSignalSemaphores, info.pSignalSemaphores + info.signalSemaphoreCount);
+    std::vector<uint64_t> signal_values(signal_semaphores.size(), 0);
+    signal_semaphores.push_back(m_Semaphore);
+    signal_values.push_back(value);
+
+    VkTimelineSemaphoreSubmitInfoKHR timeline_info = {};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timeline_info.pNext = info.pNext;
+    timeline_info.signalSemaphoreValueCount = (uint32_t)signal_values.size();
+    timeline_info.pSignalSemaphoreValues = signal_values.data();
+
+    VkSubmitInfo submit_info = info;
+    submit_info.pNext = &timeline_info;
+    submit_info.signalSemaphoreCount = (uint32_t)signal_semaphores.size();
+    submit_info.pSignalSemaphores = signal_semaphores.data();
+    err = vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+    check_vk_result(err);
+  } else {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    VkFence fence = VK_NULL_HANDLE;
+    if (!m_FreeFences.empty()) {
+      fence = m_FreeFences.back();
+      m_FreeFences.pop_back();
+    } else {
+      VkFenceCreateInfo fence_info = {};
+      fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      err = vkCreateFence(Canvas::GetDevice(), &fence_info, nullptr, &fence);
+      check_vk_result(err);
+    }
+    err = vkQueueSubmit(queue, 1, &info, fence);
+    check_vk_result(err);
+    m_Pending.emplace_back(value, fence);
+  }
+
+  m_Submitted.store(value, std::memory_order_release);
+  return value;
+}
+
+/**
+ * @brief Gets the highest value whose work has completed.
+ * @return The completed value.
+ */
+uint64_t GpuTimeline::GetCompletedValue() {
+  if (m_Semaphore) {
+    uint64_t value = 0;
+    VkResult err = m_GetCounterValue(Canvas::GetDevice(), m_Semaphore, &value);
+    check_vk_result(err);
+    Utils::RaiseValue(m_Completed, value);
+  } else {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    PollFences();
+  }
+  return m_Completed.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Checks if the work of a value has completed, without waiting.
+ * @param value The value returned by `Submit`.
+ * @return True if the value was reached.
+ */
+bool GpuTimeline::IsComplete(uint64_t value) {
+  return value <= m_Completed.load(std::memory_order_acquire) || value <= GetCompletedValue();
+}
+
+/**
+ * @brief Waits until the work of a value has completed.
+ * @param value The value returned by `Submit`.
+ */
+void GpuTimeline::Wait(uint64_t value) {
+  if (IsComplete(value))
+    return;
+
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+  if (m_Semaphore) {
+    VkSemaphoreWaitInfoKHR wait_info = {};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &m_Semaphore;
+    wait_info.pValues = &value;
+    err = m_WaitSemaphores(device, &wait_info, UINT64_MAX);
+    check_vk_result(err);
+    Utils::RaiseValue(m_Completed, value);
+    return;
+  }
+
+  // A fence also covers everything submitted before it, so the first one at or after the value
+  // is enough. The lock keeps the fence from being recycled during the wait.
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  for (auto& [pending_value, fence] : m_Pending) {
+    if (pending_value >= value) {
+      err = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+      check_vk_result(err);
+      break;
+    }
+  }
+  PollFences();
+}
+
+/**
+ * @brief Recycles the fences of completed submissions. Fence emulation only.
+ */
+void GpuTimeline::PollFences() {
+  VkDevice device = Canvas::GetDevice();
+  while (!m_Pending.empty()) {
+    auto [value, fence] = m_Pending.front();
+    if (vkGetFenceStatus(device, fence) != VK_SUCCESS)
+      break;
+    VkResult err = vkResetFences(device, 1, &fence);
+    check_vk_result(err);
+    m_FreeFences.push_back(fence);
+    m_Pending.pop_front();
+    Utils::RaiseValue(m_Completed, value);
+  }
+}
+
+}  // namespace Weaver
@@ -0,0 +1,114 @@
+/**
+ * @file GpuTimeline.h
+ * @author B.G. Smit
+ * @brief Declares the timeline that orders every queue submission of the application.
+ *
+ * This file defines the `GpuTimeline` class. Every submission to the graphics queue signals the
+ * next value of one device-wide counter, so "has this work completed" becomes a comparison of
+ * two integers and the CPU waits for exactly the value it needs. On devices with
+ * `VK_KHR_timeline_semaphore` the counter is a timeline semaphore; otherwise it is emulated with
+ * one pooled fence per submission.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef GPU_TIMELINE_H
+#define GPU_TIMELINE_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @class GpuTimeline
+ * @brief A monotonically increasing counter signaled by the GPU as submissions complete.
+ * @details Owned by the `Canvas`, which submits through it, see `Canvas::SubmitToQueue`. All
+ * methods are thread-safe; `Submit` must additionally be called with the queue locked.
+ */
+class GpuTimeline {
+ public:
+  /**
+   * @brief Constructs a new GpuTimeline.
+   * @param use_timeline_semaphore Whether the device has `VK_KHR_timeline_semaphore` enabled.
+   */
+  explicit GpuTimeline(bool use_timeline_semaphore);
+  /**
+   * @brief Destroys the GpuTimeline. The device must be idle.
+   */
+  ~GpuTimeline();
+
+  GpuTimeline(const GpuTimeline&) = delete;
+  GpuTimeline& operator=(const GpuTimeline&) = delete;
+
+  /**
+   * @brief Submits a batch that additionally signals the next timeline value.
+   * @details The semaphores of `info` are kept. The caller must hold the queue mutex.
+   * @param queue The queue to submit to.
+   * @param info The batch. Its fence slot is used by the timeline and must not be needed.
+   * @return The value signaled when the batch, and everything submitted before it, completes.
+   */
+  uint64_t Submit(VkQueue queue, const VkSubmitInfo& info);
+
+  /**
+   * @brief Gets the highest value whose work has completed.
+   * @return The completed value.
+   */
+  uint64_t GetCompletedValue();
+  /**
+   * @brief Gets the value signaled by the last submission.
+   * @return The submitted value.
+   */
+  uint64_t GetSubmittedValue() const {
+    return m_Submitted.load(std::memory_order_acquire);
+  }
+  /**
+   * @brief Checks if the work of a value has completed, without waiting.
+   * @param value The value returned by `Submit`.
+   * @return True if the value was reached.
+   */
+  bool IsComplete(uint64_t value);
+  /**
+   * @brief Waits until the work of a value has completed.
+   * @param value The value returned by `Submit`.
+   */
+  void Wait(uint64_t value);
+
+  /**
+   * @brief Checks if the timeline is backed by a timeline semaphore.
+   * @return True for a timeline semaphore, false for the fence emulation.
+   */
+  bool UsesTimelineSemaphore() const {
+    return m_Semaphore != VK_NULL_HANDLE;
+  }
+
+ private:
+  /**
+   * @brief Recycles the fences of completed submissions. Fence emulation only.
+   * @details The caller must hold `m_Mutex`.
+   */
+  void PollFences();
+
+ private:
+  VkSemaphore m_Semaphore = VK_NULL_HANDLE;
+  PFN_vkGetSemaphoreCounterValueKHR m_GetCounterValue = nullptr;
+  PFN_vkWaitSemaphoresKHR m_WaitSemaphores = nullptr;
+
+  std::atomic<uint64_t> m_Submitted{0};
+  std::atomic<uint64_t> m_Completed{0};
+
+  // Fence emulation: the fence of every submission that may not have completed yet.
+  std::mutex m_Mutex;
+  std::deque<std::pair<uint64_t, VkFence>> m_Pending;
+  std::vector<VkFence> m_FreeFences;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -13,12 +13,23 @@
 
 #include "Canvas.h"
 #include "Log.h"
+#include "MappedFile.h"
+#include "PixelConversion.h"
+#include "ReadbackQueue.h"
+#include "UploadQueue.h"
 #include "Windows.h"
 #include "backends/imgui_impl_vulkan.h"
 #include "imgui.h"
 
 #define STB_IMAGE_IMPLEMENTATION
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "stb_image/stb_image.h"
 
@@ -54,8 +65,15 @@ static uint32_t GetVulkanMemoryType(VkMemoryPropertyFlags properties, uint32_t t
  */
 static uint32_t BytesPerPixel(ImageFormat format) {
   switch (format) {
+    case ImageFormat::R8:
+      return 1;
+    case ImageFormat::RG8:
+      return 2;
     case ImageFormat::RGBA:
+    case ImageFormat::BGRA8:
       return 4;
+    case ImageFormat::RGBA16F:
+      return 8;
     case ImageFormat::RGBA32F:
       return 16;
   }
@@ -73,38 +91,596 @@ static VkFormat WeaverFormatToVulkanFormat(ImageFormat format) {
       return VK_FORMAT_R8G8B8A8_UNORM;
     case ImageFormat::RGBA32F:
       return VK_FORMAT_R32G32B32A32_SFLOAT;
+    case ImageFormat::R8:
+      return VK_FORMAT_R8_UNORM;
+    case ImageFormat::RG8:
+      return VK_FORMAT_R8G8_UNORM;
+    case ImageFormat::RGBA16F:
+      return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case ImageFormat::BGRA8:
+      return VK_FORMAT_B8G8R8A8_UNORM;
   }
   return (VkFormat)0;
 }
 
+/**
+ * @brief Gets the component swizzle used to present a Weaver image format as RGBA.
+ * @param format The Weaver image format.
+ * @return The component mapping for the image view.
+ */
+static VkComponentMapping WeaverFormatToComponentMapping(ImageFormat format) {
+  switch (format) {
+    case ImageFormat::R8:
+      return {VK_COMPONENT_SWIZZLE_R,
+          VK_COMPONENT_SWIZZLE_R,
+          VK_COMPONENT_SWIZZLE_R,
+          VK_COMPONENT_SWIZZLE_ONE};
+    case ImageFormat::RG8:
+      return {VK_COMPONENT_SWIZZLE_R,
+          VK_COMPONENT_SWIZZLE_R,
+          VK_COMPONENT_SWIZZLE_R,
+          VK_COMPONENT_SWIZZLE_G};
+    default:
+      return {VK_COMPONENT_SWIZZLE_IDENTITY,
+          VK_COMPONENT_SWIZZLE_IDENTITY,
+          VK_COMPONENT_SWIZZLE_IDENTITY,
+          VK_COMPONENT_SWIZZLE_IDENTITY};
+  }
+}
+
+/**
+ * @enum RawLayout
+ * @brief The pixel layout of a file or decoder output relative to the GPU format it is loaded into.
+ */
+enum class RawLayout {
+  Native,     /**< Identical to the GPU format, copied as-is. */
+  RGB8,       /**< 8-bit RGB, expanded to RGBA. */
+  Gray8,      /**< 8-bit grayscale, replicated to RGBA. */
+  GrayAlpha8, /**< 8-bit grayscale + alpha, replicated to RGBA. */
+  RGB32F,     /**< 32-bit float RGB, expanded to RGBA. */
+  Gray32F     /**< 32-bit float grayscale, replicated to RGBA. */
+};
+
+/**
+ * @struct RawImage
+ * @brief Describes pixels that are copied, and expanded if needed, into GPU format rows.
+ * @details Points either into the mapping of an uncompressed file or into decoder output.
+ */
+struct RawImage {
+  uint32_t Width = 0, Height = 0;
+  ImageFormat Format = ImageFormat::None;
+  RawLayout Layout = RawLayout::Native;
+  const uint8_t* Pixels = nullptr;
+  size_t RowPitch = 0;
+  bool BottomUp = false; /**< Rows are stored bottom to top (PFM). */
+  bool ByteSwap = false; /**< Samples are big endian (PFM). */
+};
+
+/**
+ * @struct WeaverRawHeader
+ * @brief The header of the Weaver raw image format, stored little endian at the start of the file.
+ * @details The pixels are stored in the GPU format given by `Format` (an `ImageFormat` value) and
+ * are uploaded without any conversion.
+ */
+struct WeaverRawHeader {
+  char Magic[4];        /**< "WVR1". */
+  uint32_t Width;       /**< The width of the image in pixels. */
+  uint32_t Height;      /**< The height of the image in pixels. */
+  uint32_t Format;      /**< The `ImageFormat` of the pixels. */
+  uint32_t RowPitch;    /**< The size of a row in bytes, zero for tightly packed rows. */
+  uint32_t DataOffset;  /**< The offset of the first row from the start of the file. */
+  uint32_t Reserved[2]; /**< Reserved, must be zero. */
+};
+static_assert(sizeof(WeaverRawHeader) == 32, "The Weaver raw header must be 32 bytes");
+
+/**
+ * @brief Reads the next whitespace separated token of a Netpbm header, skipping comments.
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param offset The read offset, advanced past the token.
+ * @param token Receives the token.
+ * @return True if a token was read, false at the end of the file.
+ */
+static bool ReadHeaderToken(const uint8_t* data, size_t size, size_t& offset, std::string& token) {
+  while (offset < size) {
+    if (data[offset] == '#') {
+      while (offset < size && data[offset] != '\n')
+        offset++;
+    } else if (isspace(data[offset])) {
+      offset++;
+    } else {
+      break;
+    }
+  }
+
+  token.clear();
+  while (offset < size && !isspace(data[offset]) && token.size() < 64)
+    token.push_back((char)data[offset++]);
+  return !token.empty();
+}
+
+/**
+ * @brief Reads the next token of a Netpbm header as an unsigned integer.
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param offset The read offset, advanced past the token.
+ * @param value Receives the value.
+ * @return True if a positive integer was read, false otherwise.
+ */
+static bool ReadHeaderUInt(const uint8_t* data, size_t size, size_t& offset, uint32_t& value) {
+  std::string token;
+  if (!ReadHeaderToken(data, size, offset, token))
+    return false;
+  char* end = nullptr;
+  const unsigned long parsed = strtoul(token.c_str(), &end, 10);
+  if (*end != '\0' || parsed == 0 || parsed > 0xffffffu)
+    return false;
+  value = (uint32_t)parsed;
+  return true;
+}
+
+/**
+ * @brief Parses the header of a binary Netpbm file (P5, P6, P7 or PFM).
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param options The load options.
+ * @param out Receives the description of the pixels.
+ * @return True if the file can be copied without decoding, false otherwise.
+ */
+static bool ParseNetpbm(
+    const uint8_t* data, size_t size, const ImageLoadOptions& options, RawImage& out) {
+  size_t offset = 0;
+  std::string magic;
+  if (!ReadHeaderToken(data, size, offset, magic))
+    return false;
+
+  uint32_t channels = 0;
+  uint32_t max_value = 255;
+  bool is_float = false;
+  float scale = 0.0f;
+
+  if (magic == "P5" || magic == "P6") {
+    channels = magic == "P5" ? 1 : 3;
+    if (!ReadHeaderUInt(data, size, offset, out.Width) ||
+        !ReadHeaderUInt(data, size, offset, out.Height) ||
+        !ReadHeaderUInt(data, size, offset, max_value))
+      return false;
+  } else if (magic == "PF" || magic == "Pf") {
+    channels = magic == "PF" ? 3 : 1;
+    is_float = true;
+    std::string token;
+    if (!ReadHeaderUInt(data, size, offset, out.Width) ||
+        !ReadHeaderUInt(data, size, offset, out.Height) ||
+        !ReadHeaderToken(data, size, offset, token))
+      return false;
+    scale = strtof(token.c_str(), nullptr);
+    if (scale == 0.0f)
+      return false;
+  } else if (magic == "P7") {
+    std::string token, tuple_type;
+    while (ReadHeaderToken(data, size, offset, token) && token != "ENDHDR") {
+      if (token == "WIDTH" && !ReadHeaderUInt(data, size, offset, out.Width))
+        return false;
+      if (token == "HEIGHT" && !ReadHeaderUInt(data, size, offset, out.Height))
+        return false;
+      if (token == "DEPTH" && !ReadHeaderUInt(data, size, offset, channels))
+        return false;
+      if (token == "MAXVAL" && !ReadHeaderUInt(data, size, offset, max_value))
+        return false;
+      if (token == "TUPLTYPE" && !ReadHeaderToken(data, size, offset, tuple_type))
+        return false;
+    }
+    if (token != "ENDHDR" || channels == 0 || channels > 4)
+      return false;
+  } else {
+    return false;
+  }
+
+  // Exactly one whitespace character separates the header from the pixels.
+  if (out.Width == 0 || out.Height == 0 || offset >= size || !isspace(data[offset]))
+    return false;
+  offset++;
+
+  // 16-bit P5/P6 samples are left to the decoder, which converts them to 8 bits. The decoder
+  // cannot read PAM files, so those are rejected here.
+  if (!is_float && max_value != 255) {
+    if (magic == "P7")
+      WEAVER_LOG_ERROR("Unsupported PAM MAXVAL, only 255 is supported: ") << max_value;
+    return false;
+  }
+
+  if (is_float) {
+    out.Format = options.HDRToHalfFloat ? ImageFormat::RGBA16F : ImageFormat::RGBA32F;
+    out.Layout = channels == 3 ? RawLayout::RGB32F : RawLayout::Gray32F;
+    out.BottomUp = true;
+    // A positive scale marks big endian samples.
+    out.ByteSwap = scale > 0.0f;
+  } else if (channels <= 2 && options.PreserveChannelCount) {
+    out.Format = channels == 1 ? ImageFormat::R8 : ImageFormat::RG8;
+  } else if (channels <= 2) {
+    out.Format = ImageFormat::RGBA;
+    out.Layout = channels == 1 ? RawLayout::Gray8 : RawLayout::GrayAlpha8;
+  } else {
+    out.Format = ImageFormat::RGBA;
+    out.Layout = channels == 3 ? RawLayout::RGB8 : RawLayout::Native;
+  }
+
+  out.RowPitch = (size_t)out.Width * channels * (is_float ? 4 : 1);
+  if (size - offset < out.RowPitch * out.Height)
+    return false;
+  out.Pixels = data + offset;
+  return true;
+}
+
+/**
+ * @brief Parses the header of a Weaver raw image file.
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param out Receives the description of the pixels.
+ * @return True if the file is a valid Weaver raw image, false otherwise.
+ */
+static bool ParseWeaverRaw(const uint8_t* data, size_t size, RawImage& out) {
+  WeaverRawHeader header;
+  if (size < sizeof(header))
+    return false;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.Magic, "WVR1", 4) != 0)
+    return false;
+
+  out.Width = header.Width;
+  out.Height = header.Height;
+  out.Format = (ImageFormat)header.Format;
+  const size_t row_size = (size_t)header.Width * BytesPerPixel(out.Format);
+  out.RowPitch = header.RowPitch ? header.RowPitch : row_size;
+  if (row_size == 0 || header.Height == 0 || out.RowPitch < row_size ||
+      header.DataOffset < sizeof(header) || header.DataOffset > size ||
+      (size - header.DataOffset) / out.RowPitch < header.Height)
+    return false;
+
+  out.Layout = RawLayout::Native;
+  out.Pixels = data + header.DataOffset;
+  return true;
+}
+
+/**
+ * @brief Checks whether a file is an uncompressed format that can be copied without decoding.
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param options The load options.
+ * @param out Receives the description of the pixels.
+ * @return True if the file can be copied without decoding, false otherwise.
+ */
+static bool ParseRawImage(
+    const uint8_t* data, size_t size, const ImageLoadOptions& options, RawImage& out) {
+  if (size >= 4 && memcmp(data, "WVR1", 4) == 0)
+    return ParseWeaverRaw(data, size, out);
+  if (size >= 2 && data[0] == 'P')
+    return ParseNetpbm(data, size, options, out);
+  return false;
+}
+
+/**
+ * @brief Reads a 32-bit float sample from an unaligned, possibly big endian, location.
+ * @param source The location of the sample.
+ * @param byte_swap Whether the sample is big endian.
+ * @return The sample.
+ */
+static float ReadFloatSample(const uint8_t* source, bool byte_swap) {
+  uint8_t bytes[4] = {source[0], source[1], source[2], source[3]};
+  if (byte_swap) {
+    std::swap(bytes[0], bytes[3]);
+    std::swap(bytes[1], bytes[2]);
+  }
+  float value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Copies the pixels of an uncompressed file into tightly packed GPU format rows.
+ * @param raw The description of the pixels.
+ * @param destination The destination, `Width * Height * BytesPerPixel(Format)` bytes.
+ */
+static void CopyRawImage(const RawImage& raw, uint8_t* destination) {
+  const size_t row_size = (size_t)raw.Width * BytesPerPixel(raw.Format);
+  const bool to_half = raw.Format == ImageFormat::RGBA16F;
+  std::vector<float> float_row;
+  if (raw.Layout == RawLayout::RGB32F || raw.Layout == RawLayout::Gray32F)
+    float_row.resize((size_t)raw.Width * 4);
+
+  for (uint32_t y = 0; y < raw.Height; y++) {
+    const uint8_t* source = raw.Pixels + (raw.BottomUp ? raw.Height - 1 - y : y) * raw.RowPitch;
+    uint8_t* row = destination + y * row_size;
+
+    switch (raw.Layout) {
+      case RawLayout::Native:
+        memcpy(row, source, row_size);
+        break;
+      case RawLayout::RGB8:
+        PixelConversion::RGBToRGBA(source, row, raw.Width);
+        break;
+      case RawLayout::Gray8:
+      case RawLayout::GrayAlpha8: {
+        const uint32_t channels = raw.Layout == RawLayout::Gray8 ? 1 : 2;
+        for (uint32_t x = 0; x < raw.Width; x++, source += channels) {
+          row[x * 4 + 0] = row[x * 4 + 1] = row[x * 4 + 2] = source[0];
+          row[x * 4 + 3] = channels == 2 ? source[1] : 255;
+        }
+        break;
+      }
+      case RawLayout::RGB32F:
+      case RawLayout::Gray32F: {
+        // Expand into RGBA floats first, so the half conversion runs over a whole row at once.
+        float* pixel = to_half ? float_row.data() : (float*)row;
+        const uint32_t channels = raw.Layout == RawLayout::RGB32F ? 3 : 1;
+        for (uint32_t x = 0; x < raw.Width; x++, pixel += 4) {
+          for (uint32_t c = 0; c < 3; c++)
+            pixel[c] = ReadFloatSample(
+                source + (x * channels + (channels == 3 ? c : 0)) * 4, raw.ByteSwap);
+          pixel[3] = 1.0f;
+        }
+
+        if (to_half)
+          PixelConversion::FloatToHalf(float_row.data(), (uint16_t*)row, float_row.size());
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Decodes a compressed image file (PNG, JPEG, HDR, ...) held in memory.
+ * @details The pixels are decoded at their native channel count and described by `out`, so they
+ * are expanded to RGBA by `CopyRawImage` on their way into the destination.
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param options Controls the format chosen for the decoded pixels.
+ * @param out Receives the description of the decoded pixels.
+ * @param decoded Receives the storage of the decoded pixels, which `out` points into.
+ * @return True if the file was decoded, false otherwise.
+ */
+static bool DecodeCompressed(const uint8_t* data,
+    size_t size,
+    const ImageLoadOptions& options,
+    RawImage& out,
+    std::shared_ptr<const uint8_t>& decoded) {
+  if (size > (size_t)INT_MAX)
+    return false;
+
+  const int length = (int)size;
+  int width, height, channels;
+  uint8_t* pixels = nullptr;
+  size_t sample_size = 1;
+
+  if (stbi_is_hdr_from_memory(data, length)) {
+    pixels = (uint8_t*)stbi_loadf_from_memory(data, length, &width, &height, &channels, 3);
+    if (!pixels)
+      return false;
+
+    // Half precision is plenty for display and halves the memory and upload size.
+    out.Format = options.HDRToHalfFloat ? ImageFormat::RGBA16F : ImageFormat::RGBA32F;
+    out.Layout = RawLayout::RGB32F;
+    channels = 3;
+    sample_size = 4;
+  } else {
+    pixels = stbi_load_from_memory(data, length, &width, &height, &channels, 0);
+    if (!pixels)
+      return false;
+
+    // Keep grayscale (+ alpha) files at their native channel count, the image view swizzles them
+    // back to RGBA for sampling. Everything else is expanded to RGBA, as 3 channel formats are
+    // rarely supported for sampled images.
+    out.Format = ImageFormat::RGBA;
+    out.Layout = RawLayout::Native;
+    if (channels <= 2 && options.PreserveChannelCount)
+      out.Format = channels == 1 ? ImageFormat::R8 : ImageFormat::RG8;
+    else if (channels <= 2)
+      out.Layout = channels == 1 ? RawLayout::Gray8 : RawLayout::GrayAlpha8;
+    else if (channels == 3)
+      out.Layout = RawLayout::RGB8;
+  }
+
+  out.Width = width;
+  out.Height = height;
+  out.RowPitch = (size_t)width * channels * sample_size;
+  out.Pixels = pixels;
+  decoded = std::shared_ptr<const uint8_t>(pixels, [](const uint8_t* decoded_pixels) {
+    stbi_image_free((void*)decoded_pixels);
+  });
+  return true;
+}
+
+/**
+ * @brief Reads an image file held in memory, decoding it if it is compressed.
+ * @param data The file contents.
+ * @param size The size of the file.
+ * @param options Controls the format chosen for the pixels.
+ * @param out Receives the description of the pixels.
+ * @param decoded Receives the storage of decoded pixels, empty if `out` points into `data`.
+ * @return True if the file was read, false otherwise.
+ */
+static bool ReadImageFile(const uint8_t* data,
+    size_t size,
+    const ImageLoadOptions& options,
+    RawImage& out,
+    std::shared_ptr<const uint8_t>& decoded) {
+  if (ParseRawImage(data, size, options, out))
+    return true;
+  out = RawImage();
+  return DecodeCompressed(data, size, options, out, decoded);
+}
+
+/**
+ * @brief Checks whether the load options convert the color of pixels in a format.
+ * @param options The load options.
+ * @param format The GPU format of the pixels.
+ * @return True if `ConvertColor` has to be applied, false otherwise.
+ */
+static bool ConvertsColor(const ImageLoadOptions& options, ImageFormat format) {
+  return format == ImageFormat::RGBA && (options.PremultiplyAlpha || options.LinearizeSRGB);
+}
+
+/**
+ * @brief Copies 8-bit RGBA pixels, applying the alpha premultiplication and sRGB decoding options.
+ * @param raw The description of the pixels, in the `RGBA` format.
+ * @param options The load options.
+ * @return The converted pixel data.
+ */
+static ImageData ConvertColor(const RawImage& raw, const ImageLoadOptions& options) {
+  const size_t pixel_count = (size_t)raw.Width * raw.Height;
+  std::shared_ptr<uint8_t> rgba(new uint8_t[pixel_count * 4], std::default_delete<uint8_t[]>());
+  CopyRawImage(raw, rgba.get());
+
+  ImageData out;
+  out.Width = raw.Width;
+  out.Height = raw.Height;
+  out.Format = ImageFormat::RGBA;
+
+  if (!options.LinearizeSRGB) {
+    PixelConversion::PremultiplyAlpha(rgba.get(), rgba.get(), pixel_count);
+    out.Pixels = rgba;
+    return out;
+  }
+
+  std::shared_ptr<float> linear(new float[pixel_count * 4], std::default_delete<float[]>());
+  PixelConversion::SRGBToLinear(rgba.get(), linear.get(), pixel_count);
+
+  // Premultiply after decoding, so the color is scaled in linear space.
+  if (options.PremultiplyAlpha) {
+    float* pixel = linear.get();
+    for (size_t i = 0; i < pixel_count; i++, pixel += 4) {
+      pixel[0] *= pixel[3];
+      pixel[1] *= pixel[3];
+      pixel[2] *= pixel[3];
+    }
+  }
+
+  if (options.HDRToHalfFloat) {
+    std::shared_ptr<uint16_t> half_data(
+        new uint16_t[pixel_count * 4], std::default_delete<uint16_t[]>());
+    PixelConversion::FloatToHalf(linear.get(), half_data.get(), pixel_count * 4);
+    out.Format = ImageFormat::RGBA16F;
+    out.Pixels = std::shared_ptr<const uint8_t>(half_data, (const uint8_t*)half_data.get());
+  } else {
+    out.Format = ImageFormat::RGBA32F;
+    out.Pixels = std::shared_ptr<const uint8_t>(linear, (const uint8_t*)linear.get());
+  }
+  return out;
+}
+
 }  // namespace Utils
 
 /**
  * @brief Constructs an Image object from a file path.
  * @param path The path to the image file.
+ * @param options Controls the GPU format chosen for the decoded pixels.
  */
-Image::Image(std::string_view path) : m_Filepath(path) {
-  int width, height, channels;
-  uint8_t* data = nullptr;
+Image::Image(std::string_view path, const ImageLoadOptions& options)
+    : m_SamplerPreset(options.Sampler),
+      m_Filepath(path) {
+  MappedFile file(m_Filepath);
+  if (!file.IsOpen()) {
+    WEAVER_LOG_ERROR("Failed to open image: ") << m_Filepath;
+    return;
+  }
 
-  if (stbi_is_hdr(m_Filepath.c_str())) {
-    data = (uint8_t*)stbi_loadf(m_Filepath.c_str(), &width, &height, &channels, 4);
-    m_Format = ImageFormat::RGBA32F;
-  } else {
-    data = stbi_load(m_Filepath.c_str(), &width, &height, &channels, 4);
-    m_Format = ImageFormat::RGBA;
+  Utils::RawImage raw;
+  std::shared_ptr<const uint8_t> decoded;
+  if (!Utils::ReadImageFile(file.GetData(), file.GetSize(), options, raw, decoded)) {
+    WEAVER_LOG_ERROR("Failed to load image: ") << stbi_failure_reason();
+    return;
   }
-  if (!data) {
-    printf("Failed to load image: %s\n", stbi_failure_reason());
+
+  if (Utils::ConvertsColor(options, raw.Format)) {
+    const ImageData data = Utils::ConvertColor(raw, options);
+    m_Width = data.Width;
+    m_Height = data.Height;
+    m_Format = data.Format;
+
+    AllocateMemory((uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format));
+    SetData(data.Pixels.get());
     return;
   }
 
-  m_Width = width;
-  m_Height = height;
+  m_Width = raw.Width;
+  m_Height = raw.Height;
+  m_Format = raw.Format;
 
-  AllocateMemory(m_Width * m_Height * Utils::BytesPerPixel(m_Format));
-  SetData(data);
-  stbi_image_free(data);
+  // Uncompressed files skip decoding and are copied straight from the mapping into the staging
+  // buffer. Decoded pixels are expanded to RGBA on the same copy.
+  AllocateMemory((uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format));
+  WriteData([&raw](uint8_t* destination) { Utils::CopyRawImage(raw, destination); });
+}
+
+/**
+ * @brief Constructs an Image object from already decoded pixel data.
+ * @param data The decoded pixel data.
+ * @param sampler How the image is sampled when drawn.
+ */
+Image::Image(const ImageData& data, SamplerPreset sampler)
+    : m_Width(data.Width),
+      m_Height(data.Height),
+      m_SamplerPreset(sampler),
+      m_Format(data.Format) {
+  AllocateMemory((uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format));
+  if (data.Pixels)
+    SetData(data.Pixels.get());
+}
+
+/**
+ * @brief Decodes an image file into CPU memory without touching the GPU.
+ * @param path The path to the image file.
+ * @param options Controls the format chosen for the decoded pixels.
+ * @param out Receives the decoded pixel data.
+ * @return True if the file was decoded, false otherwise.
+ */
+bool Image::Decode(std::string_view path, const ImageLoadOptions& options, ImageData& out) {
+  auto file = std::make_shared<MappedFile>(std::string(path));
+  if (!file->IsOpen())
+    return false;
+
+  Utils::RawImage raw;
+  std::shared_ptr<const uint8_t> decoded;
+  if (!Utils::ReadImageFile(file->GetData(), file->GetSize(), options, raw, decoded))
+    return false;
+
+  if (Utils::ConvertsColor(options, raw.Format)) {
+    out = Utils::ConvertColor(raw, options);
+    return true;
+  }
+
+  out.Width = raw.Width;
+  out.Height = raw.Height;
+  out.Format = raw.Format;
+
+  const size_t row_size = (size_t)raw.Width * Utils::BytesPerPixel(raw.Format);
+  if (raw.Layout == Utils::RawLayout::Native && !raw.BottomUp && raw.RowPitch == row_size) {
+    if (decoded) {
+      out.Pixels = decoded;
+      return true;
+    }
+
+    // Zero copy: the pixels are read from the mapping, which the data keeps alive. Fault the pages
+    // in here so the upload on the main thread does not wait on the disk.
+    file->Prefetch();
+    out.Pixels = std::shared_ptr<const uint8_t>(file, raw.Pixels);
+    return true;
+  }
+
+  std::shared_ptr<uint8_t> pixels(
+      new uint8_t[row_size * raw.Height], std::default_delete<uint8_t[]>());
+  Utils::CopyRawImage(raw, pixels.get());
+  out.Pixels = pixels;
+  return true;
+}
+
+/**
+ * @brief Gets the number of bytes per pixel of an image format.
+ * @param format The image format.
+ * @return The number of bytes per pixel.
+ */
+uint32_t Image::GetBytesPerPixel(ImageFormat format) {
+  return Utils::BytesPerPixel(format);
 }
 
 /**
@@ -113,12 +689,15 @@ Image::Image(std::string_view path) : m_Filepath(path) {
  * @param height The height of the image.
  * @param format The format of the image.
  * @param data Optional initial data for the image.
+ * @param sampler How the image is sampled when drawn.
  */
-Image::Image(uint32_t width, uint32_t height, ImageFormat format, const void* data)
+Image::Image(
+    uint32_t width, uint32_t height, ImageFormat format, const void* data, SamplerPreset sampler)
     : m_Width(width),
       m_Height(height),
+      m_SamplerPreset(sampler),
       m_Format(format) {
-  AllocateMemory(m_Width * m_Height * Utils::BytesPerPixel(m_Format));
+  AllocateMemory((uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format));
   if (data)
     SetData(data);
 }
@@ -139,22 +718,37 @@ void Image::AllocateMemory(uint64_t size) {
 
   VkResult err;
 
+  // The image is created at its allocated extent, which can exceed the logical size after a resize.
+  m_AllocatedWidth = std::max(m_AllocatedWidth, m_Width);
+  m_AllocatedHeight = std::max(m_AllocatedHeight, m_Height);
+  m_HasContents = false;
+
   VkFormat vulkanFormat = Utils::WeaverFormatToVulkanFormat(m_Format);
 
+  // Formats the device can store to from shaders can be written by a ComputePass.
+  VkFormatProperties format_properties;
+  vkGetPhysicalDeviceFormatProperties(
+      Canvas::GetPhysicalDevice(), vulkanFormat, &format_properties);
+  const bool storage =
+      (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+
   // Create the Image
   {
     VkImageCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     info.imageType = VK_IMAGE_TYPE_2D;
     info.format = vulkanFormat;
-    info.extent.width = m_Width;
-    info.extent.height = m_Height;
+    info.extent.width = m_AllocatedWidth;
+    info.extent.height = m_AllocatedHeight;
     info.extent.depth = 1;
     info.mipLevels = 1;
     info.arrayLayers = 1;
     info.samples = VK_SAMPLE_COUNT_1_BIT;
     info.tiling = VK_IMAGE_TILING_OPTIMAL;
-    info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    if (storage)
+      info.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
     info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     err = vkCreateImage(device, &info, nullptr, &m_Image);
@@ -172,6 +766,7 @@ void Image::AllocateMemory(uint64_t size) {
 
     err = vkAllocateMemory(device, &alloc_info, nullptr, &m_Memory);
     check_vk_result(err);
+    m_MemorySize = req.size;
     err = vkBindImageMemory(device, m_Image, m_Memory, 0);
     check_vk_result(err);
   }
@@ -183,30 +778,25 @@ void Image::AllocateMemory(uint64_t size) {
     info.image = m_Image;
     info.viewType = VK_IMAGE_VIEW_TYPE_2D;
     info.format = vulkanFormat;
+    info.components = Utils::WeaverFormatToComponentMapping(m_Format);
     info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     info.subresourceRange.levelCount = 1;
     info.subresourceRange.layerCount = 1;
     err = vkCreateImageView(device, &info, nullptr, &m_ImageView);
     check_vk_result(err);
-  }
 
-  // Create sampler:
-  {
-    VkSamplerCreateInfo info = {};
-    info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    info.magFilter = VK_FILTER_LINEAR;
-    info.minFilter = VK_FILTER_LINEAR;
-    info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    info.minLod = -1000;
-    info.maxLod = 1000;
-    info.maxAnisotropy = 1.0f;
-    VkResult err = vkCreateSampler(device, &info, nullptr, &m_Sampler);
-    check_vk_result(err);
+    // Storage views must not swizzle, so compute shaders see the channels as they are stored.
+    if (storage) {
+      info.components = {};
+      err = vkCreateImageView(device, &info, nullptr, &m_StorageView);
+      check_vk_result(err);
+    }
   }
 
+  // Samplers are shared between images, see SamplerCache.
+  m_BoundSampler = GetEffectiveSampler();
+  m_Sampler = Canvas::Get().GetSamplerCache().GetSampler(m_BoundSampler);
+
   // Verification
   if (m_Sampler == VK_NULL_HANDLE || m_ImageView == VK_NULL_HANDLE) {
     throw std::runtime_error("Sampler or ImageView is invalid");
@@ -230,28 +820,74 @@ void Image::Release() {
     m_DescriptorSet = VK_NULL_HANDLE;
   }
 
-  Canvas::SubmitResourceFree([sampler = m_Sampler,
-                                 imageView = m_ImageView,
+  Canvas::SubmitResourceFree([imageView = m_ImageView,
+                                 storageView = m_StorageView,
                                  image = m_Image,
-                                 memory = m_Memory,
-                                 stagingBuffer = m_StagingBuffer,
-                                 stagingBufferMemory = m_StagingBufferMemory]() {
+                                 memory = m_Memory]() {
     VkDevice device = Canvas::GetDevice();
 
-    vkDestroySampler(device, sampler, nullptr);
     vkDestroyImageView(device, imageView, nullptr);
+    if (storageView != VK_NULL_HANDLE)
+      vkDestroyImageView(device, storageView, nullptr);
     vkDestroyImage(device, image, nullptr);
     vkFreeMemory(device, memory, nullptr);
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
   });
 
   m_Sampler = VK_NULL_HANDLE;
   m_ImageView = VK_NULL_HANDLE;
+  m_StorageView = VK_NULL_HANDLE;
   m_Image = VK_NULL_HANDLE;
   m_Memory = VK_NULL_HANDLE;
-  m_StagingBuffer = VK_NULL_HANDLE;
-  m_StagingBufferMemory = VK_NULL_HANDLE;
+  m_MemorySize = 0;
+}
+
+/**
+ * @brief Changes how the image is sampled when drawn.
+ * @param sampler The sampler preset.
+ */
+void Image::SetSampler(SamplerPreset sampler) {
+  m_SamplerPreset = sampler;
+  UpdateSampler();
+}
+
+/**
+ * @brief Gets the preset the image is sampled with: the chosen one, clamped while the image
+ * has unused capacity.
+ * @return The sampler preset.
+ */
+SamplerPreset Image::GetEffectiveSampler() const {
+  // Repeating would wrap the filter taps at the logical edges into the uninitialized capacity.
+  if (m_Width == m_AllocatedWidth && m_Height == m_AllocatedHeight)
+    return m_SamplerPreset;
+  switch (m_SamplerPreset) {
+    case SamplerPreset::Linear:
+      return SamplerPreset::LinearClamp;
+    case SamplerPreset::Nearest:
+      return SamplerPreset::NearestClamp;
+    default:
+      return m_SamplerPreset;
+  }
+}
+
+/**
+ * @brief Binds the effective sampler, replacing the descriptor set if it changed.
+ */
+void Image::UpdateSampler() {
+  if (m_ImageView == VK_NULL_HANDLE ||
+      (m_DescriptorSet != VK_NULL_HANDLE && m_BoundSampler == GetEffectiveSampler()))
+    return;
+
+  m_BoundSampler = GetEffectiveSampler();
+  m_Sampler = Canvas::Get().GetSamplerCache().GetSampler(m_BoundSampler);
+
+  // Frames in flight may still draw the old descriptor set, so it is freed later.
+  Canvas::SubmitResourceFree(
+      [descriptor_set = m_DescriptorSet]() { ImGui_ImplVulkan_RemoveTexture(descriptor_set); });
+  m_DescriptorSet =
+      ImGui_ImplVulkan_AddTexture(m_Sampler, m_ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  if (m_DescriptorSet == VK_NULL_HANDLE) {
+    throw std::runtime_error("Failed to create descriptor set with ImGui_ImplVulkan_AddTexture");
+  }
 }
 
 /**
@@ -259,122 +895,94 @@ void Image::Release() {
  * @param data A pointer to the image data.
  */
 void Image::SetData(const void* data) {
-  VkDevice device = Canvas::GetDevice();
+  const uint64_t upload_size = (uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format);
+  WriteData([data, upload_size](uint8_t* destination) { memcpy(destination, data, upload_size); });
+}
+
+/**
+ * @brief Sets the image data from pixels in a different format, converting them on upload.
+ * @param data A pointer to the source pixels.
+ * @param source_format The format of the source pixels.
+ */
+void Image::SetData(const void* data, ImageFormat source_format) {
+  if (source_format == m_Format) {
+    SetData(data);
+    return;
+  }
+
+  // The conversion writes straight into the staging memory, so no intermediate copy is made.
+  const size_t pixel_count = (size_t)m_Width * m_Height;
+  std::function<void(uint8_t*)> writer;
+  if ((source_format == ImageFormat::RGBA && m_Format == ImageFormat::BGRA8) ||
+      (source_format == ImageFormat::BGRA8 && m_Format == ImageFormat::RGBA)) {
+    writer = [data, pixel_count](uint8_t* destination) {
+      PixelConversion::SwizzleRB((const uint8_t*)data, destination, pixel_count);
+    };
+  } else if (source_format == ImageFormat::RGBA32F && m_Format == ImageFormat::RGBA16F) {
+    writer = [data, pixel_count](uint8_t* destination) {
+      PixelConversion::FloatToHalf((const float*)data, (uint16_t*)destination, pixel_count * 4);
+    };
+  } else if (source_format == ImageFormat::RGBA32F && m_Format == ImageFormat::RGBA) {
+    writer = [data, pixel_count](uint8_t* destination) {
+      PixelConversion::FloatToUnorm8((const float*)data, destination, pixel_count * 4);
+    };
+  } else {
+    throw std::runtime_error("Unsupported image format conversion");
+  }
+
+  WriteData(writer);
+}
+
+/**
+ * @brief Sets the image data by writing it directly into the mapped staging memory.
+ * @param writer Called with the mapped staging memory to fill.
+ */
+void Image::WriteData(const std::function<void(uint8_t* destination)>& writer) {
   if (m_Width == 0 || m_Height == 0) {
     m_Width = 200;
     m_Height = 200;
   }
 
-  size_t upload_size = m_Width * m_Height * Utils::BytesPerPixel(m_Format);
-
-  VkResult err;
+  // The copy is recorded with the other uploads of this frame, see UploadQueue.
+  const uint64_t upload_size = (uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format);
+  Canvas::Get().GetUploadQueue().UploadImage(
+      m_Image, m_Width, m_Height, m_AllocatedWidth, m_AllocatedHeight, upload_size, writer);
 
-  if (m_StagingBuffer == VK_NULL_HANDLE) {
-    // Create the Upload Buffer
-    {
-      VkBufferCreateInfo buffer_info = {};
-      buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-      buffer_info.size = upload_size;
-      buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-      buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-      err = vkCreateBuffer(device, &buffer_info, nullptr, &m_StagingBuffer);
-      check_vk_result(err);
-      VkMemoryRequirements req;
-      vkGetBufferMemoryRequirements(device, m_StagingBuffer, &req);
-      m_AlignedSize = req.size;
-      VkMemoryAllocateInfo alloc_info = {};
-      alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-      // alloc_info.allocationSize = req.size;
-      alloc_info.allocationSize = (req.size + req.alignment - 1) & ~(req.alignment - 1);
-      alloc_info.memoryTypeIndex =
-          Utils::GetVulkanMemoryType(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, req.memoryTypeBits);
-      err = vkAllocateMemory(device, &alloc_info, nullptr, &m_StagingBufferMemory);
-      check_vk_result(err);
-      err = vkBindBufferMemory(device, m_StagingBuffer, m_StagingBufferMemory, 0);
-      check_vk_result(err);
-    }
-  }
+  m_HasContents = true;
+  m_UploadFrame = Canvas::GetFrameCount();
+}
 
-  // Upload to Buffer
-  {
-    char* map = NULL;
-    err = vkMapMemory(device, m_StagingBufferMemory, 0, m_AlignedSize, 0, (void**)(&map));
-    check_vk_result(err);
-    memcpy(map, data, upload_size);
-    VkMappedMemoryRange range[1] = {};
-    range[0].sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-    range[0].memory = m_StagingBufferMemory;
-    range[0].size = m_AlignedSize;
-    err = vkFlushMappedMemoryRanges(device, 1, range);
-    check_vk_result(err);
-    vkUnmapMemory(device, m_StagingBufferMemory);
-  }
+/**
+ * @brief Sets the image data and returns an awaitable that resumes once the GPU has it.
+ * @param data A pointer to the image data.
+ * @return The awaitable.
+ */
+GpuFrameAwaiter Image::UploadAsync(const void* data) {
+  SetData(data);
+  return UploadAsync();
+}
 
-  // Copy to Image
-  {
-    VkCommandBuffer command_buffer = Canvas::GetCommandBuffer(true);
+/**
+ * @brief Reads a region of the image back to the CPU without waiting for the GPU.
+ * @param region The region to read.
+ * @param format The format of the returned pixels.
+ * @return A future that receives the tightly packed pixels.
+ */
+std::future<ImageData> Image::ReadbackAsync(const ImageRegion& region, ImageFormat format) const {
+  if (!m_HasContents)
+    throw std::runtime_error("Image has no contents to read back");
 
-    if (command_buffer == VK_NULL_HANDLE) {
-      throw std::runtime_error("Failed to allocate command buffer!");
-      // MessageBox(nullptr, TEXT("Failed to allocate command buffer!!!"), TEXT("Message"), MB_OK);
-    }
+  ImageRegion clamped = region;
+  if (clamped.Width == 0 && clamped.X < m_Width)
+    clamped.Width = m_Width - clamped.X;
+  if (clamped.Height == 0 && clamped.Y < m_Height)
+    clamped.Height = m_Height - clamped.Y;
+  if (clamped.Width == 0 || clamped.Height == 0 || clamped.X + clamped.Width > m_Width ||
+      clamped.Y + clamped.Height > m_Height)
+    throw std::runtime_error("Readback region lies outside the image");
 
-    VkImageMemoryBarrier copy_barrier = {};
-    copy_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    copy_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    copy_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    copy_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    copy_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    copy_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    copy_barrier.image = m_Image;
-    copy_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    copy_barrier.subresourceRange.levelCount = 1;
-    copy_barrier.subresourceRange.layerCount = 1;
-    vkCmdPipelineBarrier(command_buffer,
-        VK_PIPELINE_STAGE_HOST_BIT,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        0,
-        0,
-        NULL,
-        0,
-        NULL,
-        1,
-        &copy_barrier);
-
-    VkBufferImageCopy region = {};
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.layerCount = 1;
-    region.imageExtent.width = m_Width;
-    region.imageExtent.height = m_Height;
-    region.imageExtent.depth = 1;
-    vkCmdCopyBufferToImage(
-        command_buffer, m_StagingBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    VkImageMemoryBarrier use_barrier = {};
-    use_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    use_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    use_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    use_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    use_barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    use_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    use_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    use_barrier.image = m_Image;
-    use_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    use_barrier.subresourceRange.levelCount = 1;
-    use_barrier.subresourceRange.layerCount = 1;
-    vkCmdPipelineBarrier(command_buffer,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        0,
-        0,
-        NULL,
-        0,
-        NULL,
-        1,
-        &use_barrier);
-
-    Canvas::FlushCommandBuffer(command_buffer);
-  }
+  return Canvas::Get().GetReadbackQueue().Submit(
+      m_Image, m_Format, clamped, format == ImageFormat::None ? m_Format : format);
 }
 
 /**
@@ -395,8 +1003,37 @@ void Image::Resize(uint32_t width, uint32_t height) {
   m_Width = width;
   m_Height = height;
 
+  // Within the allocated extent only the logical size changes, and with it whether the image
+  // has unused capacity to keep the filtering away from.
+  if (m_Image && width <= m_AllocatedWidth && height <= m_AllocatedHeight) {
+    UpdateSampler();
+    return;
+  }
+
+  // Grow the exceeded dimensions by at least half, so a steadily growing image reallocates
+  // a logarithmic number of times.
+  if (m_Image) {
+    if (width > m_AllocatedWidth)
+      m_AllocatedWidth = std::max(width, m_AllocatedWidth + m_AllocatedWidth / 2);
+    if (height > m_AllocatedHeight)
+      m_AllocatedHeight = std::max(height, m_AllocatedHeight + m_AllocatedHeight / 2);
+  }
+
+  Release();
+  AllocateMemory((uint64_t)m_AllocatedWidth * m_AllocatedHeight * Utils::BytesPerPixel(m_Format));
+}
+
+/**
+ * @brief Reallocates the image at exactly its logical size, releasing any unused capacity.
+ */
+void Image::ShrinkToFit() {
+  if (!m_Image || (m_AllocatedWidth == m_Width && m_AllocatedHeight == m_Height))
+    return;
+
   Release();
-  AllocateMemory(m_Width * m_Height * Utils::BytesPerPixel(m_Format));
+  m_AllocatedWidth = m_Width;
+  m_AllocatedHeight = m_Height;
+  AllocateMemory((uint64_t)m_Width * m_Height * Utils::BytesPerPixel(m_Format));
 }
 
 }  // namespace Weaver
@@ -17,15 +17,69 @@
 
 #include <vulkan/vulkan.h>
 
+#include <functional>
+#include <future>
+#include <glm/glm.hpp>
+#include <memory>
 #include <string>
 
+#include "Coroutine.h"
+#include "SamplerCache.h"
+
 namespace Weaver {
 
 /**
  * @enum ImageFormat
  * @brief Specifies the format of the image data.
+ * @details Single and dual channel formats are sampled through a swizzled view so the UI always
+ * sees RGBA: `R8` reads as (R, R, R, 1) and `RG8` as luminance-alpha (R, R, R, G).
+ */
+enum class ImageFormat {
+  None = 0, /**< No format specified. */
+  RGBA,     /**< 8-bit RGBA format. */
+  RGBA32F,  /**< 32-bit floating point RGBA format. */
+  R8,       /**< 8-bit single channel (grayscale) format. */
+  RG8,      /**< 8-bit dual channel (grayscale + alpha) format. */
+  RGBA16F,  /**< 16-bit (half) floating point RGBA format. */
+  BGRA8     /**< 8-bit BGRA format. */
+};
+
+/**
+ * @struct ImageLoadOptions
+ * @brief Controls how image files are decoded into GPU formats.
+ */
+struct ImageLoadOptions {
+  bool HDRToHalfFloat = true;       /**< Store HDR files as `RGBA16F` instead of `RGBA32F`. */
+  bool PreserveChannelCount = true; /**< Keep grayscale files as `R8` / `RG8` instead of `RGBA`. */
+  bool PremultiplyAlpha = false;    /**< Multiply the color of `RGBA` images by their alpha. */
+  /** Decode `RGBA` images from sRGB to linear `RGBA16F` / `RGBA32F`, see `HDRToHalfFloat`. */
+  bool LinearizeSRGB = false;
+  SamplerPreset Sampler = SamplerPreset::Linear; /**< How the image is sampled when drawn. */
+};
+
+/**
+ * @struct ImageData
+ * @brief Decoded, CPU-side pixel data ready to be uploaded into an `Image`.
+ * @details The pixels are tightly packed rows of `Format`. The storage is shared so decoded data
+ * can be handed between threads without copying.
+ */
+struct ImageData {
+  uint32_t Width = 0;                    /**< The width of the image in pixels. */
+  uint32_t Height = 0;                   /**< The height of the image in pixels. */
+  ImageFormat Format = ImageFormat::None; /**< The format of the pixels. */
+  std::shared_ptr<const uint8_t> Pixels; /**< The decoded pixels. */
+};
+
+/**
+ * @struct ImageRegion
+ * @brief A rectangle of pixels within an image.
  */
-enum class ImageFormat { None = 0, /**< No format specified. */ RGBA, /**< 8-bit RGBA format. */ RGBA32F /**< 32-bit floating point RGBA format. */ };
+struct ImageRegion {
+  uint32_t X = 0;      /**< The left edge of the region. */
+  uint32_t Y = 0;      /**< The top edge of the region. */
+  uint32_t Width = 0;  /**< The width of the region, zero extends it to the right edge. */
+  uint32_t Height = 0; /**< The height of the region, zero extends it to the bottom edge. */
+};
 
 /**
  * @class Image
@@ -36,27 +90,109 @@ class Image {
   /**
    * @brief Constructs an Image object from a file path.
    * @param path The path to the image file.
+   * @param options Controls the GPU format chosen for the decoded pixels.
    */
-  Image(std::string_view path);
+  Image(std::string_view path, const ImageLoadOptions& options = ImageLoadOptions());
+  /**
+   * @brief Constructs an Image object from already decoded pixel data.
+   * @param data The decoded pixel data.
+   * @param sampler How the image is sampled when drawn.
+   */
+  explicit Image(const ImageData& data, SamplerPreset sampler = SamplerPreset::Linear);
   /**
    * @brief Constructs an Image object with a specified width, height, and format.
    * @param width The width of the image.
    * @param height The height of the image.
    * @param format The format of the image.
    * @param data Optional initial data for the image.
+   * @param sampler How the image is sampled when drawn.
    */
-  Image(uint32_t width, uint32_t height, ImageFormat format, const void* data = nullptr);
+  Image(uint32_t width,
+      uint32_t height,
+      ImageFormat format,
+      const void* data = nullptr,
+      SamplerPreset sampler = SamplerPreset::Linear);
   /**
    * @brief Destroys the Image object and releases its resources.
    */
   ~Image();
 
+  /**
+   * @brief Decodes an image file into CPU memory without touching the GPU.
+   * @details This is safe to call from any thread.
+   * @param path The path to the image file.
+   * @param options Controls the format chosen for the decoded pixels.
+   * @param out Receives the decoded pixel data.
+   * @return True if the file was decoded, false otherwise.
+   */
+  static bool Decode(std::string_view path, const ImageLoadOptions& options, ImageData& out);
+
+  /**
+   * @brief Gets the number of bytes per pixel of an image format.
+   * @param format The image format.
+   * @return The number of bytes per pixel, zero for `ImageFormat::None`.
+   */
+  static uint32_t GetBytesPerPixel(ImageFormat format);
+
   /**
    * @brief Sets the image data.
+   * @details The pixels are copied into staging memory before this returns. The copy into the
+   * image is recorded into the current frame together with every other upload (see
+   * `UploadQueue`), and a second write in the same frame replaces the first. Safe to call from
+   * a layer updating on a worker thread (see `LayerUpdateTraits`), as long as no other thread
+   * uses the image meanwhile.
    * @param data A pointer to the image data.
    */
   void SetData(const void* data);
 
+  /**
+   * @brief Sets the image data from pixels in a different format, converting them on upload.
+   * @details Supports RGBA <-> BGRA8 and RGBA32F -> RGBA / RGBA16F. Any other pair
+   * throws a `std::runtime_error`.
+   * @param data A pointer to the source pixels, `GetWidth() * GetHeight()` tightly packed.
+   * @param source_format The format of the source pixels.
+   */
+  void SetData(const void* data, ImageFormat source_format);
+
+  /**
+   * @brief Sets the image data by writing it directly into the mapped staging memory.
+   * @details Avoids an intermediate copy when the pixels are produced or converted on the fly.
+   * @param writer Called with the staging memory, which must be filled with
+   * `GetWidth() * GetHeight()` tightly packed pixels of the image format.
+   */
+  void WriteData(const std::function<void(uint8_t* destination)>& writer);
+
+  /**
+   * @brief Sets the image data and returns an awaitable that resumes once the GPU has it.
+   * @details Call from a coroutine on the main thread, see `Coroutine.h`:
+   * `co_await image.UploadAsync(pixels);`. The pixels are copied before this returns.
+   * @param data A pointer to the image data.
+   * @return The awaitable.
+   */
+  GpuFrameAwaiter UploadAsync(const void* data);
+  /**
+   * @brief Returns an awaitable that resumes once the GPU has the data of the last `SetData`.
+   * @return The awaitable.
+   */
+  GpuFrameAwaiter UploadAsync() const {
+    return WaitForGpuFrame(m_UploadFrame);
+  }
+
+  /**
+   * @brief Reads a region of the image back to the CPU without waiting for the GPU.
+   * @details The copy is submitted after the current frame, so it sees this frame's uploads and
+   * compute work, and the future is fulfilled on a worker thread a frame or more later, after the
+   * pixels have been converted to `format`. Never wait on the future from the main thread, the
+   * readback only completes while frames are rendered.
+   * Throws a `std::runtime_error` if the image has no contents, the region lies outside the
+   * image, or the conversion is not supported (see `ReadbackQueue::IsConversionSupported`).
+   * @param region The region to read, the whole image by default.
+   * @param format The format of the returned pixels, `ImageFormat::None` keeps the image format.
+   * @return A future that receives the tightly packed pixels.
+   */
+  std::future<ImageData> ReadbackAsync(
+      const ImageRegion& region = ImageRegion(), ImageFormat format = ImageFormat::None) const;
+
   /**
    * @brief Gets the Vulkan descriptor set for the image.
    * @return The Vulkan descriptor set.
@@ -67,11 +203,38 @@ class Image {
 
   /**
    * @brief Resizes the image.
+   * @details Sizes within the allocated extent only change the logical size, so an image that
+   * follows a window being dragged does not reallocate on every event. Growing past the
+   * allocated extent reallocates with geometric growth. The contents are undefined after a
+   * resize until the next upload. Draw the image with the UV rect `(0, 0)` to `GetUVMax()`.
+   * While the allocation is larger than the image, repeating presets are sampled clamped, so
+   * filtering never reads the unused capacity.
    * @param width The new width of the image.
    * @param height The new height of the image.
    */
   void Resize(uint32_t width, uint32_t height);
 
+  /**
+   * @brief Reallocates the image at exactly its logical size, releasing any unused capacity.
+   * @details The contents are undefined until the next upload.
+   */
+  void ShrinkToFit();
+
+  /**
+   * @brief Changes how the image is sampled when drawn.
+   * @details Creates a new descriptor set, so fetch it again with `GetDescriptorSet`. A
+   * repeating preset is sampled clamped while the image has unused capacity, see `Resize`.
+   * @param sampler The sampler preset.
+   */
+  void SetSampler(SamplerPreset sampler);
+  /**
+   * @brief Gets how the image is sampled when drawn.
+   * @return The sampler preset.
+   */
+  SamplerPreset GetSampler() const {
+    return m_SamplerPreset;
+  }
+
   /**
    * @brief Gets the width of the image.
    * @return The width of the image.
@@ -86,8 +249,86 @@ class Image {
   uint32_t GetHeight() const {
     return m_Height;
   }
+  /**
+   * @brief Gets the allocated width of the image, which is at least its width.
+   * @return The allocated width of the image.
+   */
+  uint32_t GetAllocatedWidth() const {
+    return m_AllocatedWidth;
+  }
+  /**
+   * @brief Gets the allocated height of the image, which is at least its height.
+   * @return The allocated height of the image.
+   */
+  uint32_t GetAllocatedHeight() const {
+    return m_AllocatedHeight;
+  }
+  /**
+   * @brief Gets the bottom right texture coordinate of the logical image within the allocation.
+   * @details Uploads replicate the last column and row into the unused capacity, so bilinear
+   * filtering at the edges never blends in uninitialized texels.
+   * @return The maximum UV coordinate, `(1, 1)` when the image is allocated at its exact size.
+   */
+  glm::vec2 GetUVMax() const {
+    if (m_AllocatedWidth == 0 || m_AllocatedHeight == 0)
+      return glm::vec2(1.0f);
+    return glm::vec2((float)m_Width / m_AllocatedWidth, (float)m_Height / m_AllocatedHeight);
+  }
+  /**
+   * @brief Gets the format of the image.
+   * @return The format of the image.
+   */
+  ImageFormat GetFormat() const {
+    return m_Format;
+  }
+  /**
+   * @brief Gets the Vulkan image handle, e.g. to record transfers into the image.
+   * @details The image is kept in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL` between uploads.
+   * @return The Vulkan image.
+   */
+  VkImage GetVulkanImage() const {
+    return m_Image;
+  }
+  /**
+   * @brief Gets the Vulkan image view used to sample the image.
+   * @return The Vulkan image view.
+   */
+  VkImageView GetImageView() const {
+    return m_ImageView;
+  }
+  /**
+   * @brief Gets the Vulkan image view used to write the image from compute shaders.
+   * @details Unlike `GetImageView`, the view does not swizzle single and dual channel formats.
+   * @return The Vulkan image view, or `VK_NULL_HANDLE` if the device cannot store the format.
+   */
+  VkImageView GetStorageView() const {
+    return m_StorageView;
+  }
+  /**
+   * @brief Gets the Vulkan sampler the image is drawn with.
+   * @return The Vulkan sampler, shared through the `SamplerCache`.
+   */
+  VkSampler GetVulkanSampler() const {
+    return m_Sampler;
+  }
+  /**
+   * @brief Checks if the image holds defined contents, i.e. was written since it was allocated.
+   * @return True if the image has contents.
+   */
+  bool HasContents() const {
+    return m_HasContents;
+  }
+  /**
+   * @brief Gets the size of the device memory backing the image.
+   * @return The size of the device memory in bytes.
+   */
+  uint64_t GetMemorySize() const {
+    return m_MemorySize;
+  }
 
  private:
+  friend class ComputePass;
+
   /**
    * @brief Allocates memory for the image.
    * @param size The size of the memory to allocate.
@@ -97,9 +338,20 @@ class Image {
    * @brief Releases all resources used by the image.
    */
   void Release();
+  /**
+   * @brief Gets the preset the image is sampled with: the chosen one, clamped while the image
+   * has unused capacity.
+   * @return The sampler preset.
+   */
+  SamplerPreset GetEffectiveSampler() const;
+  /**
+   * @brief Binds the effective sampler, replacing the descriptor set if it changed.
+   */
+  void UpdateSampler();
 
  private:
   uint32_t m_Width = 0, m_Height = 0;
+  uint32_t m_AllocatedWidth = 0, m_AllocatedHeight = 0;
 
   //   VkImage m_Image = nullptr;
   //   VkImageView m_ImageView = nullptr;
@@ -109,17 +361,20 @@ class Image {
   //   VkDeviceMemory m_StagingBufferMemory = nullptr;
   VkImage m_Image = VK_NULL_HANDLE;
   VkImageView m_ImageView = VK_NULL_HANDLE;
+  VkImageView m_StorageView = VK_NULL_HANDLE;
   VkDeviceMemory m_Memory = VK_NULL_HANDLE;
-  VkSampler m_Sampler = VK_NULL_HANDLE;
-  VkBuffer m_StagingBuffer = VK_NULL_HANDLE;
-  VkDeviceMemory m_StagingBufferMemory = VK_NULL_HANDLE;
+  uint64_t m_MemorySize = 0;
+  VkSampler m_Sampler = VK_NULL_HANDLE; /**< Shared through the `SamplerCache`, not owned. */
+  SamplerPreset m_SamplerPreset = SamplerPreset::Linear;
+  SamplerPreset m_BoundSampler = SamplerPreset::Linear; /**< The preset of `m_Sampler`. */
 
   ImageFormat m_Format = ImageFormat::None;
 
-  size_t m_AlignedSize = 0;
-
   VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
 
+  bool m_HasContents = false; /**< Set once data was uploaded since the last allocation. */
+  uint64_t m_UploadFrame = 0; /**< The frame that records the last upload. */
+
   std::string m_Filepath;
 };
 
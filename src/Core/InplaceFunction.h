@@ -0,0 +1,136 @@
+/**
+ * @file InplaceFunction.h
+ * @author B.G. Smit
+ * @brief Declares a move-only callable wrapper that never allocates.
+ *
+ * This file defines the `InplaceFunction` class template. Unlike `std::function` it stores the
+ * callable in a fixed buffer inside the object, so wrapping a lambda never touches the heap;
+ * callables larger than the buffer are rejected at compile time. Capture a pointer or a
+ * `std::shared_ptr` to pass larger state. Used for the tasks posted to the main thread.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Weaver {
+
+template <typename Signature, size_t Capacity = 64>
+class InplaceFunction;
+
+/**
+ * @class InplaceFunction
+ * @brief A move-only `std::function` with a fixed inline buffer.
+ * @tparam R The return type.
+ * @tparam Args The argument types.
+ * @tparam Capacity The size of the buffer in bytes.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+ public:
+  InplaceFunction() = default;
+
+  /**
+   * @brief Wraps a callable.
+   * @param func The callable. Must fit into `Capacity` bytes.
+   */
+  template <typename Func,
+      typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, InplaceFunction>>>
+  InplaceFunction(Func&& func) {
+    using Stored = std::decay_t<Func>;
+    static_assert(sizeof(Stored) <= Capacity,
+        "The callable does not fit into the InplaceFunction, capture less or use a pointer");
+    static_assert(alignof(Stored) <= alignof(std::max_align_t), "The callable is over-aligned");
+    static_assert(std::is_nothrow_move_constructible_v<Stored>,
+        "The callable must be nothrow move constructible");
+    new (m_Storage) Stored(std::forward<Func>(func));
+    m_VTable = &kVTable<Stored>;
+  }
+
+  InplaceFunction(InplaceFunction&& other) noexcept {
+    MoveFrom(other);
+  }
+  InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+  InplaceFunction(const InplaceFunction&) = delete;
+  InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+  ~InplaceFunction() {
+    Reset();
+  }
+
+  /**
+   * @brief Calls the wrapped callable. Must not be empty.
+   * @param args The arguments.
+   * @return The result of the callable.
+   */
+  R operator()(Args... args) {
+    return m_VTable->Invoke(m_Storage, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Checks if a callable is wrapped.
+   * @return True if not empty.
+   */
+  explicit operator bool() const {
+    return m_VTable != nullptr;
+  }
+
+  /**
+   * @brief Destroys the wrapped callable, leaving the function empty.
+   */
+  void Reset() {
+    if (m_VTable) {
+      m_VTable->Destroy(m_Storage);
+      m_VTable = nullptr;
+    }
+  }
+
+ private:
+  /**
+   * @struct VTable
+   * @brief The operations on the stored callable type.
+   */
+  struct VTable {
+    R (*Invoke)(void* storage, Args&&... args);
+    void (*Move)(void* destination, void* source);
+    void (*Destroy)(void* storage);
+  };
+
+  template <typename Stored>
+  static constexpr VTable kVTable = {
+      [](void* storage, Args&&... args) -> R {
+        return (*static_cast<Stored*>(storage))(std::forward<Args>(args)...);
+      },
+      [](void* destination, void* source) {
+        new (destination) Stored(std::move(*static_cast<Stored*>(source)));
+        static_cast<Stored*>(source)->~Stored();
+      },
+      [](void* storage) { static_cast<Stored*>(storage)->~Stored(); }};
+
+  void MoveFrom(InplaceFunction& other) {
+    if (other.m_VTable) {
+      other.m_VTable->Move(m_Storage, other.m_Storage);
+      m_VTable = std::exchange(other.m_VTable, nullptr);
+    }
+  }
+
+ private:
+  alignas(std::max_align_t) unsigned char m_Storage[Capacity];
+  const VTable* m_VTable = nullptr;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,390 @@
+/**
+ * @file JobSystem.cpp
+ * @author B.G. Smit
+ * @brief Implements the work-stealing job system shared by the Core and the layers.
+ * @copyright Copyright (c) 2025
+ */
+#include "JobSystem.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "Profiler.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+static JobSystem* s_Instance = nullptr;
+
+/**
+ * @brief The job system and deque index of the calling worker thread.
+ */
+static thread_local JobSystem* t_System = nullptr;
+static thread_local uint32_t t_WorkerIndex = 0;
+
+/**
+ * @brief Varies the first victim between steal attempts so thieves spread across the workers.
+ */
+static thread_local uint32_t t_StealSeed = 0;
+
+}  // namespace Utils
+
+namespace Detail {
+
+/**
+ * @brief Constructs a new WorkStealingDeque.
+ * @param capacity The maximum number of queued jobs, a power of two.
+ */
+WorkStealingDeque::WorkStealingDeque(size_t capacity)
+    : m_Buffer(capacity), m_Mask((int64_t)capacity - 1) {}
+
+/**
+ * @brief Pushes a job at the bottom. Owning thread only.
+ * @param job The job.
+ * @return False if the deque is full.
+ */
+bool WorkStealingDeque::Push(JobState* job) {
+  const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+  const int64_t top = m_Top.load(std::memory_order_acquire);
+  if (bottom - top > m_Mask)
+    return false;
+
+  m_Buffer[bottom & m_Mask].store(job, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+  return true;
+}
+
+/**
+ * @brief Pops the most recently pushed job. Owning thread only.
+ * @return The job, or null if the deque is empty.
+ */
+JobState* WorkStealingDeque::Pop() {
+  const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+  m_Bottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = m_Top.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  JobState* job = m_Buffer[bottom & m_Mask].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // The last job, race the thieves for it.
+    if (!m_Top.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      job = nullptr;
+    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+/**
+ * @brief Steals the oldest job. Safe on any thread.
+ * @return The job, or null if the deque is empty or another thread won the race.
+ */
+JobState* WorkStealingDeque::Steal() {
+  int64_t top = m_Top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr;
+
+  JobState* job = m_Buffer[top & m_Mask].load(std::memory_order_relaxed);
+  if (!m_Top.compare_exchange_strong(
+          top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return nullptr;
+  return job;
+}
+
+}  // namespace Detail
+
+/**
+ * @brief Constructs a new JobSystem and starts its workers.
+ * @param worker_count The number of worker threads, zero for automatic sizing.
+ */
+JobSystem::JobSystem(uint32_t worker_count) {
+  if (worker_count == 0) {
+    const uint32_t hardware = std::thread::hardware_concurrency();
+    worker_count = std::max(1u, hardware > 1 ? hardware - 1 : 1u);
+  }
+
+  m_Deques.reserve(worker_count);
+  for (uint32_t i = 0; i < worker_count; i++)
+    m_Deques.push_back(std::make_unique<Detail::WorkStealingDeque>(kDequeCapacity));
+  m_Workers.reserve(worker_count);
+  for (uint32_t i = 0; i < worker_count; i++)
+    m_Workers.emplace_back([this, i]() { WorkerLoop(i); });
+
+  Utils::s_Instance = this;
+}
+
+/**
+ * @brief Destroys the JobSystem, running the queued jobs and joining the workers.
+ */
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(m_SleepMutex);
+    m_Stopping = true;
+  }
+  m_WakeUp.notify_all();
+
+  for (auto& worker : m_Workers)
+    worker.join();
+
+  if (Utils::s_Instance == this)
+    Utils::s_Instance = nullptr;
+}
+
+/**
+ * @brief Gets the job system started by `Weaver::Main`.
+ * @return A reference to the job system.
+ */
+JobSystem& JobSystem::Get() {
+  if (!Utils::s_Instance)
+    throw std::runtime_error("The job system has not been started!");
+  return *Utils::s_Instance;
+}
+
+/**
+ * @brief Schedules a job.
+ * @param func The function to run on a worker.
+ * @return The handle of the job.
+ */
+JobHandle JobSystem::Schedule(std::function<void()> func) {
+  auto job = std::make_shared<Detail::JobState>();
+  job->Func = std::move(func);
+  JobHandle handle(job);
+  Enqueue(std::move(job));
+  return handle;
+}
+
+/**
+ * @brief Schedules a job to run once other jobs have finished.
+ * @param func The function to run on a worker.
+ * @param dependencies The jobs to wait for.
+ * @return The handle of the job.
+ */
+JobHandle JobSystem::Schedule(
+    std::function<void()> func, const std::vector<JobHandle>& dependencies) {
+  auto job = std::make_shared<Detail::JobState>();
+  job->Func = std::move(func);
+  // Held while registering, so a dependency that finishes meanwhile cannot enqueue the job.
+  job->Dependencies.store(1, std::memory_order_relaxed);
+
+  for (const JobHandle& dependency : dependencies) {
+    if (!dependency.m_State)
+      continue;
+    std::lock_guard<std::mutex> lock(dependency.m_State->Mutex);
+    if (!dependency.m_State->Done.load(std::memory_order_relaxed)) {
+      job->Dependencies.fetch_add(1, std::memory_order_relaxed);
+      dependency.m_State->Continuations.push_back(job);
+    }
+  }
+
+  JobHandle handle(job);
+  if (job->Dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    Enqueue(std::move(job));
+  return handle;
+}
+
+/**
+ * @brief Waits for a job, executing other jobs in the meantime.
+ * @param job The job.
+ */
+void JobSystem::Wait(const JobHandle& job) {
+  if (!job.m_State)
+    return;
+
+  while (!job.IsDone()) {
+    if (Detail::JobState* other = TryTake())
+      Execute(other);
+    else
+      std::this_thread::yield();
+  }
+  if (job.m_State->Error)
+    std::rethrow_exception(job.m_State->Error);
+}
+
+/**
+ * @brief Runs `func` over the chunks of a range and returns once all have finished.
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param grain The number of indices per chunk, zero for automatic.
+ * @param func Called with the first and one past the last index of a chunk.
+ */
+void JobSystem::ParallelForChunks(
+    size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& func) {
+  if (end <= begin)
+    return;
+  grain = GetGrain(end - begin, grain);
+  const size_t chunk_count = (end - begin + grain - 1) / grain;
+  if (chunk_count == 1) {
+    func(begin, end);
+    return;
+  }
+
+  // Every participant takes the next chunk until none are left, which balances uneven chunks
+  // without a job per chunk.
+  std::atomic<size_t> next_chunk{0};
+  auto run = [&]() {
+    for (size_t chunk = next_chunk.fetch_add(1); chunk < chunk_count;
+         chunk = next_chunk.fetch_add(1)) {
+      const size_t chunk_begin = begin + chunk * grain;
+      func(chunk_begin, std::min(end, chunk_begin + grain));
+    }
+  };
+
+  const size_t helper_count = std::min<size_t>(chunk_count, GetThreadCount()) - 1;
+  std::vector<JobHandle> helpers;
+  helpers.reserve(helper_count);
+  for (size_t i = 0; i < helper_count; i++)
+    helpers.push_back(Schedule(run));
+
+  std::exception_ptr error;
+  try {
+    run();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // The chunks reference this frame, so every helper is waited for before rethrowing.
+  for (const JobHandle& helper : helpers) {
+    try {
+      Wait(helper);
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+/**
+ * @brief Picks the chunk size of a parallel loop.
+ * @param count The number of indices.
+ * @param grain The requested chunk size, zero for automatic.
+ * @return The chunk size.
+ */
+size_t JobSystem::GetGrain(size_t count, size_t grain) const {
+  if (grain > 0)
+    return grain;
+  // A few chunks per thread leave room to balance, without paying for many tiny ones.
+  return std::max<size_t>(1, count / ((size_t)GetThreadCount() * 8));
+}
+
+/**
+ * @brief Queues a job whose dependencies have finished.
+ * @param job The job.
+ */
+void JobSystem::Enqueue(std::shared_ptr<Detail::JobState> job) {
+  Detail::JobState* raw = job.get();
+  raw->Self = std::move(job);
+
+  // Counted first, so a worker that sees the job also sees the count.
+  m_QueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+  if (Utils::t_System != this || !m_Deques[Utils::t_WorkerIndex]->Push(raw)) {
+    std::lock_guard<std::mutex> lock(m_InjectionMutex);
+    m_Injection.push_back(raw);
+  }
+
+  if (m_SleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+    { std::lock_guard<std::mutex> lock(m_SleepMutex); }
+    m_WakeUp.notify_one();
+  }
+}
+
+/**
+ * @brief Takes a job from the calling worker's deque, another worker or the injection queue.
+ * @return The job, or null if none was found.
+ */
+Detail::JobState* JobSystem::TryTake() {
+  const bool is_worker = Utils::t_System == this;
+  Detail::JobState* job = nullptr;
+  if (is_worker)
+    job = m_Deques[Utils::t_WorkerIndex]->Pop();
+
+  if (!job) {
+    const size_t count = m_Deques.size();
+    const size_t start = Utils::t_StealSeed++ % count;
+    for (size_t i = 0; i < count && !job; i++) {
+      const size_t victim = (start + i) % count;
+      if (!is_worker || victim != Utils::t_WorkerIndex)
+        job = m_Deques[victim]->Steal();
+    }
+  }
+
+  if (!job) {
+    std::lock_guard<std::mutex> lock(m_InjectionMutex);
+    if (!m_Injection.empty()) {
+      job = m_Injection.front();
+      m_Injection.pop_front();
+    }
+  }
+
+  if (job)
+    m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+  return job;
+}
+
+/**
+ * @brief Runs a job and schedules the continuations that no longer wait for anything.
+ * @param job The job.
+ */
+void JobSystem::Execute(Detail::JobState* job) {
+  WEAVER_PROFILE_SCOPE("Job");
+  std::shared_ptr<Detail::JobState> self = std::move(job->Self);
+  try {
+    job->Func();
+  } catch (...) {
+    job->Error = std::current_exception();
+  }
+  job->Func = nullptr;
+
+  std::vector<std::shared_ptr<Detail::JobState>> continuations;
+  {
+    std::lock_guard<std::mutex> lock(job->Mutex);
+    job->Done.store(true, std::memory_order_release);
+    continuations.swap(job->Continuations);
+  }
+  for (auto& continuation : continuations) {
+    if (continuation->Dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      Enqueue(std::move(continuation));
+  }
+}
+
+/**
+ * @brief The loop executed by each worker thread.
+ * @param index The index of the worker.
+ */
+void JobSystem::WorkerLoop(uint32_t index) {
+  Utils::t_System = this;
+  Utils::t_WorkerIndex = index;
+  Utils::t_StealSeed = index + 1;
+  WEAVER_PROFILE_THREAD("Job Worker " + std::to_string(index));
+
+  while (true) {
+    if (Detail::JobState* job = TryTake()) {
+      Execute(job);
+      continue;
+    }
+    // Jobs queued before the stop are still run.
+    if (m_Stopping.load() && m_QueuedJobs.load() <= 0)
+      return;
+    if (m_QueuedJobs.load() > 0) {
+      // A job is being pushed or another thief won a race, try again.
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_SleepMutex);
+    m_SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+    m_WakeUp.wait(lock, [this]() { return m_Stopping.load() || m_QueuedJobs.load() > 0; });
+    m_SleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace Weaver
@@ -0,0 +1,363 @@
+/**
+ * @file JobSystem.h
+ * @author B.G. Smit
+ * @brief Declares the work-stealing job system shared by the Core and the layers.
+ *
+ * This file defines the `JobSystem` class and the `JobHandle` returned for every scheduled job.
+ * Each worker owns a bounded lock-free deque: it pushes and pops jobs at the bottom while idle
+ * workers steal from the top, so fine-grained jobs rarely contend. Jobs scheduled from threads
+ * that are not workers go through a shared injection queue. A job can be scheduled to run after
+ * other jobs (a continuation), and a thread waiting for a job executes other jobs meanwhile.
+ * `ParallelFor`, `ParallelReduce` and `ParallelSort` build on this for data-parallel loops.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Weaver {
+
+class JobSystem;
+
+namespace Detail {
+
+/**
+ * @struct JobState
+ * @brief The shared state of one scheduled job.
+ */
+struct JobState {
+  std::function<void()> Func;
+  // The number of dependencies that have not finished yet.
+  std::atomic<uint32_t> Dependencies{0};
+  std::atomic<bool> Done{false};
+  std::exception_ptr Error;
+
+  // Jobs to schedule once this one has finished.
+  std::mutex Mutex;
+  std::vector<std::shared_ptr<JobState>> Continuations;
+
+  // Keeps the job alive while it is queued, released when it runs.
+  std::shared_ptr<JobState> Self;
+};
+
+/**
+ * @class WorkStealingDeque
+ * @brief A bounded Chase-Lev deque of jobs.
+ * @details The owning thread calls `Push` and `Pop` at the bottom; any thread may `Steal` from
+ * the top.
+ */
+class WorkStealingDeque {
+ public:
+  /**
+   * @brief Constructs a new WorkStealingDeque.
+   * @param capacity The maximum number of queued jobs, a power of two.
+   */
+  explicit WorkStealingDeque(size_t capacity);
+
+  /**
+   * @brief Pushes a job at the bottom. Owning thread only.
+   * @param job The job.
+   * @return False if the deque is full.
+   */
+  bool Push(JobState* job);
+  /**
+   * @brief Pops the most recently pushed job. Owning thread only.
+   * @return The job, or null if the deque is empty.
+   */
+  JobState* Pop();
+  /**
+   * @brief Steals the oldest job. Safe on any thread.
+   * @return The job, or null if the deque is empty or another thread won the race.
+   */
+  JobState* Steal();
+
+ private:
+  std::vector<std::atomic<JobState*>> m_Buffer;
+  const int64_t m_Mask;
+  alignas(64) std::atomic<int64_t> m_Top{0};
+  alignas(64) std::atomic<int64_t> m_Bottom{0};
+};
+
+}  // namespace Detail
+
+/**
+ * @class JobHandle
+ * @brief Refers to a scheduled job. Cheap to copy.
+ */
+class JobHandle {
+ public:
+  JobHandle() = default;
+
+  /**
+   * @brief Checks if the handle refers to a job.
+   * @return True if the handle is valid.
+   */
+  bool IsValid() const {
+    return m_State != nullptr;
+  }
+  /**
+   * @brief Checks if the job has finished, without waiting.
+   * @return True if the job has finished, or the handle is empty.
+   */
+  bool IsDone() const {
+    return !m_State || m_State->Done.load(std::memory_order_acquire);
+  }
+
+ private:
+  friend class JobSystem;
+  explicit JobHandle(std::shared_ptr<Detail::JobState> state) : m_State(std::move(state)) {}
+
+  std::shared_ptr<Detail::JobState> m_State;
+};
+
+/**
+ * @class JobSystem
+ * @brief Runs jobs on a fixed set of worker threads that steal work from each other.
+ * @details Started by `Weaver::Main` before the `Canvas` and available through `Get`. All methods
+ * are thread-safe. Jobs must not block on anything but other jobs (through `Wait`).
+ */
+class JobSystem {
+ public:
+  /**
+   * @brief Constructs a new JobSystem and starts its workers. Becomes the instance of `Get`.
+   * @param worker_count The number of worker threads. Zero selects one less than the hardware
+   * concurrency, as the thread that waits for jobs helps to execute them.
+   */
+  explicit JobSystem(uint32_t worker_count = 0);
+  /**
+   * @brief Destroys the JobSystem. Jobs that are still queued are run before the workers stop.
+   */
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  /**
+   * @brief Gets the job system started by `Weaver::Main`.
+   * @return A reference to the job system.
+   */
+  static JobSystem& Get();
+
+  /**
+   * @brief Schedules a job.
+   * @param func The function to run on a worker.
+   * @return The handle of the job.
+   */
+  JobHandle Schedule(std::function<void()> func);
+  /**
+   * @brief Schedules a job to run once other jobs have finished.
+   * @param func The function to run on a worker.
+   * @param dependencies The jobs to wait for. Empty handles are ignored.
+   * @return The handle of the job.
+   */
+  JobHandle Schedule(std::function<void()> func, const std::vector<JobHandle>& dependencies);
+  /**
+   * @brief Schedules a continuation of a job.
+   * @param job The job to continue.
+   * @param func The function to run once `job` has finished.
+   * @return The handle of the continuation.
+   */
+  JobHandle Then(const JobHandle& job, std::function<void()> func) {
+    return Schedule(std::move(func), {job});
+  }
+
+  /**
+   * @brief Waits for a job, executing other jobs in the meantime.
+   * @details Rethrows the exception the job threw, if any.
+   * @param job The job.
+   */
+  void Wait(const JobHandle& job);
+
+  /**
+   * @brief Runs `func` over the chunks of a range and returns once all have finished.
+   * @details The chunks are handed out dynamically to the workers and the calling thread.
+   * @param begin The first index.
+   * @param end One past the last index.
+   * @param grain The number of indices per chunk. Zero picks one from the range and thread count.
+   * @param func Called with the first and one past the last index of a chunk.
+   */
+  void ParallelForChunks(size_t begin,
+      size_t end,
+      size_t grain,
+      const std::function<void(size_t, size_t)>& func);
+
+  /**
+   * @brief Calls `func(i)` for every index of a range in parallel.
+   * @param begin The first index.
+   * @param end One past the last index.
+   * @param func Called with each index.
+   * @param grain The number of indices per chunk, zero for automatic.
+   */
+  template <typename Func>
+  void ParallelFor(size_t begin, size_t end, Func&& func, size_t grain = 0) {
+    ParallelForChunks(begin, end, grain, [&func](size_t chunk_begin, size_t chunk_end) {
+      for (size_t i = chunk_begin; i < chunk_end; i++)
+        func(i);
+    });
+  }
+
+  /**
+   * @brief Combines `map(i)` over a range in parallel.
+   * @details Chunks are reduced in index order, so the result only depends on the grain.
+   * @param begin The first index.
+   * @param end One past the last index.
+   * @param identity The value combined with an empty range.
+   * @param map Returns the value of an index.
+   * @param reduce Combines two values. Must be associative.
+   * @param grain The number of indices per chunk, zero for automatic.
+   * @return The combined value.
+   */
+  template <typename T, typename Map, typename Reduce>
+  T ParallelReduce(
+      size_t begin, size_t end, T identity, Map&& map, Reduce&& reduce, size_t grain = 0) {
+    if (end <= begin)
+      return identity;
+    grain = GetGrain(end - begin, grain);
+    const size_t chunk_count = (end - begin + grain - 1) / grain;
+    std::vector<T> partials(chunk_count, identity);
+    ParallelForChunks(0, chunk_count, 1, [&](size_t chunk, size_t) {
+      const size_t chunk_begin = begin + chunk * grain;
+      const size_t chunk_end = std::min(end, chunk_begin + grain);
+      T value = identity;
+      for (size_t i = chunk_begin; i < chunk_end; i++)
+        value = reduce(value, map(i));
+      partials[chunk] = std::move(value);
+    });
+
+    T result = identity;
+    for (T& partial : partials)
+      result = reduce(result, partial);
+    return result;
+  }
+
+  /**
+   * @brief Sorts a range in parallel.
+   * @details Sorts one run per thread, then merges pairs of runs in parallel. Not stable.
+   * @param first The first element.
+   * @param last One past the last element.
+   * @param comp The comparison, as for `std::sort`.
+   */
+  template <typename RandomIt, typename Compare>
+  void ParallelSort(RandomIt first, RandomIt last, Compare comp) {
+    const size_t count = (size_t)std::distance(first, last);
+    size_t runs = std::min<size_t>(GetThreadCount(), count / kMinSortRun);
+    if (runs < 2) {
+      std::sort(first, last, comp);
+      return;
+    }
+
+    std::vector<size_t> bounds(runs + 1);
+    for (size_t i = 0; i <= runs; i++)
+      bounds[i] = count * i / runs;
+    ParallelForChunks(0, runs, 1, [&](size_t run, size_t) {
+      std::sort(first + bounds[run], first + bounds[run + 1], comp);
+    });
+
+    // Merge neighbouring runs until one is left.
+    while (bounds.size() > 2) {
+      const size_t pairs = (bounds.size() - 1) / 2;
+      ParallelForChunks(0, pairs, 1, [&](size_t pair, size_t) {
+        std::inplace_merge(first + bounds[pair * 2],
+            first + bounds[pair * 2 + 1],
+            first + bounds[pair * 2 + 2],
+            comp);
+      });
+      std::vector<size_t> merged;
+      for (size_t i = 0; i < bounds.size(); i += 2)
+        merged.push_back(bounds[i]);
+      if (merged.back() != bounds.back())
+        merged.push_back(bounds.back());
+      bounds.swap(merged);
+    }
+  }
+
+  /**
+   * @brief Sorts a range in ascending order in parallel.
+   * @param first The first element.
+   * @param last One past the last element.
+   */
+  template <typename RandomIt>
+  void ParallelSort(RandomIt first, RandomIt last) {
+    ParallelSort(first, last, std::less<>());
+  }
+
+  /**
+   * @brief Gets the number of worker threads.
+   * @return The number of worker threads.
+   */
+  uint32_t GetWorkerCount() const {
+    return (uint32_t)m_Workers.size();
+  }
+  /**
+   * @brief Gets the number of threads that execute jobs, the workers and a waiting thread.
+   * @return The number of threads.
+   */
+  uint32_t GetThreadCount() const {
+    return GetWorkerCount() + 1;
+  }
+
+ private:
+  /**
+   * @brief Picks the chunk size of a parallel loop.
+   * @param count The number of indices.
+   * @param grain The requested chunk size, zero for automatic.
+   * @return The chunk size.
+   */
+  size_t GetGrain(size_t count, size_t grain) const;
+  /**
+   * @brief Queues a job whose dependencies have finished.
+   * @param job The job.
+   */
+  void Enqueue(std::shared_ptr<Detail::JobState> job);
+  /**
+   * @brief Takes a job from the calling worker's deque, another worker or the injection queue.
+   * @return The job, or null if none was found.
+   */
+  Detail::JobState* TryTake();
+  /**
+   * @brief Runs a job and schedules the continuations that no longer wait for anything.
+   * @param job The job.
+   */
+  void Execute(Detail::JobState* job);
+  /**
+   * @brief The loop executed by each worker thread.
+   * @param index The index of the worker.
+   */
+  void WorkerLoop(uint32_t index);
+
+ private:
+  static constexpr size_t kDequeCapacity = 4096;
+  static constexpr size_t kMinSortRun = 4096;
+
+  std::vector<std::unique_ptr<Detail::WorkStealingDeque>> m_Deques;
+  std::vector<std::thread> m_Workers;
+
+  // Jobs scheduled from threads that are not workers, or that did not fit into a deque.
+  std::mutex m_InjectionMutex;
+  std::deque<Detail::JobState*> m_Injection;
+
+  // Queued jobs that no thread has taken yet; idle workers sleep while it is zero.
+  std::atomic<int64_t> m_QueuedJobs{0};
+  std::atomic<uint32_t> m_SleepingWorkers{0};
+  std::mutex m_SleepMutex;
+  std::condition_variable m_WakeUp;
+  std::atomic<bool> m_Stopping{false};
+};
+
+}  // namespace Weaver
+
+#endif
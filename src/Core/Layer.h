@@ -15,8 +15,58 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "EventBus.h"
+
 namespace Weaver {
 
+class LayerScheduler;
+
+/**
+ * @enum LayerUpdateMode
+ * @brief When a layer's `OnUpdate` is called. `OnUIRender` is called every frame regardless.
+ */
+enum class LayerUpdateMode {
+  EveryFrame, /**< Every frame, at the display rate. */
+  FixedRate,  /**< At most `LayerUpdateTraits::UpdateRate` times per second. */
+  OnRequest   /**< Only in the frame after `Layer::RequestUpdate` was called, and the first one. */
+};
+
+/**
+ * @struct LayerUpdateTraits
+ * @brief Declares which data a layer's `OnUpdate` shares with other layers, and how often it runs.
+ * @details Layers that declare traits run `OnUpdate` on a worker thread, concurrently with the
+ * layers they do not conflict with; two layers conflict if one writes a name the other reads or
+ * writes. Layers that declare nothing run on the main thread, in stack order, and are not
+ * overlapped with any other layer. Worker threads must not call ImGui, but may upload pixels with
+ * `Image::SetData`, which goes through the thread-safe `UploadQueue`.
+ */
+struct LayerUpdateTraits {
+  /** `OnUpdate` shares no data with other layers. */
+  bool Independent = false;
+  /** The names of the shared data `OnUpdate` reads. */
+  std::vector<std::string> Reads;
+  /** The names of the shared data `OnUpdate` writes. */
+  std::vector<std::string> Writes;
+  /** When `OnUpdate` is called. */
+  LayerUpdateMode UpdateMode = LayerUpdateMode::EveryFrame;
+  /** The updates per second of `LayerUpdateMode::FixedRate`. */
+  float UpdateRate = 0.0f;
+
+  /**
+   * @brief Checks if the layer may run on a worker thread.
+   * @return True if the layer declared its data.
+   */
+  bool IsDeclared() const {
+    return Independent || !Reads.empty() || !Writes.empty();
+  }
+};
+
 /**
  * @class Layer
  * @brief An abstract base class for application layers.
@@ -39,33 +89,65 @@ class Layer {
   virtual void OnDetach() {}
 
   /**
-   * @brief Called every frame to update the layer's state.
-   * @param ts The time step since the last frame.
+   * @brief Called every frame, or as often as `GetUpdateTraits` requests, to update the layer's
+   * state.
+   * @param ts The time since the last call in seconds.
    */
   virtual void OnUpdate(float ts) {}
+  /**
+   * @brief Gets the data `OnUpdate` shares with other layers and how often it runs. Queried when
+   * the layer stack changes.
+   * @return The update traits. The default runs `OnUpdate` every frame on the main thread.
+   */
+  virtual LayerUpdateTraits GetUpdateTraits() const {
+    return {};
+  }
   /**
    * @brief Called every frame to render the layer's UI.
    */
   virtual void OnUIRender() {}
+
   /**
-   * @brief Called when the window is resized.
-   * @param width The new width of the window.
-   * @param height The new height of the window.
+   * @brief Requests a call to `OnUpdate` in the next frame, for `LayerUpdateMode::OnRequest`.
+   * Thread-safe.
    */
-  virtual void OnResize(uint32_t width, uint32_t height) {}
+  void RequestUpdate() {
+    m_UpdateRequested.store(true, std::memory_order_release);
+  }
 
   /**
-   * @brief Called when the window is minimized.
+   * @brief Gets the event handlers of the layer, see `Subscribe`.
+   * @return The event listener.
    */
-  virtual void OnMinimize() {}
+  EventListener& GetEventListener() {
+    return m_EventListener;
+  }
+
+ protected:
   /**
-   * @brief Called when the window is maximized.
+   * @brief Registers the handler of an event type, see `Events.h`. Call from `OnAttach`.
+   * @details Events are delivered on the main thread before `OnUpdate`, from the top of the layer
+   * stack down, until a handler returns true.
+   * @param handler Called with each event of the type. Returns true if it handled the event.
    */
-  virtual void OnMaximize() {}
+  template <typename T>
+  void Subscribe(std::function<bool(const T&)> handler) {
+    m_EventListener.Subscribe<T>(std::move(handler));
+  }
   /**
-   * @brief Called when the window is restored.
+   * @brief Removes the handler of an event type.
    */
-  virtual void OnRestored() {}
+  template <typename T>
+  void Unsubscribe() {
+    m_EventListener.Unsubscribe<T>();
+  }
+
+ private:
+  friend class LayerScheduler;
+
+  EventListener m_EventListener;
+
+  std::atomic<bool> m_UpdateRequested{true};
 };
 
 }  // namespace Weaver
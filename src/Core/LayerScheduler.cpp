@@ -0,0 +1,200 @@
+/**
+ * @file LayerScheduler.cpp
+ * @author B.G. Smit
+ * @brief Implements the scheduler that runs the `OnUpdate` of the layer stack.
+ * @copyright Copyright (c) 2025
+ */
+#include "LayerScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief Checks if two lists of names share a name.
+ * @param a The first list.
+ * @param b The second list.
+ * @return True if a name is in both lists.
+ */
+static bool Intersects(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+  for (const std::string& name : a) {
+    if (std::find(b.begin(), b.end(), name) != b.end())
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Checks if two layers may not run at the same time.
+ * @param a The traits of the first layer.
+ * @param b The traits of the second layer.
+ * @return True if one writes data the other reads or writes.
+ */
+static bool Conflicts(const LayerUpdateTraits& a, const LayerUpdateTraits& b) {
+  return Intersects(a.Writes, b.Writes) || Intersects(a.Writes, b.Reads) ||
+         Intersects(a.Reads, b.Writes);
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new LayerScheduler.
+ * @param jobs The job system that runs the concurrent layers.
+ */
+LayerScheduler::LayerScheduler(JobSystem& jobs) : m_Jobs(jobs) {}
+
+/**
+ * @brief Runs `OnUpdate` of every layer that is due, timed by the wall time since the previous
+ * call.
+ * @param layers The layer stack.
+ */
+void LayerScheduler::Update(const std::vector<std::shared_ptr<Layer>>& layers) {
+  const auto now = std::chrono::steady_clock::now();
+  const float ts = m_LastUpdate == std::chrono::steady_clock::time_point()
+                       ? 0.0f
+                       : std::chrono::duration<float>(now - m_LastUpdate).count();
+  m_LastUpdate = now;
+  Update(layers, ts);
+}
+
+/**
+ * @brief Runs `OnUpdate` of every layer that is due and returns once all of them have finished.
+ * @param layers The layer stack.
+ * @param ts The time since the previous update of the stack in seconds.
+ */
+void LayerScheduler::Update(const std::vector<std::shared_ptr<Layer>>& layers, float ts) {
+  if (!m_Built || layers.size() != m_ScheduledLayerCount)
+    Build(layers);
+
+  m_UpdatedLayerCount = 0;
+  for (const Stage& stage : m_Stages) {
+    m_DueLayers.clear();
+    for (size_t index : stage.Layers) {
+      if (IsDue(index, *layers[index], ts))
+        m_DueLayers.push_back(index);
+    }
+    m_UpdatedLayerCount += m_DueLayers.size();
+
+    if (stage.MainThread || m_DueLayers.size() <= 1) {
+      for (size_t index : m_DueLayers)
+        RunLayer(index, *layers[index]);
+    } else {
+      // The calling thread takes part, and exceptions are rethrown once the stage has joined.
+      m_Jobs.ParallelForChunks(0, m_DueLayers.size(), 1, [&](size_t i, size_t) {
+        RunLayer(m_DueLayers[i], *layers[m_DueLayers[i]]);
+      });
+    }
+  }
+}
+
+/**
+ * @brief Builds the stages from the traits of the layers.
+ * @param layers The layer stack.
+ */
+void LayerScheduler::Build(const std::vector<std::shared_ptr<Layer>>& layers) {
+  m_Stages.clear();
+  m_UpdateTimes.assign(layers.size(), 0.0f);
+  m_ScheduledLayerCount = layers.size();
+  m_Built = true;
+
+  std::vector<LayerUpdateTraits> traits;
+  traits.reserve(layers.size());
+  for (const auto& layer : layers)
+    traits.push_back(layer->GetUpdateTraits());
+
+  m_Modes.clear();
+  m_Periods.clear();
+  m_Elapsed.assign(layers.size(), 0.0f);
+  m_Phases.assign(layers.size(), 0.0f);
+  m_Updated.assign(layers.size(), 0);
+  for (const LayerUpdateTraits& layer_traits : traits) {
+    LayerUpdateMode mode = layer_traits.UpdateMode;
+    if (mode == LayerUpdateMode::FixedRate && layer_traits.UpdateRate <= 0.0f)
+      mode = LayerUpdateMode::EveryFrame;
+    m_Modes.push_back(mode);
+    m_Periods.push_back(mode == LayerUpdateMode::FixedRate ? 1.0f / layer_traits.UpdateRate : 0.0f);
+  }
+
+  // Declared layers between two main-thread layers form a segment. Within it a layer goes into
+  // the stage after the last layer it conflicts with, so stack order is kept for those.
+  size_t segment_begin = 0;
+  std::vector<size_t> stage_of(layers.size(), 0);
+  for (size_t i = 0; i < layers.size(); i++) {
+    if (!traits[i].IsDeclared()) {
+      Stage stage;
+      stage.MainThread = true;
+      stage.Layers.push_back(i);
+      m_Stages.push_back(std::move(stage));
+      segment_begin = m_Stages.size();
+      continue;
+    }
+
+    size_t target = segment_begin;
+    for (size_t j = 0; j < i; j++) {
+      if (stage_of[j] >= segment_begin && traits[j].IsDeclared() &&
+          Utils::Conflicts(traits[i], traits[j]))
+        target = std::max(target, stage_of[j] + 1);
+    }
+    if (target == m_Stages.size())
+      m_Stages.emplace_back();
+    m_Stages[target].Layers.push_back(i);
+    stage_of[i] = target;
+  }
+}
+
+/**
+ * @brief Advances the time of one layer and checks if it updates this frame.
+ * @param index The index of the layer.
+ * @param layer The layer.
+ * @param ts The time step since the last frame.
+ * @return True if `OnUpdate` is called this frame.
+ */
+bool LayerScheduler::IsDue(size_t index, Layer& layer, float ts) {
+  m_Elapsed[index] += ts;
+  switch (m_Modes[index]) {
+    case LayerUpdateMode::FixedRate: {
+      // The first frame always updates, so the layer has state to render.
+      float& phase = m_Phases[index];
+      phase += ts;
+      if (!m_Updated[index]) {
+        phase = 0.0f;
+        return true;
+      }
+      const float period = m_Periods[index];
+      if (phase < period)
+        return false;
+      // The overshoot counts towards the next update, so frame quantization does not lower the
+      // rate. After a stall the missed updates are dropped, instead of updating every frame
+      // until the layer caught up.
+      phase -= period;
+      if (phase >= period)
+        phase = std::fmod(phase, period);
+      return true;
+    }
+    case LayerUpdateMode::OnRequest:
+      return layer.m_UpdateRequested.exchange(false, std::memory_order_acq_rel);
+    default:
+      return true;
+  }
+}
+
+/**
+ * @brief Runs `OnUpdate` of one layer and records its time.
+ * @param index The index of the layer.
+ * @param layer The layer.
+ */
+void LayerScheduler::RunLayer(size_t index, Layer& layer) {
+  const float ts = m_Elapsed[index];
+  m_Elapsed[index] = 0.0f;
+  m_Updated[index] = 1;
+  const auto start = std::chrono::steady_clock::now();
+  layer.OnUpdate(ts);
+  const auto end = std::chrono::steady_clock::now();
+  m_UpdateTimes[index] = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+}  // namespace Weaver
@@ -0,0 +1,135 @@
+/**
+ * @file LayerScheduler.h
+ * @author B.G. Smit
+ * @brief Declares the scheduler that runs the `OnUpdate` of the layer stack.
+ *
+ * This file defines the `LayerScheduler` class. From the `LayerUpdateTraits` of the layers it
+ * builds stages: layers that declared nothing run alone on the main thread, in stack order, and
+ * declared layers between them are grouped so that no two layers of a stage conflict. The layers
+ * of a stage run concurrently on the `JobSystem` and the main thread, and the stage is joined
+ * before the next one starts. Layers with a `LayerUpdateMode` other than `EveryFrame` are left
+ * out of the frames in which they are not due.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef LAYER_SCHEDULER_H
+#define LAYER_SCHEDULER_H
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Layer.h"
+
+namespace Weaver {
+
+/**
+ * @class LayerScheduler
+ * @brief Runs the `OnUpdate` of every layer, in parallel where the layers allow it.
+ * @details Owned by the `Canvas`. Must be called from the main thread.
+ */
+class LayerScheduler {
+ public:
+  /**
+   * @brief Constructs a new LayerScheduler.
+   * @param jobs The job system that runs the concurrent layers.
+   */
+  explicit LayerScheduler(JobSystem& jobs);
+
+  /**
+   * @brief Runs `OnUpdate` of every layer that is due, timed by the wall time since the previous
+   * call.
+   * @details Called by the `Canvas` once per frame. The time is measured rather than taken from
+   * the frame, so the idle time of on-demand rendering counts towards fixed-rate layers.
+   * @param layers The layer stack.
+   */
+  void Update(const std::vector<std::shared_ptr<Layer>>& layers);
+
+  /**
+   * @brief Runs `OnUpdate` of every layer that is due and returns once all of them have finished.
+   * @details The schedule is rebuilt when the number of layers changes. An exception thrown by
+   * a layer is rethrown here after its stage has finished. Layers receive the time since their
+   * previous update rather than `ts`.
+   * @param layers The layer stack.
+   * @param ts The time since the previous update of the stack in seconds.
+   */
+  void Update(const std::vector<std::shared_ptr<Layer>>& layers, float ts);
+
+  /**
+   * @brief Gets the time each layer spent in its last `OnUpdate`.
+   * @return The times in milliseconds, in layer stack order.
+   */
+  const std::vector<float>& GetUpdateTimes() const {
+    return m_UpdateTimes;
+  }
+  /**
+   * @brief Gets the number of layers updated in the last frame.
+   * @return The number of layers whose `OnUpdate` was called.
+   */
+  size_t GetUpdatedLayerCount() const {
+    return m_UpdatedLayerCount;
+  }
+  /**
+   * @brief Gets the number of stages of the current schedule.
+   * @return The number of stages, each joined before the next starts.
+   */
+  size_t GetStageCount() const {
+    return m_Stages.size();
+  }
+
+ private:
+  /**
+   * @struct Stage
+   * @brief Layers that run together, either alone on the main thread or concurrently.
+   */
+  struct Stage {
+    bool MainThread = false;
+    std::vector<size_t> Layers;
+  };
+
+  /**
+   * @brief Builds the stages from the traits of the layers.
+   * @param layers The layer stack.
+   */
+  void Build(const std::vector<std::shared_ptr<Layer>>& layers);
+  /**
+   * @brief Advances the time of one layer and checks if it updates this frame.
+   * @param index The index of the layer.
+   * @param layer The layer.
+   * @param ts The time step since the last frame.
+   * @return True if `OnUpdate` is called this frame.
+   */
+  bool IsDue(size_t index, Layer& layer, float ts);
+  /**
+   * @brief Runs `OnUpdate` of one layer and records its time.
+   * @param index The index of the layer.
+   * @param layer The layer.
+   */
+  void RunLayer(size_t index, Layer& layer);
+
+ private:
+  JobSystem& m_Jobs;
+  std::vector<Stage> m_Stages;
+  size_t m_ScheduledLayerCount = 0;
+  bool m_Built = false;
+  std::vector<float> m_UpdateTimes;
+  std::chrono::steady_clock::time_point m_LastUpdate;
+
+  // The update mode of each layer, and the time since its last update. `m_Phases` holds the time
+  // a fixed-rate layer is owed, which keeps the overshoot of each update so the rate holds on
+  // average.
+  std::vector<LayerUpdateMode> m_Modes;
+  std::vector<float> m_Periods;
+  std::vector<float> m_Elapsed;
+  std::vector<float> m_Phases;
+  std::vector<char> m_Updated;
+  std::vector<size_t> m_DueLayers;
+  size_t m_UpdatedLayerCount = 0;
+};
+
+}  // namespace Weaver
+
+#endif
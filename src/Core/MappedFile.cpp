@@ -0,0 +1,134 @@
+/**
+ * @file MappedFile.cpp
+ * @author B.G. Smit
+ * @brief Implements the read-only memory-mapped file for Windows and POSIX platforms.
+ * @copyright Copyright (c) 2025
+ */
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Weaver {
+
+#ifdef _WIN32
+
+/**
+ * @brief Maps a file into memory.
+ * @param path The path to the file.
+ */
+MappedFile::MappedFile(const std::string& path) {
+  HANDLE file = CreateFileA(path.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    return;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return;
+  }
+
+  m_FileHandle = file;
+  m_MappingHandle = mapping;
+  m_Data = (const uint8_t*)data;
+  m_Size = (size_t)size.QuadPart;
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile() {
+  if (m_Data)
+    UnmapViewOfFile(m_Data);
+  if (m_MappingHandle)
+    CloseHandle(m_MappingHandle);
+  if (m_FileHandle)
+    CloseHandle(m_FileHandle);
+}
+
+/**
+ * @brief Asks the operating system to read the whole file into memory ahead of use.
+ */
+void MappedFile::Prefetch() const {
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+  if (m_Data) {
+    WIN32_MEMORY_RANGE_ENTRY range = {(PVOID)m_Data, m_Size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+  }
+#endif
+}
+
+#else
+
+/**
+ * @brief Maps a file into memory.
+ * @param path The path to the file.
+ */
+MappedFile::MappedFile(const std::string& path) {
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0)
+    return;
+
+  struct stat info;
+  if (fstat(file, &info) != 0 || info.st_size <= 0) {
+    close(file);
+    return;
+  }
+
+  void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  // The mapping keeps its own reference to the file.
+  close(file);
+  if (data == MAP_FAILED)
+    return;
+
+  // Image files are read front to back exactly once.
+  madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+  m_Data = (const uint8_t*)data;
+  m_Size = (size_t)info.st_size;
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile() {
+  if (m_Data)
+    munmap((void*)m_Data, m_Size);
+}
+
+/**
+ * @brief Asks the operating system to read the whole file into memory ahead of use.
+ */
+void MappedFile::Prefetch() const {
+  if (m_Data)
+    madvise((void*)m_Data, m_Size, MADV_WILLNEED);
+}
+
+#endif
+
+}  // namespace Weaver
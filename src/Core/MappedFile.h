@@ -0,0 +1,81 @@
+/**
+ * @file MappedFile.h
+ * @author B.G. Smit
+ * @brief Declares a read-only memory-mapped file.
+ *
+ * This file defines the `MappedFile` class, which maps a whole file into the address
+ * space of the process so its contents can be read without stdio buffering or an
+ * intermediate copy. It is used by the image loaders to ingest large files.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Weaver {
+
+/**
+ * @class MappedFile
+ * @brief A read-only view of a file mapped into memory.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Maps a file into memory.
+   * @param path The path to the file. Check `IsOpen` for success.
+   */
+  explicit MappedFile(const std::string& path);
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Checks whether the file was mapped successfully.
+   * @return True if the file is mapped, false otherwise.
+   */
+  bool IsOpen() const {
+    return m_Data != nullptr;
+  }
+
+  /**
+   * @brief Gets the contents of the file.
+   * @return A pointer to the first byte of the file.
+   */
+  const uint8_t* GetData() const {
+    return m_Data;
+  }
+
+  /**
+   * @brief Gets the size of the file.
+   * @return The size of the file in bytes.
+   */
+  size_t GetSize() const {
+    return m_Size;
+  }
+
+  /**
+   * @brief Asks the operating system to read the whole file into memory ahead of use.
+   */
+  void Prefetch() const;
+
+ private:
+  const uint8_t* m_Data = nullptr;
+  size_t m_Size = 0;
+#ifdef _WIN32
+  void* m_FileHandle = nullptr;
+  void* m_MappingHandle = nullptr;
+#endif
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @file MpscQueue.h
+ * @author B.G. Smit
+ * @brief Declares lock-free multi-producer, single-consumer queues.
+ *
+ * This file defines the `MpscQueue` class template. Any thread may push without taking a lock;
+ * one consumer thread takes everything pushed so far in a single atomic exchange. The `Canvas`
+ * uses it for resources freed from worker threads. `BoundedMpscQueue` is a fixed-size ring that
+ * does not allocate when pushing, used for the tasks posted to the main thread.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @class MpscQueue
+ * @brief An unbounded lock-free queue with many producers and one consumer.
+ * @tparam T The type of the queued items.
+ */
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() = default;
+  /**
+   * @brief Destroys the MpscQueue and the items that were never taken.
+   */
+  ~MpscQueue() {
+    Node* node = m_Head.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+      Node* next = node->Next;
+      delete node;
+      node = next;
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  /**
+   * @brief Pushes an item. Safe to call from any thread.
+   * @param item The item to push.
+   */
+  void Push(T&& item) {
+    Node* node = new Node{std::move(item), m_Head.load(std::memory_order_relaxed)};
+    while (!m_Head.compare_exchange_weak(
+        node->Next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * @brief Takes every item pushed so far. Must only be called from the consumer thread.
+   * @param items Receives the items in the order they were pushed.
+   */
+  void PopAll(std::vector<T>& items) {
+    Node* node = m_Head.exchange(nullptr, std::memory_order_acquire);
+
+    // The list is newest first, reverse it to restore the push order.
+    Node* reversed = nullptr;
+    while (node) {
+      Node* next = node->Next;
+      node->Next = reversed;
+      reversed = node;
+      node = next;
+    }
+    while (reversed) {
+      Node* next = reversed->Next;
+      items.push_back(std::move(reversed->Item));
+      delete reversed;
+      reversed = next;
+    }
+  }
+
+  /**
+   * @brief Checks if the queue is empty. The result may be outdated as soon as it returns.
+   * @return True if no items are queued.
+   */
+  bool IsEmpty() const {
+    return m_Head.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  /**
+   * @struct Node
+   * @brief A queued item and the item pushed before it.
+   */
+  struct Node {
+    T Item;
+    Node* Next;
+  };
+
+  std::atomic<Node*> m_Head{nullptr};
+};
+
+/**
+ * @class BoundedMpscQueue
+ * @brief A fixed-size lock-free ring buffer with many producers and one consumer.
+ * @details Each cell carries a sequence number that tells producers and the consumer whose turn
+ * it is, so pushing only needs one compare-and-swap and neither side allocates.
+ * @tparam T The type of the queued items. Must be default constructible and movable.
+ * @tparam Capacity The maximum number of queued items, a power of two so positions wrap with a
+ * mask.
+ */
+template <typename T, size_t Capacity>
+class BoundedMpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+      "BoundedMpscQueue: the capacity must be a power of two");
+
+ public:
+  /**
+   * @brief Constructs a new BoundedMpscQueue.
+   */
+  BoundedMpscQueue() : m_Cells(std::make_unique<Cell[]>(Capacity)) {
+    for (size_t i = 0; i < Capacity; i++)
+      m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+  }
+
+  BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+  BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+  /**
+   * @brief Pushes an item. Safe to call from any thread.
+   * @param item The item to push. Left untouched if the queue is full.
+   * @return False if the queue is full.
+   */
+  bool TryPush(T&& item) {
+    size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &m_Cells[position & kMask];
+      const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+      const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+      if (difference == 0) {
+        if (m_EnqueuePosition.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed))
+          break;
+      } else if (difference < 0) {
+        // The cell still holds the item from one lap ago.
+        return false;
+      } else {
+        position = m_EnqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+    cell->Item = std::move(item);
+    cell->Sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pops the oldest item. Must only be called from the consumer thread.
+   * @param item Receives the item.
+   * @return False if the queue is empty.
+   */
+  bool TryPop(T& item) {
+    Cell& cell = m_Cells[m_DequeuePosition & kMask];
+    const size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+    if ((intptr_t)sequence - (intptr_t)(m_DequeuePosition + 1) < 0)
+      return false;
+    item = std::move(cell.Item);
+    cell.Item = T();
+    cell.Sequence.store(m_DequeuePosition + kMask + 1, std::memory_order_release);
+    m_DequeuePosition++;
+    return true;
+  }
+
+  /**
+   * @brief Gets the number of queued items. Consumer thread only; may be outdated at once.
+   * @return The number of items pushed but not popped, including pushes still in progress.
+   */
+  size_t GetSize() const {
+    return m_EnqueuePosition.load(std::memory_order_acquire) - m_DequeuePosition;
+  }
+  /**
+   * @brief Gets the maximum number of queued items.
+   * @return The capacity.
+   */
+  static constexpr size_t GetCapacity() {
+    return Capacity;
+  }
+
+ private:
+  /**
+   * @struct Cell
+   * @brief A slot of the ring and the position it is waiting for.
+   */
+  struct Cell {
+    std::atomic<size_t> Sequence{0};
+    T Item;
+  };
+
+  static constexpr size_t kMask = Capacity - 1;
+
+  std::unique_ptr<Cell[]> m_Cells;
+  alignas(64) std::atomic<size_t> m_EnqueuePosition{0};
+  alignas(64) size_t m_DequeuePosition = 0;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,729 @@
+/**
+ * @file PixelConversion.cpp
+ * @author B.G. Smit
+ * @brief Implements the scalar, SSE4.1 and AVX2 pixel conversion kernels.
+ * @copyright Copyright (c) 2025
+ */
+#include "PixelConversion.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WEAVER_PIXEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit vector instructions for functions that opt in, which lets the
+// rest of the build target the baseline ISA. MSVC always accepts the intrinsics.
+#if defined(WEAVER_PIXEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define WEAVER_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define WEAVER_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#else
+#define WEAVER_TARGET_SSE41
+#define WEAVER_TARGET_AVX2
+#endif
+
+namespace Weaver {
+
+namespace Utils {
+
+static SimdLevel DetectSimdLevel() {
+#ifdef WEAVER_PIXEL_X86
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c"))
+    return SimdLevel::AVX2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return SimdLevel::SSE41;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  const bool f16c = (info[2] & (1 << 29)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  // AVX state must also be enabled by the operating system.
+  const bool avx_state = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+  bool avx2 = false;
+  if (max_leaf >= 7) {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+
+  if (avx2 && f16c && avx_state)
+    return SimdLevel::AVX2;
+  if (sse41)
+    return SimdLevel::SSE41;
+#endif
+#endif
+  return SimdLevel::Scalar;
+}
+
+static SimdLevel s_SupportedLevel = DetectSimdLevel();
+static std::atomic<SimdLevel> s_ActiveLevel{s_SupportedLevel};
+
+static inline float BitsToFloat(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static inline uint8_t ClampToUnorm8(float value) {
+  // Written so NaN fails both comparisons and ends up as zero.
+  value = value > 0.0f ? value : 0.0f;
+  value = value < 1.0f ? value : 1.0f;
+  return (uint8_t)(int)(value * 255.0f + 0.5f);
+}
+
+static inline uint8_t MultiplyUnorm8(uint32_t a, uint32_t b) {
+  // Exact round(a * b / 255) for 8-bit operands.
+  const uint32_t t = a * b + 128;
+  return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+// Linear to sRGB goes through a table indexed by the clamped value scaled to 14 bits,
+// which keeps the worst-case error well below one 8-bit step without calling pow.
+static constexpr int SRGB_TABLE_BITS = 14;
+static constexpr int SRGB_TABLE_SIZE = 1 << SRGB_TABLE_BITS;
+
+struct SRGBTables {
+  uint32_t Encode[SRGB_TABLE_SIZE];
+  float Decode[256];
+
+  SRGBTables() {
+    for (int i = 0; i < SRGB_TABLE_SIZE; i++) {
+      const double linear = (double)i / (SRGB_TABLE_SIZE - 1);
+      const double srgb = linear <= 0.0031308 ? linear * 12.92
+                                              : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+      Encode[i] = (uint32_t)(srgb * 255.0 + 0.5);
+    }
+    for (int i = 0; i < 256; i++) {
+      const double srgb = i / 255.0;
+      Decode[i] = (float)(srgb <= 0.04045 ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4));
+    }
+  }
+};
+
+static const SRGBTables& GetSRGBTables() {
+  static const SRGBTables tables;
+  return tables;
+}
+
+static inline int SRGBTableIndex(float value) {
+  value = value > 0.0f ? value : 0.0f;
+  value = value < 1.0f ? value : 1.0f;
+  return (int)(value * (SRGB_TABLE_SIZE - 1) + 0.5f);
+}
+
+}  // namespace Utils
+
+namespace Scalar {
+
+static void RGBToRGBA(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  for (size_t i = 0; i < pixel_count; i++) {
+    destination[i * 4 + 0] = source[i * 3 + 0];
+    destination[i * 4 + 1] = source[i * 3 + 1];
+    destination[i * 4 + 2] = source[i * 3 + 2];
+    destination[i * 4 + 3] = 255;
+  }
+}
+
+static void SwizzleRB(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  for (size_t i = 0; i < pixel_count; i++) {
+    const uint8_t r = source[i * 4 + 0];
+    const uint8_t g = source[i * 4 + 1];
+    const uint8_t b = source[i * 4 + 2];
+    const uint8_t a = source[i * 4 + 3];
+    destination[i * 4 + 0] = b;
+    destination[i * 4 + 1] = g;
+    destination[i * 4 + 2] = r;
+    destination[i * 4 + 3] = a;
+  }
+}
+
+static void FloatToHalf(const float* source, uint16_t* destination, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    destination[i] = PixelConversion::FloatToHalf(source[i]);
+}
+
+static void HalfToFloat(const uint16_t* source, float* destination, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    destination[i] = PixelConversion::HalfToFloat(source[i]);
+}
+
+static void FloatToUnorm8(const float* source, uint8_t* destination, size_t count) {
+  for (size_t i = 0; i < count; i++)
+    destination[i] = Utils::ClampToUnorm8(source[i]);
+}
+
+static void PremultiplyAlpha(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  for (size_t i = 0; i < pixel_count; i++) {
+    const uint32_t a = source[i * 4 + 3];
+    destination[i * 4 + 0] = Utils::MultiplyUnorm8(source[i * 4 + 0], a);
+    destination[i * 4 + 1] = Utils::MultiplyUnorm8(source[i * 4 + 1], a);
+    destination[i * 4 + 2] = Utils::MultiplyUnorm8(source[i * 4 + 2], a);
+    destination[i * 4 + 3] = (uint8_t)a;
+  }
+}
+
+static void LinearToSRGB(const float* source, uint8_t* destination, size_t pixel_count) {
+  const uint32_t* table = Utils::GetSRGBTables().Encode;
+  for (size_t i = 0; i < pixel_count; i++) {
+    destination[i * 4 + 0] = (uint8_t)table[Utils::SRGBTableIndex(source[i * 4 + 0])];
+    destination[i * 4 + 1] = (uint8_t)table[Utils::SRGBTableIndex(source[i * 4 + 1])];
+    destination[i * 4 + 2] = (uint8_t)table[Utils::SRGBTableIndex(source[i * 4 + 2])];
+    destination[i * 4 + 3] = Utils::ClampToUnorm8(source[i * 4 + 3]);
+  }
+}
+
+static void SRGBToLinear(const uint8_t* source, float* destination, size_t pixel_count) {
+  const float* table = Utils::GetSRGBTables().Decode;
+  for (size_t i = 0; i < pixel_count; i++) {
+    destination[i * 4 + 0] = table[source[i * 4 + 0]];
+    destination[i * 4 + 1] = table[source[i * 4 + 1]];
+    destination[i * 4 + 2] = table[source[i * 4 + 2]];
+    destination[i * 4 + 3] = source[i * 4 + 3] * (1.0f / 255.0f);
+  }
+}
+
+}  // namespace Scalar
+
+#ifdef WEAVER_PIXEL_X86
+
+namespace SSE41 {
+
+WEAVER_TARGET_SSE41
+static void RGBToRGBA(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+  // Each step consumes 12 bytes but loads 16, so stop while 16 bytes are still readable.
+  size_t i = 0;
+  for (; i + 6 <= pixel_count; i += 4) {
+    const __m128i rgb = _mm_loadu_si128((const __m128i*)(source + i * 3));
+    const __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+    _mm_storeu_si128((__m128i*)(destination + i * 4), rgba);
+  }
+  Scalar::RGBToRGBA(source + i * 3, destination + i * 4, pixel_count - i);
+}
+
+WEAVER_TARGET_SSE41
+static void SwizzleRB(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+  size_t i = 0;
+  for (; i + 4 <= pixel_count; i += 4) {
+    const __m128i pixels = _mm_loadu_si128((const __m128i*)(source + i * 4));
+    _mm_storeu_si128((__m128i*)(destination + i * 4), _mm_shuffle_epi8(pixels, shuffle));
+  }
+  Scalar::SwizzleRB(source + i * 4, destination + i * 4, pixel_count - i);
+}
+
+// Branchless float to half with round to nearest even, bit-exact with the scalar path.
+WEAVER_TARGET_SSE41
+static inline __m128i FloatToHalf4(__m128 value) {
+  const __m128i f16_max = _mm_set1_epi32((127 + 16) << 23);
+  const __m128i min_normal = _mm_set1_epi32((127 - 14) << 23);
+  const __m128i subnormal_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+  const __m128i normal_bias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+  const __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000)));
+  const __m128 absolute = _mm_xor_ps(value, sign);
+  const __m128i absolute_bits = _mm_castps_si128(absolute);
+
+  const __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+  const __m128i is_regular = _mm_cmpgt_epi32(f16_max, absolute_bits);
+  const __m128i is_subnormal = _mm_cmpgt_epi32(min_normal, absolute_bits);
+  const __m128i special =
+      _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+  // Subnormal results: let the FPU round by adding a magic number.
+  const __m128 subnormal_sum = _mm_add_ps(absolute, _mm_castsi128_ps(subnormal_magic));
+  const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormal_sum), subnormal_magic);
+
+  // Normal results: rebias the exponent and round, biasing up when the kept LSB is odd.
+  const __m128i odd = _mm_srai_epi32(_mm_slli_epi32(absolute_bits, 31 - 13), 31);
+  const __m128i rounded = _mm_sub_epi32(_mm_add_epi32(absolute_bits, normal_bias), odd);
+  const __m128i normal = _mm_srli_epi32(rounded, 13);
+
+  const __m128i finite = _mm_blendv_epi8(normal, subnormal, is_subnormal);
+  const __m128i joined = _mm_blendv_epi8(special, finite, is_regular);
+  // The arithmetic shift keeps negative results within int16 for the signed pack.
+  return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+WEAVER_TARGET_SSE41
+static void FloatToHalf(const float* source, uint16_t* destination, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i low = FloatToHalf4(_mm_loadu_ps(source + i));
+    const __m128i high = FloatToHalf4(_mm_loadu_ps(source + i + 4));
+    _mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi32(low, high));
+  }
+  Scalar::FloatToHalf(source + i, destination + i, count - i);
+}
+
+WEAVER_TARGET_SSE41
+static inline __m128 HalfToFloat4(__m128i half) {
+  const __m128i exponent_mask = _mm_set1_epi32(0x7c00 << 13);
+  const __m128i exponent_adjust = _mm_set1_epi32((127 - 15) << 23);
+  const __m128 subnormal_magic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+
+  const __m128i magnitude = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x7fff)), 13);
+  const __m128i exponent = _mm_and_si128(magnitude, exponent_mask);
+  __m128i bits = _mm_add_epi32(magnitude, exponent_adjust);
+
+  // Infinity and NaN: push the exponent to the float maximum.
+  const __m128i is_special = _mm_cmpeq_epi32(exponent, exponent_mask);
+  bits = _mm_add_epi32(bits, _mm_and_si128(is_special, exponent_adjust));
+
+  // Zero and subnormals: renormalize through the FPU.
+  const __m128i is_subnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+  const __m128 renormalized = _mm_sub_ps(
+      _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))), subnormal_magic);
+  bits = _mm_blendv_epi8(bits, _mm_castps_si128(renormalized), is_subnormal);
+
+  const __m128i sign = _mm_slli_epi32(_mm_and_si128(half, _mm_set1_epi32(0x8000)), 16);
+  return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+}
+
+WEAVER_TARGET_SSE41
+static void HalfToFloat(const uint16_t* source, float* destination, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i halves = _mm_loadu_si128((const __m128i*)(source + i));
+    _mm_storeu_ps(destination + i, HalfToFloat4(_mm_cvtepu16_epi32(halves)));
+    _mm_storeu_ps(destination + i + 4, HalfToFloat4(_mm_cvtepu16_epi32(_mm_srli_si128(halves, 8))));
+  }
+  Scalar::HalfToFloat(source + i, destination + i, count - i);
+}
+
+WEAVER_TARGET_SSE41
+static inline __m128i FloatToUnorm4(__m128 value) {
+  // max/min return the second operand for NaN, so NaN clamps to zero like the scalar path.
+  value = _mm_max_ps(value, _mm_setzero_ps());
+  value = _mm_min_ps(value, _mm_set1_ps(1.0f));
+  return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+WEAVER_TARGET_SSE41
+static void FloatToUnorm8(const float* source, uint8_t* destination, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i a = FloatToUnorm4(_mm_loadu_ps(source + i));
+    const __m128i b = FloatToUnorm4(_mm_loadu_ps(source + i + 4));
+    const __m128i c = FloatToUnorm4(_mm_loadu_ps(source + i + 8));
+    const __m128i d = FloatToUnorm4(_mm_loadu_ps(source + i + 12));
+    const __m128i packed = _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_packus_epi32(c, d));
+    _mm_storeu_si128((__m128i*)(destination + i), packed);
+  }
+  Scalar::FloatToUnorm8(source + i, destination + i, count - i);
+}
+
+WEAVER_TARGET_SSE41
+static inline __m128i PremultiplyWords(__m128i pixels) {
+  // Broadcast each pixel's alpha word to its four channels, keep alpha as 255.
+  const __m128i alpha_shuffle =
+      _mm_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+  const __m128i alpha_one = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+  const __m128i alpha = _mm_or_si128(_mm_shuffle_epi8(pixels, alpha_shuffle), alpha_one);
+
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+  t = _mm_add_epi16(t, _mm_srli_epi16(t, 8));
+  return _mm_srli_epi16(t, 8);
+}
+
+WEAVER_TARGET_SSE41
+static void PremultiplyAlpha(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  size_t i = 0;
+  for (; i + 4 <= pixel_count; i += 4) {
+    const __m128i pixels = _mm_loadu_si128((const __m128i*)(source + i * 4));
+    const __m128i low = PremultiplyWords(_mm_cvtepu8_epi16(pixels));
+    const __m128i high = PremultiplyWords(_mm_cvtepu8_epi16(_mm_srli_si128(pixels, 8)));
+    _mm_storeu_si128((__m128i*)(destination + i * 4), _mm_packus_epi16(low, high));
+  }
+  Scalar::PremultiplyAlpha(source + i * 4, destination + i * 4, pixel_count - i);
+}
+
+WEAVER_TARGET_SSE41
+static void LinearToSRGB(const float* source, uint8_t* destination, size_t pixel_count) {
+  const uint32_t* table = Utils::GetSRGBTables().Encode;
+  const __m128 scale = _mm_setr_ps(Utils::SRGB_TABLE_SIZE - 1, Utils::SRGB_TABLE_SIZE - 1,
+      Utils::SRGB_TABLE_SIZE - 1, 255.0f);
+
+  for (size_t i = 0; i < pixel_count; i++) {
+    __m128 value = _mm_loadu_ps(source + i * 4);
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    const __m128i index = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), _mm_set1_ps(0.5f)));
+
+    destination[i * 4 + 0] = (uint8_t)table[_mm_cvtsi128_si32(index)];
+    destination[i * 4 + 1] = (uint8_t)table[_mm_extract_epi32(index, 1)];
+    destination[i * 4 + 2] = (uint8_t)table[_mm_extract_epi32(index, 2)];
+    destination[i * 4 + 3] = (uint8_t)_mm_extract_epi32(index, 3);
+  }
+}
+
+}  // namespace SSE41
+
+namespace AVX2 {
+
+WEAVER_TARGET_AVX2
+static void RGBToRGBA(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+  // The shuffle works per 128-bit lane, so load four pixels into each lane.
+  size_t i = 0;
+  for (; i + 10 <= pixel_count; i += 8) {
+    const __m128i low = _mm_loadu_si128((const __m128i*)(source + i * 3));
+    const __m128i high = _mm_loadu_si128((const __m128i*)(source + i * 3 + 12));
+    const __m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+    const __m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha);
+    _mm256_storeu_si256((__m256i*)(destination + i * 4), rgba);
+  }
+  SSE41::RGBToRGBA(source + i * 3, destination + i * 4, pixel_count - i);
+}
+
+WEAVER_TARGET_AVX2
+static void SwizzleRB(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+      2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+  size_t i = 0;
+  for (; i + 8 <= pixel_count; i += 8) {
+    const __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i * 4));
+    _mm256_storeu_si256((__m256i*)(destination + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+  }
+  SSE41::SwizzleRB(source + i * 4, destination + i * 4, pixel_count - i);
+}
+
+WEAVER_TARGET_AVX2
+static void FloatToHalf(const float* source, uint16_t* destination, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128((__m128i*)(destination + i), halves);
+  }
+  Scalar::FloatToHalf(source + i, destination + i, count - i);
+}
+
+WEAVER_TARGET_AVX2
+static void HalfToFloat(const uint16_t* source, float* destination, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i halves = _mm_loadu_si128((const __m128i*)(source + i));
+    _mm256_storeu_ps(destination + i, _mm256_cvtph_ps(halves));
+  }
+  Scalar::HalfToFloat(source + i, destination + i, count - i);
+}
+
+WEAVER_TARGET_AVX2
+static inline __m256i FloatToUnorm8x8(__m256 value) {
+  value = _mm256_max_ps(value, _mm256_setzero_ps());
+  value = _mm256_min_ps(value, _mm256_set1_ps(1.0f));
+  return _mm256_cvttps_epi32(
+      _mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+WEAVER_TARGET_AVX2
+static void FloatToUnorm8(const float* source, uint8_t* destination, size_t count) {
+  // The packs interleave 128-bit lanes, the final permute restores the element order.
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    const __m256i a = FloatToUnorm8x8(_mm256_loadu_ps(source + i));
+    const __m256i b = FloatToUnorm8x8(_mm256_loadu_ps(source + i + 8));
+    const __m256i c = FloatToUnorm8x8(_mm256_loadu_ps(source + i + 16));
+    const __m256i d = FloatToUnorm8x8(_mm256_loadu_ps(source + i + 24));
+    const __m256i packed =
+        _mm256_packus_epi16(_mm256_packus_epi32(a, b), _mm256_packus_epi32(c, d));
+    _mm256_storeu_si256(
+        (__m256i*)(destination + i), _mm256_permutevar8x32_epi32(packed, order));
+  }
+  SSE41::FloatToUnorm8(source + i, destination + i, count - i);
+}
+
+WEAVER_TARGET_AVX2
+static inline __m256i PremultiplyWords(__m256i pixels) {
+  const __m256i alpha_shuffle = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14,
+      15, -1, -1, 6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+  const __m256i alpha_one =
+      _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+  const __m256i alpha = _mm256_or_si256(_mm256_shuffle_epi8(pixels, alpha_shuffle), alpha_one);
+
+  __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+  t = _mm256_add_epi16(t, _mm256_srli_epi16(t, 8));
+  return _mm256_srli_epi16(t, 8);
+}
+
+WEAVER_TARGET_AVX2
+static void PremultiplyAlpha(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  size_t i = 0;
+  for (; i + 8 <= pixel_count; i += 8) {
+    const __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i * 4));
+    // unpack/pack both work per lane, so the pixel order is preserved end to end.
+    const __m256i low = PremultiplyWords(_mm256_unpacklo_epi8(pixels, _mm256_setzero_si256()));
+    const __m256i high = PremultiplyWords(_mm256_unpackhi_epi8(pixels, _mm256_setzero_si256()));
+    _mm256_storeu_si256((__m256i*)(destination + i * 4), _mm256_packus_epi16(low, high));
+  }
+  SSE41::PremultiplyAlpha(source + i * 4, destination + i * 4, pixel_count - i);
+}
+
+WEAVER_TARGET_AVX2
+static void LinearToSRGB(const float* source, uint8_t* destination, size_t pixel_count) {
+  const int* table = (const int*)Utils::GetSRGBTables().Encode;
+  const float table_scale = Utils::SRGB_TABLE_SIZE - 1;
+  const __m256 scale = _mm256_setr_ps(
+      table_scale, table_scale, table_scale, 255.0f, table_scale, table_scale, table_scale, 255.0f);
+  const __m256i is_alpha = _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1);
+  const __m256i bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, 0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+  size_t i = 0;
+  for (; i + 2 <= pixel_count; i += 2) {
+    __m256 value = _mm256_loadu_ps(source + i * 4);
+    value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    const __m256i index = _mm256_cvttps_epi32(
+        _mm256_add_ps(_mm256_mul_ps(value, scale), _mm256_set1_ps(0.5f)));
+
+    // Color channels come from the table, alpha is already its unorm value.
+    const __m256i encoded = _mm256_mask_i32gather_epi32(index, table, index,
+        _mm256_xor_si256(is_alpha, _mm256_set1_epi32(-1)), 4);
+    const __m256i packed = _mm256_shuffle_epi8(encoded, bytes);
+
+    const uint32_t first = (uint32_t)_mm256_extract_epi32(packed, 0);
+    const uint32_t second = (uint32_t)_mm256_extract_epi32(packed, 4);
+    std::memcpy(destination + i * 4, &first, 4);
+    std::memcpy(destination + i * 4 + 4, &second, 4);
+  }
+  SSE41::LinearToSRGB(source + i * 4, destination + i * 4, pixel_count - i);
+}
+
+WEAVER_TARGET_AVX2
+static void SRGBToLinear(const uint8_t* source, float* destination, size_t pixel_count) {
+  const float* table = Utils::GetSRGBTables().Decode;
+  const __m256 is_alpha = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+
+  size_t i = 0;
+  for (; i + 2 <= pixel_count; i += 2) {
+    const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(source + i * 4)));
+    const __m256 linear = _mm256_i32gather_ps(table, index, 4);
+    const __m256 alpha = _mm256_mul_ps(_mm256_cvtepi32_ps(index), _mm256_set1_ps(1.0f / 255.0f));
+    _mm256_storeu_ps(destination + i * 4, _mm256_blendv_ps(linear, alpha, is_alpha));
+  }
+  Scalar::SRGBToLinear(source + i * 4, destination + i * 4, pixel_count - i);
+}
+
+}  // namespace AVX2
+
+#endif
+
+/**
+ * @brief Gets the best instruction set supported by the CPU.
+ * @return The supported SIMD level.
+ */
+SimdLevel PixelConversion::GetSupportedSimdLevel() {
+  return Utils::s_SupportedLevel;
+}
+
+/**
+ * @brief Gets the instruction set currently used by the kernels.
+ * @return The active SIMD level.
+ */
+SimdLevel PixelConversion::GetSimdLevel() {
+  return Utils::s_ActiveLevel.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Overrides the instruction set used by the kernels.
+ * @param level The requested level, clamped to the supported level.
+ */
+void PixelConversion::SetSimdLevel(SimdLevel level) {
+  if ((int)level > (int)Utils::s_SupportedLevel)
+    level = Utils::s_SupportedLevel;
+  Utils::s_ActiveLevel.store(level, std::memory_order_relaxed);
+}
+
+#ifdef WEAVER_PIXEL_X86
+#define WEAVER_DISPATCH(kernel, ...)                   \
+  switch (GetSimdLevel()) {                            \
+    case SimdLevel::AVX2: return AVX2::kernel(__VA_ARGS__);   \
+    case SimdLevel::SSE41: return SSE41::kernel(__VA_ARGS__); \
+    default: return Scalar::kernel(__VA_ARGS__);              \
+  }
+#else
+#define WEAVER_DISPATCH(kernel, ...) return Scalar::kernel(__VA_ARGS__);
+#endif
+
+/**
+ * @brief Expands 8-bit RGB pixels to RGBA with an opaque alpha.
+ * @param source The RGB pixels.
+ * @param destination The RGBA pixels.
+ * @param pixel_count The number of pixels.
+ */
+void PixelConversion::RGBToRGBA(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  WEAVER_DISPATCH(RGBToRGBA, source, destination, pixel_count)
+}
+
+/**
+ * @brief Swaps the red and blue channels of 8-bit four channel pixels.
+ * @param source The source pixels.
+ * @param destination The swizzled pixels.
+ * @param pixel_count The number of pixels.
+ */
+void PixelConversion::SwizzleRB(const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  WEAVER_DISPATCH(SwizzleRB, source, destination, pixel_count)
+}
+
+/**
+ * @brief Converts 32-bit floats to 16-bit half floats.
+ * @param source The float values.
+ * @param destination The half float bit patterns.
+ * @param count The number of values.
+ */
+void PixelConversion::FloatToHalf(const float* source, uint16_t* destination, size_t count) {
+  WEAVER_DISPATCH(FloatToHalf, source, destination, count)
+}
+
+/**
+ * @brief Converts 16-bit half floats to 32-bit floats.
+ * @param source The half float bit patterns.
+ * @param destination The float values.
+ * @param count The number of values.
+ */
+void PixelConversion::HalfToFloat(const uint16_t* source, float* destination, size_t count) {
+  WEAVER_DISPATCH(HalfToFloat, source, destination, count)
+}
+
+/**
+ * @brief Converts floats to 8-bit unsigned normalized values.
+ * @param source The float values.
+ * @param destination The unorm values.
+ * @param count The number of values.
+ */
+void PixelConversion::FloatToUnorm8(const float* source, uint8_t* destination, size_t count) {
+  WEAVER_DISPATCH(FloatToUnorm8, source, destination, count)
+}
+
+/**
+ * @brief Multiplies the color channels of 8-bit RGBA pixels by their alpha.
+ * @param source The straight alpha pixels.
+ * @param destination The premultiplied pixels.
+ * @param pixel_count The number of pixels.
+ */
+void PixelConversion::PremultiplyAlpha(
+    const uint8_t* source, uint8_t* destination, size_t pixel_count) {
+  WEAVER_DISPATCH(PremultiplyAlpha, source, destination, pixel_count)
+}
+
+/**
+ * @brief Encodes linear float RGBA pixels as 8-bit sRGB.
+ * @param source The linear pixels.
+ * @param destination The sRGB pixels.
+ * @param pixel_count The number of pixels.
+ */
+void PixelConversion::LinearToSRGB(const float* source, uint8_t* destination, size_t pixel_count) {
+  WEAVER_DISPATCH(LinearToSRGB, source, destination, pixel_count)
+}
+
+/**
+ * @brief Decodes 8-bit sRGB RGBA pixels to linear floats.
+ * @param source The sRGB pixels.
+ * @param destination The linear pixels.
+ * @param pixel_count The number of pixels.
+ */
+void PixelConversion::SRGBToLinear(const uint8_t* source, float* destination, size_t pixel_count) {
+#ifdef WEAVER_PIXEL_X86
+  // A table lookup per channel is already as fast as SSE4.1 gets without a gather.
+  if (GetSimdLevel() == SimdLevel::AVX2)
+    return AVX2::SRGBToLinear(source, destination, pixel_count);
+#endif
+  Scalar::SRGBToLinear(source, destination, pixel_count);
+}
+
+#undef WEAVER_DISPATCH
+
+/**
+ * @brief Converts a single 32-bit float to a 16-bit half float, rounding to nearest even.
+ * @param value The value to convert.
+ * @return The half float bit pattern.
+ */
+uint16_t PixelConversion::FloatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000u;
+  const uint32_t exponent = (bits >> 23) & 0xffu;
+  uint32_t mantissa = bits & 0x007fffffu;
+
+  // NaN and infinity
+  if (exponent == 0xffu)
+    return (uint16_t)(sign | 0x7c00u | (mantissa ? 0x0200u : 0u));
+
+  int32_t half_exponent = (int32_t)exponent - 127 + 15;
+  // Overflow to infinity
+  if (half_exponent >= 0x1f)
+    return (uint16_t)(sign | 0x7c00u);
+
+  // Subnormal half or underflow to zero
+  if (half_exponent <= 0) {
+    if (half_exponent < -10)
+      return (uint16_t)sign;
+    mantissa |= 0x00800000u;
+    const uint32_t shift = (uint32_t)(14 - half_exponent);
+    uint32_t half_mantissa = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    const uint32_t halfway = 1u << (shift - 1u);
+    if (remainder > halfway || (remainder == halfway && (half_mantissa & 1u)))
+      half_mantissa++;
+    return (uint16_t)(sign | half_mantissa);
+  }
+
+  uint32_t half = sign | ((uint32_t)half_exponent << 10) | (mantissa >> 13);
+  const uint32_t remainder = mantissa & 0x1fffu;
+  // A carry out of the mantissa correctly bumps the exponent (and saturates to infinity).
+  if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+    half++;
+  return (uint16_t)half;
+}
+
+/**
+ * @brief Converts a single 16-bit half float to a 32-bit float.
+ * @param value The half float bit pattern.
+ * @return The float value.
+ */
+float PixelConversion::HalfToFloat(uint16_t value) {
+  const uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1F;
+  uint32_t mantissa = value & 0x3FF;
+
+  if (exponent == 0x1F)
+    return Utils::BitsToFloat(sign | 0x7F800000 | (mantissa << 13));
+
+  if (exponent == 0) {
+    if (mantissa == 0)
+      return Utils::BitsToFloat(sign);
+    // Subnormal half, every one of them is a normal float.
+    int32_t shift = 0;
+    while ((mantissa & 0x400) == 0) {
+      mantissa <<= 1;
+      shift++;
+    }
+    mantissa &= 0x3FF;
+    return Utils::BitsToFloat(sign | ((uint32_t)(127 - 15 + 1 - shift) << 23) | (mantissa << 13));
+  }
+
+  return Utils::BitsToFloat(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
+
+}  // namespace Weaver
@@ -0,0 +1,141 @@
+/**
+ * @file PixelConversion.h
+ * @author B.G. Smit
+ * @brief Declares vectorized pixel conversion kernels used on the image upload path.
+ *
+ * This file defines the `PixelConversion` class, a set of static kernels that convert
+ * pixel data between source and GPU formats (channel expansion, swizzles, float to half,
+ * float to unorm, alpha premultiplication and sRGB encode/decode). Each kernel has a
+ * scalar implementation and SSE4.1 / AVX2 implementations on x86, selected at runtime
+ * from the features of the CPU.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef PIXEL_CONVERSION_H
+#define PIXEL_CONVERSION_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Weaver {
+
+/**
+ * @enum SimdLevel
+ * @brief The instruction set used by the pixel conversion kernels.
+ */
+enum class SimdLevel {
+  Scalar = 0, /**< Portable C++ implementation. */
+  SSE41,      /**< SSE4.1 implementation. */
+  AVX2        /**< AVX2 (+ F16C) implementation. */
+};
+
+/**
+ * @class PixelConversion
+ * @brief Static pixel conversion kernels with runtime instruction set dispatch.
+ * @details All kernels accept unaligned pointers. Unless stated otherwise, source and
+ * destination must not overlap.
+ */
+class PixelConversion {
+ public:
+  /**
+   * @brief Gets the best instruction set supported by the CPU.
+   * @return The supported SIMD level.
+   */
+  static SimdLevel GetSupportedSimdLevel();
+  /**
+   * @brief Gets the instruction set currently used by the kernels.
+   * @return The active SIMD level.
+   */
+  static SimdLevel GetSimdLevel();
+  /**
+   * @brief Overrides the instruction set used by the kernels, e.g. for tests and benchmarks.
+   * @param level The requested level, clamped to the supported level.
+   */
+  static void SetSimdLevel(SimdLevel level);
+
+  /**
+   * @brief Expands 8-bit RGB pixels to RGBA with an opaque alpha.
+   * @param source The RGB pixels, `pixel_count * 3` bytes.
+   * @param destination The RGBA pixels, `pixel_count * 4` bytes.
+   * @param pixel_count The number of pixels.
+   */
+  static void RGBToRGBA(const uint8_t* source, uint8_t* destination, size_t pixel_count);
+
+  /**
+   * @brief Swaps the red and blue channels of 8-bit four channel pixels (BGRA <-> RGBA).
+   * @details Source and destination may be the same buffer.
+   * @param source The source pixels, `pixel_count * 4` bytes.
+   * @param destination The swizzled pixels, `pixel_count * 4` bytes.
+   * @param pixel_count The number of pixels.
+   */
+  static void SwizzleRB(const uint8_t* source, uint8_t* destination, size_t pixel_count);
+
+  /**
+   * @brief Converts 32-bit floats to 16-bit half floats, rounding to nearest even.
+   * @param source The float values.
+   * @param destination The half float bit patterns.
+   * @param count The number of values.
+   */
+  static void FloatToHalf(const float* source, uint16_t* destination, size_t count);
+
+  /**
+   * @brief Converts 16-bit half floats to 32-bit floats.
+   * @param source The half float bit patterns.
+   * @param destination The float values.
+   * @param count The number of values.
+   */
+  static void HalfToFloat(const uint16_t* source, float* destination, size_t count);
+
+  /**
+   * @brief Converts floats to 8-bit unsigned normalized values, clamping to [0, 1].
+   * @details NaN is converted to zero.
+   * @param source The float values.
+   * @param destination The unorm values.
+   * @param count The number of values.
+   */
+  static void FloatToUnorm8(const float* source, uint8_t* destination, size_t count);
+
+  /**
+   * @brief Multiplies the color channels of 8-bit RGBA pixels by their alpha.
+   * @details Rounds exactly to nearest. Source and destination may be the same buffer.
+   * @param source The straight alpha pixels, `pixel_count * 4` bytes.
+   * @param destination The premultiplied pixels, `pixel_count * 4` bytes.
+   * @param pixel_count The number of pixels.
+   */
+  static void PremultiplyAlpha(const uint8_t* source, uint8_t* destination, size_t pixel_count);
+
+  /**
+   * @brief Encodes linear float RGBA pixels as 8-bit sRGB. Alpha stays linear.
+   * @param source The linear pixels, `pixel_count * 4` floats.
+   * @param destination The sRGB pixels, `pixel_count * 4` bytes.
+   * @param pixel_count The number of pixels.
+   */
+  static void LinearToSRGB(const float* source, uint8_t* destination, size_t pixel_count);
+
+  /**
+   * @brief Decodes 8-bit sRGB RGBA pixels to linear floats. Alpha stays linear.
+   * @param source The sRGB pixels, `pixel_count * 4` bytes.
+   * @param destination The linear pixels, `pixel_count * 4` floats.
+   * @param pixel_count The number of pixels.
+   */
+  static void SRGBToLinear(const uint8_t* source, float* destination, size_t pixel_count);
+
+  /**
+   * @brief Converts a single 32-bit float to a 16-bit half float, rounding to nearest even.
+   * @param value The value to convert.
+   * @return The half float bit pattern.
+   */
+  static uint16_t FloatToHalf(float value);
+
+  /**
+   * @brief Converts a single 16-bit half float to a 32-bit float.
+   * @param value The half float bit pattern.
+   * @return The float value.
+   */
+  static float HalfToFloat(uint16_t value);
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,417 @@
+/**
+ * @file Profiler.cpp
+ * @author B.G. Smit
+ * @brief Implements the instrumentation profiler and its Chrome trace export.
+ * @copyright Copyright (c) 2025
+ */
+#include "Profiler.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "Clock.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @struct ProfileEvent
+ * @brief A recorded event.
+ */
+struct ProfileEvent {
+  const char* Name;
+  uint64_t Timestamp;  // Clock ticks.
+  uint64_t Frame;
+  Profiler::EventType Type;
+};
+
+/**
+ * @struct ProfileChunk
+ * @brief A block of events. Only the owning thread writes; `Count` publishes the written events.
+ */
+struct ProfileChunk {
+  ProfileEvent Events[Profiler::kEventsPerChunk];
+  std::atomic<size_t> Count{0};
+  std::atomic<ProfileChunk*> Next{nullptr};
+};
+
+/**
+ * @struct ProfileThreadBuffer
+ * @brief The events of one thread. Kept after the thread exits, so its events can be exported.
+ */
+struct ProfileThreadBuffer {
+  ~ProfileThreadBuffer() {
+    ProfileChunk* chunk = Head.Next.load();
+    while (chunk) {
+      ProfileChunk* next = chunk->Next.load();
+      delete chunk;
+      chunk = next;
+    }
+  }
+
+  uint32_t Id = 0;
+  std::string Name;  // Guarded by s_Mutex.
+  std::atomic<uint64_t> Session{0};
+  std::atomic<size_t> Dropped{0};
+  ProfileChunk Head;
+  ProfileChunk* Tail = &Head;  // Owning thread only.
+  size_t ChunkCount = 1;       // Owning thread only.
+};
+
+static std::mutex s_Mutex;
+static std::vector<std::unique_ptr<ProfileThreadBuffer>> s_Buffers;
+static std::vector<ProfileThreadBuffer*> s_Tracks;  // Guarded by s_Mutex, owned by s_Buffers.
+static std::unordered_set<std::string> s_Names;     // Guarded by s_Mutex.
+static std::atomic<uint64_t> s_Session{0};
+static std::atomic<bool> s_Active{false};
+// Events store raw clock ticks, converted to nanoseconds since the session began on export.
+static std::atomic<Clock::Ticks> s_Epoch{0};
+static thread_local ProfileThreadBuffer* t_Buffer = nullptr;
+
+/**
+ * @brief Creates a buffer. `s_Mutex` must be held.
+ * @param prefix The name of the buffer, followed by its id.
+ * @return The buffer.
+ */
+static ProfileThreadBuffer& CreateBuffer(const char* prefix) {
+  auto buffer = std::make_unique<ProfileThreadBuffer>();
+  buffer->Id = (uint32_t)s_Buffers.size() + 1;
+  buffer->Name = prefix + (" " + std::to_string(buffer->Id));
+  s_Buffers.push_back(std::move(buffer));
+  return *s_Buffers.back();
+}
+
+/**
+ * @brief Gets the buffer of the calling thread, creating it on first use.
+ * @return The buffer.
+ */
+static ProfileThreadBuffer& GetThreadBuffer() {
+  if (!t_Buffer) {
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    t_Buffer = &CreateBuffer("Thread");
+  }
+  return *t_Buffer;
+}
+
+/**
+ * @brief Appends an event to a buffer, which only one thread may write at a time.
+ * @param buffer The buffer.
+ * @param session The session the event belongs to.
+ * @param event The event.
+ */
+static void Record(ProfileThreadBuffer& buffer, uint64_t session, const ProfileEvent& event) {
+  // The first event of a session discards the thread's events of the previous one. The chunks
+  // are kept for reuse.
+  if (buffer.Session.load(std::memory_order_relaxed) != session) {
+    for (ProfileChunk* chunk = &buffer.Head; chunk; chunk = chunk->Next.load())
+      chunk->Count.store(0, std::memory_order_relaxed);
+    buffer.Tail = &buffer.Head;
+    buffer.Dropped.store(0, std::memory_order_relaxed);
+    buffer.Session.store(session, std::memory_order_release);
+  }
+
+  ProfileChunk* chunk = buffer.Tail;
+  size_t count = chunk->Count.load(std::memory_order_relaxed);
+  if (count == Profiler::kEventsPerChunk) {
+    ProfileChunk* next = chunk->Next.load(std::memory_order_relaxed);
+    if (!next) {
+      if (buffer.ChunkCount * Profiler::kEventsPerChunk >= Profiler::kMaxEventsPerThread) {
+        buffer.Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      next = new ProfileChunk();
+      buffer.ChunkCount++;
+      chunk->Next.store(next, std::memory_order_release);
+    }
+    buffer.Tail = chunk = next;
+    count = 0;
+  }
+  chunk->Events[count] = event;
+  chunk->Count.store(count + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Appends an event to the buffer of the calling thread.
+ * @param session The session the event belongs to.
+ * @param event The event.
+ */
+static void Record(uint64_t session, const ProfileEvent& event) {
+  Record(GetThreadBuffer(), session, event);
+}
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ * @param stream The stream to write to.
+ * @param text The string.
+ */
+static void WriteJsonString(std::ostream& stream, const char* text) {
+  stream << '"';
+  for (const char* c = text; *c; c++) {
+    if (*c == '"' || *c == '\\')
+      stream << '\\' << *c;
+    else if ((unsigned char)*c < 0x20)
+      stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)*c << std::dec;
+    else
+      stream << *c;
+  }
+  stream << '"';
+}
+
+/**
+ * @brief Writes a timestamp in the microseconds Chrome traces use, keeping the nanoseconds.
+ * @param stream The stream to write to.
+ * @param timestamp The timestamp in nanoseconds.
+ */
+static void WriteMicroseconds(std::ostream& stream, uint64_t timestamp) {
+  stream << timestamp / 1000 << '.' << std::setw(3) << std::setfill('0') << timestamp % 1000;
+}
+
+/**
+ * @brief Calls a function for every buffer that holds events of the current session.
+ * @param func The function, called with the buffer and its name.
+ */
+template <typename Func>
+static void ForEachSessionBuffer(Func&& func) {
+  const uint64_t session = s_Session.load(std::memory_order_acquire);
+  if (session == 0)
+    return;
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  for (const auto& buffer : s_Buffers) {
+    if (buffer->Session.load(std::memory_order_acquire) == session)
+      func(*buffer);
+  }
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Starts a session, discarding the events of the previous one.
+ */
+void Profiler::BeginSession() {
+  Utils::s_Epoch.store(Clock::Now(), std::memory_order_relaxed);
+  Utils::s_Session.fetch_add(1, std::memory_order_acq_rel);
+  Utils::s_Active.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Stops recording. The recorded events are kept until the next session begins.
+ */
+void Profiler::EndSession() {
+  Utils::s_Active.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Checks if a session is recording.
+ * @return True if events are recorded.
+ */
+bool Profiler::IsActive() {
+  return Utils::s_Active.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Names the calling thread in the trace.
+ * @param name The name, e.g. "Main" or "Worker 3".
+ */
+void Profiler::SetThreadName(const std::string& name) {
+  Utils::ProfileThreadBuffer& buffer = Utils::GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(Utils::s_Mutex);
+  buffer.Name = name;
+}
+
+/**
+ * @brief Records the start of a frame on the calling thread.
+ * @param frame The number of the frame.
+ */
+void Profiler::MarkFrame(uint64_t frame) {
+  if (!Utils::s_Active.load(std::memory_order_acquire))
+    return;
+  Utils::Record(Utils::s_Session.load(std::memory_order_acquire),
+      {"Frame", Clock::Now(), frame, EventType::Frame});
+}
+
+/**
+ * @brief Records the begin of a scope on the calling thread.
+ * @param name The name of the scope.
+ * @return The session the event was recorded in, or 0 if none is active.
+ */
+uint64_t Profiler::BeginScope(const char* name) {
+  if (!Utils::s_Active.load(std::memory_order_acquire))
+    return 0;
+  const uint64_t session = Utils::s_Session.load(std::memory_order_acquire);
+  Utils::Record(session, {name, Clock::Now(), 0, EventType::Begin});
+  return session;
+}
+
+/**
+ * @brief Records the end of a scope on the calling thread.
+ * @param name The name of the scope.
+ * @param session The session returned by `BeginScope`. Nothing is recorded if it has ended.
+ */
+void Profiler::EndScope(const char* name, uint64_t session) {
+  // Scopes that end after `EndSession` are still closed, so every begin has its end.
+  if (Utils::s_Session.load(std::memory_order_acquire) != session)
+    return;
+  Utils::Record(session, {name, Clock::Now(), 0, EventType::End});
+}
+
+/**
+ * @brief Gets a track, a row of the trace that belongs to no thread, creating it on first use.
+ * @param name The name of the track.
+ * @return The id of the track.
+ */
+uint32_t Profiler::GetTrack(const std::string& name) {
+  std::lock_guard<std::mutex> lock(Utils::s_Mutex);
+  for (uint32_t track = 0; track < (uint32_t)Utils::s_Tracks.size(); track++) {
+    if (Utils::s_Tracks[track]->Name == name)
+      return track;
+  }
+  Utils::ProfileThreadBuffer& buffer = Utils::CreateBuffer("Track");
+  buffer.Name = name;
+  Utils::s_Tracks.push_back(&buffer);
+  return (uint32_t)Utils::s_Tracks.size() - 1;
+}
+
+/**
+ * @brief Records a span that has already ended on a track.
+ * @param track The id returned by `GetTrack`.
+ * @param name The name of the span.
+ * @param begin The `Clock` ticks at which the span began.
+ * @param end The `Clock` ticks at which the span ended.
+ */
+void Profiler::RecordSpan(uint32_t track, const char* name, uint64_t begin, uint64_t end) {
+  if (!Utils::s_Active.load(std::memory_order_acquire))
+    return;
+  Utils::ProfileThreadBuffer* buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(Utils::s_Mutex);
+    if (track >= Utils::s_Tracks.size())
+      return;
+    buffer = Utils::s_Tracks[track];
+  }
+  const uint64_t session = Utils::s_Session.load(std::memory_order_acquire);
+  Utils::Record(*buffer, session, {name, begin, 0, EventType::Begin});
+  Utils::Record(*buffer, session, {name, end, 0, EventType::End});
+}
+
+/**
+ * @brief Keeps a copy of a name for the rest of the program, for names that are not literals.
+ * @param name The name.
+ * @return The copy, the same pointer for equal names.
+ */
+const char* Profiler::Intern(const std::string& name) {
+  std::lock_guard<std::mutex> lock(Utils::s_Mutex);
+  return Utils::s_Names.insert(name).first->c_str();
+}
+
+/**
+ * @brief Writes the events of the current or last session as Chrome trace JSON.
+ * @param stream The stream to write to.
+ */
+void Profiler::WriteChromeTrace(std::ostream& stream) {
+  stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  const Clock::Ticks epoch = Utils::s_Epoch.load(std::memory_order_relaxed);
+  auto separate = [&]() {
+    if (!first)
+      stream << ",\n";
+    first = false;
+  };
+
+  Utils::ForEachSessionBuffer([&](const Utils::ProfileThreadBuffer& buffer) {
+    separate();
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.Id
+           << ",\"args\":{\"name\":";
+    Utils::WriteJsonString(stream, buffer.Name.c_str());
+    stream << "}}";
+
+    for (const Utils::ProfileChunk* chunk = &buffer.Head; chunk;
+         chunk = chunk->Next.load(std::memory_order_acquire)) {
+      const size_t count = chunk->Count.load(std::memory_order_acquire);
+      for (size_t i = 0; i < count; i++) {
+        const Utils::ProfileEvent& event = chunk->Events[i];
+        separate();
+        stream << "{\"name\":";
+        Utils::WriteJsonString(stream, event.Name);
+        switch (event.Type) {
+          case EventType::Begin:
+            stream << ",\"ph\":\"B\"";
+            break;
+          case EventType::End:
+            stream << ",\"ph\":\"E\"";
+            break;
+          case EventType::Frame:
+            stream << ",\"ph\":\"i\",\"s\":\"g\",\"args\":{\"frame\":" << event.Frame << "}";
+            break;
+        }
+        stream << ",\"pid\":1,\"tid\":" << buffer.Id << ",\"ts\":";
+        Utils::WriteMicroseconds(
+            stream, Clock::ToNanoseconds(event.Timestamp > epoch ? event.Timestamp - epoch : 0));
+        stream << "}";
+      }
+      if (count < kEventsPerChunk)
+        break;
+    }
+  });
+  stream << "]}\n";
+}
+
+/**
+ * @brief Writes the events of the current or last session as Chrome trace JSON.
+ * @param path The path of the file.
+ * @return False if the file could not be written.
+ */
+bool Profiler::WriteChromeTrace(const std::string& path) {
+  std::ofstream file(path);
+  if (!file)
+    return false;
+  WriteChromeTrace(file);
+  return (bool)file;
+}
+
+/**
+ * @brief Gets the number of events recorded in the current or last session.
+ * @return The number of events.
+ */
+size_t Profiler::GetEventCount() {
+  size_t events = 0;
+  Utils::ForEachSessionBuffer([&](const Utils::ProfileThreadBuffer& buffer) {
+    for (const Utils::ProfileChunk* chunk = &buffer.Head; chunk;
+         chunk = chunk->Next.load(std::memory_order_acquire)) {
+      const size_t count = chunk->Count.load(std::memory_order_acquire);
+      events += count;
+      if (count < kEventsPerChunk)
+        break;
+    }
+  });
+  return events;
+}
+
+/**
+ * @brief Gets the number of events dropped because a thread's buffer was full.
+ * @return The number of dropped events.
+ */
+size_t Profiler::GetDroppedEventCount() {
+  size_t dropped = 0;
+  Utils::ForEachSessionBuffer([&](const Utils::ProfileThreadBuffer& buffer) {
+    dropped += buffer.Dropped.load(std::memory_order_relaxed);
+  });
+  return dropped;
+}
+
+/**
+ * @brief Gets the time on the profiler's clock.
+ * @return The nanoseconds since the session began.
+ */
+uint64_t Profiler::GetTimestamp() {
+  const Clock::Ticks now = Clock::Now();
+  const Clock::Ticks epoch = Utils::s_Epoch.load(std::memory_order_relaxed);
+  return Clock::ToNanoseconds(now > epoch ? now - epoch : 0);
+}
+
+}  // namespace Weaver
@@ -0,0 +1,180 @@
+/**
+ * @file Profiler.h
+ * @author B.G. Smit
+ * @brief Declares the instrumentation profiler and its scope macros.
+ *
+ * This file defines the `Profiler`, which records the begin and end of instrumented scopes into
+ * per-thread buffers and exports them as a Chrome trace (open it in `chrome://tracing` or
+ * Perfetto). Scopes are instrumented with `WEAVER_PROFILE_SCOPE` and `WEAVER_PROFILE_FUNCTION`,
+ * which compile to nothing unless `WEAVER_ENABLE_PROFILING` is defined (`PROJECT_ENABLE_PROFILING`
+ * in `project_settings.cmake`). Events are only recorded while a session is active.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "FunctionPreprocessor.h"
+
+namespace Weaver {
+
+/**
+ * @class Profiler
+ * @brief Records instrumented scopes and frame markers of all threads.
+ * @details Every thread writes into a buffer of its own, so recording takes no lock; the buffer
+ * grows in chunks of `kEventsPerChunk` events up to `kMaxEventsPerThread`, after which events are
+ * dropped and counted. Sessions are begun, ended and exported from one thread, usually the main
+ * thread. Names must outlive the export, e.g. string literals or names returned by `Intern`.
+ * Besides the threads, the trace can hold tracks: named rows for spans measured elsewhere, e.g.
+ * the critical path of a `TaskGraph`.
+ */
+class Profiler {
+ public:
+  /**
+   * @enum EventType
+   * @brief The kinds of recorded events.
+   */
+  enum class EventType : uint32_t { Begin, End, Frame };
+
+  static constexpr size_t kEventsPerChunk = 4096;
+  static constexpr size_t kMaxEventsPerThread = 256 * kEventsPerChunk;
+
+  /**
+   * @brief Starts a session, discarding the events of the previous one.
+   */
+  static void BeginSession();
+  /**
+   * @brief Stops recording. The recorded events are kept until the next session begins.
+   */
+  static void EndSession();
+  /**
+   * @brief Checks if a session is recording.
+   * @return True if events are recorded.
+   */
+  static bool IsActive();
+
+  /**
+   * @brief Names the calling thread in the trace.
+   * @param name The name, e.g. "Main" or "Worker 3".
+   */
+  static void SetThreadName(const std::string& name);
+  /**
+   * @brief Records the start of a frame on the calling thread.
+   * @param frame The number of the frame.
+   */
+  static void MarkFrame(uint64_t frame);
+  /**
+   * @brief Records the begin of a scope on the calling thread.
+   * @param name The name of the scope.
+   * @return The session the event was recorded in, or 0 if none is active.
+   */
+  static uint64_t BeginScope(const char* name);
+  /**
+   * @brief Records the end of a scope on the calling thread.
+   * @param name The name of the scope.
+   * @param session The session returned by `BeginScope`. Nothing is recorded if it has ended.
+   */
+  static void EndScope(const char* name, uint64_t session);
+
+  /**
+   * @brief Gets a track, a row of the trace that belongs to no thread, creating it on first use.
+   * @param name The name of the track.
+   * @return The id of the track.
+   */
+  static uint32_t GetTrack(const std::string& name);
+  /**
+   * @brief Records a span that has already ended on a track.
+   * @details A track must be written from one thread at a time, with spans in order of time.
+   * @param track The id returned by `GetTrack`.
+   * @param name The name of the span.
+   * @param begin The `Clock` ticks at which the span began.
+   * @param end The `Clock` ticks at which the span ended.
+   */
+  static void RecordSpan(uint32_t track, const char* name, uint64_t begin, uint64_t end);
+  /**
+   * @brief Keeps a copy of a name for the rest of the program, for names that are not literals.
+   * @param name The name.
+   * @return The copy, the same pointer for equal names.
+   */
+  static const char* Intern(const std::string& name);
+
+  /**
+   * @brief Writes the events of the current or last session as Chrome trace JSON.
+   * @param stream The stream to write to.
+   */
+  static void WriteChromeTrace(std::ostream& stream);
+  /**
+   * @brief Writes the events of the current or last session as Chrome trace JSON.
+   * @param path The path of the file.
+   * @return False if the file could not be written.
+   */
+  static bool WriteChromeTrace(const std::string& path);
+
+  /**
+   * @brief Gets the number of events recorded in the current or last session.
+   * @return The number of events.
+   */
+  static size_t GetEventCount();
+  /**
+   * @brief Gets the number of events dropped because a thread's buffer was full.
+   * @return The number of dropped events.
+   */
+  static size_t GetDroppedEventCount();
+  /**
+   * @brief Gets the time on the profiler's clock, the `Clock`.
+   * @return The nanoseconds since the session began.
+   */
+  static uint64_t GetTimestamp();
+};
+
+/**
+ * @class ProfileScope
+ * @brief Records a scope from construction to destruction. Use `WEAVER_PROFILE_SCOPE`.
+ */
+class ProfileScope {
+ public:
+  /**
+   * @brief Records the begin of the scope.
+   * @param name The name of the scope. Must outlive the export.
+   */
+  explicit ProfileScope(const char* name) : m_Name(name), m_Session(Profiler::BeginScope(name)) {}
+  /**
+   * @brief Records the end of the scope.
+   */
+  ~ProfileScope() {
+    if (m_Session)
+      Profiler::EndScope(m_Name, m_Session);
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  const char* m_Name;
+  uint64_t m_Session;
+};
+
+}  // namespace Weaver
+
+#ifdef WEAVER_ENABLE_PROFILING
+#define WEAVER_PROFILE_CONCAT_IMPL(a, b) a##b
+#define WEAVER_PROFILE_CONCAT(a, b) WEAVER_PROFILE_CONCAT_IMPL(a, b)
+#define WEAVER_PROFILE_SCOPE(name) \
+  ::Weaver::ProfileScope WEAVER_PROFILE_CONCAT(weaver_profile_scope_, __LINE__)(name)
+#define WEAVER_PROFILE_FUNCTION() WEAVER_PROFILE_SCOPE(CALLING_FUNCTION_NAME)
+#define WEAVER_PROFILE_FRAME(frame) ::Weaver::Profiler::MarkFrame(frame)
+#define WEAVER_PROFILE_THREAD(name) ::Weaver::Profiler::SetThreadName(name)
+#else
+#define WEAVER_PROFILE_SCOPE(name) ((void)0)
+#define WEAVER_PROFILE_FUNCTION() ((void)0)
+#define WEAVER_PROFILE_FRAME(frame) ((void)0)
+#define WEAVER_PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,419 @@
+/**
+ * @file ReadbackQueue.cpp
+ * @author B.G. Smit
+ * @brief Implements the queue that copies image contents back to the CPU without stalling.
+ * @copyright Copyright (c) 2025
+ */
+#include "ReadbackQueue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "Canvas.h"
+#include "PixelConversion.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief Gets the Vulkan memory type index for a given memory type and properties.
+ * @param properties The memory properties.
+ * @param type_bits The memory type bits.
+ * @param out_flags Receives the property flags of the memory type found.
+ * @return The memory type index.
+ */
+static uint32_t GetReadbackMemoryType(
+    VkMemoryPropertyFlags properties, uint32_t type_bits, VkMemoryPropertyFlags& out_flags) {
+  VkPhysicalDeviceMemoryProperties prop;
+  vkGetPhysicalDeviceMemoryProperties(Canvas::GetPhysicalDevice(), &prop);
+  for (uint32_t i = 0; i < prop.memoryTypeCount; i++) {
+    if ((prop.memoryTypes[i].propertyFlags & properties) == properties && type_bits & (1 << i)) {
+      out_flags = prop.memoryTypes[i].propertyFlags;
+      return i;
+    }
+  }
+
+  return 0xffffffff;
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new ReadbackQueue.
+ * @param pool_budget The number of bytes of idle host buffers kept for reuse.
+ */
+ReadbackQueue::ReadbackQueue(uint64_t pool_budget) : m_PoolBudget(pool_budget), m_Workers(1) {
+  VkCommandPoolCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  info.queueFamilyIndex = Canvas::GetQueueFamilyIndex();
+  VkResult err = vkCreateCommandPool(Canvas::GetDevice(), &info, nullptr, &m_CommandPool);
+  check_vk_result(err);
+}
+
+/**
+ * @brief Destroys the ReadbackQueue, abandoning readbacks that have not completed.
+ */
+ReadbackQueue::~ReadbackQueue() {
+  VkDevice device = Canvas::GetDevice();
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Converted.wait(lock, [this]() {
+    return std::none_of(m_Entries.begin(), m_Entries.end(), [](const auto& entry) {
+      return entry->State == EntryState::Converting;
+    });
+  });
+
+  // Copies may still be executing, wait for them before freeing their buffers.
+  for (auto& entry : m_Entries) {
+    if (entry->State == EntryState::Copying)
+      Canvas::WaitForTimelineValue(entry->CopyValue);
+    DestroyEntry(*entry);
+  }
+  m_Entries.clear();
+
+  vkDestroyCommandPool(device, m_CommandPool, nullptr);
+}
+
+/**
+ * @brief Checks if pixels read from one format can be returned in another.
+ * @param source The format of the image.
+ * @param destination The requested format.
+ * @return True if the conversion is supported.
+ */
+bool ReadbackQueue::IsConversionSupported(ImageFormat source, ImageFormat destination) {
+  if (source == destination)
+    return source != ImageFormat::None;
+
+  switch (destination) {
+    case ImageFormat::RGBA:
+      return source == ImageFormat::BGRA8 || source == ImageFormat::RGBA16F ||
+             source == ImageFormat::RGBA32F;
+    case ImageFormat::BGRA8:
+      return source == ImageFormat::RGBA;
+    case ImageFormat::RGBA16F:
+      return source == ImageFormat::RGBA32F;
+    case ImageFormat::RGBA32F:
+      return source == ImageFormat::RGBA16F;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Records a copy of an image region into host memory, submitted after the frame.
+ * @param image The image to read.
+ * @param image_format The format of the image.
+ * @param region The region to read.
+ * @param format The format of the returned pixels.
+ * @return A future that receives the tightly packed pixels.
+ */
+std::future<ImageData> ReadbackQueue::Submit(
+    VkImage image, ImageFormat image_format, const ImageRegion& region, ImageFormat format) {
+  if (!IsConversionSupported(image_format, format))
+    throw std::runtime_error("Unsupported image format conversion");
+
+  const uint64_t size =
+      (uint64_t)region.Width * region.Height * Image::GetBytesPerPixel(image_format);
+  Entry* entry = AcquireEntry(size);
+  entry->Width = region.Width;
+  entry->Height = region.Height;
+  entry->SourceFormat = image_format;
+  entry->Format = format;
+  entry->Promise = std::make_shared<std::promise<ImageData>>();
+  entry->LastUsedFrame = Canvas::GetFrameCount();
+  std::future<ImageData> future = entry->Promise->get_future();
+
+  VkResult err;
+  VkCommandBuffer command_buffer = entry->CommandBuffer;
+
+  {
+    err = vkResetCommandBuffer(command_buffer, 0);
+    check_vk_result(err);
+    VkCommandBufferBeginInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    err = vkBeginCommandBuffer(command_buffer, &info);
+    check_vk_result(err);
+  }
+
+  VkImageMemoryBarrier copy_barrier = {};
+  copy_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  copy_barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+  copy_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  copy_barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  copy_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  copy_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  copy_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  copy_barrier.image = image;
+  copy_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  copy_barrier.subresourceRange.levelCount = 1;
+  copy_barrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(command_buffer,
+      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      0,
+      NULL,
+      0,
+      NULL,
+      1,
+      &copy_barrier);
+
+  VkBufferImageCopy copy = {};
+  copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  copy.imageSubresource.layerCount = 1;
+  copy.imageOffset.x = (int32_t)region.X;
+  copy.imageOffset.y = (int32_t)region.Y;
+  copy.imageExtent.width = region.Width;
+  copy.imageExtent.height = region.Height;
+  copy.imageExtent.depth = 1;
+  vkCmdCopyImageToBuffer(
+      command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, entry->Buffer, 1, &copy);
+
+  // Make the copy visible to the host once the timeline value is reached.
+  VkBufferMemoryBarrier host_barrier = {};
+  host_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  host_barrier.buffer = entry->Buffer;
+  host_barrier.size = VK_WHOLE_SIZE;
+
+  VkImageMemoryBarrier use_barrier = copy_barrier;
+  use_barrier.srcAccessMask = 0;
+  use_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  use_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  use_barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(command_buffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      0,
+      0,
+      NULL,
+      1,
+      &host_barrier,
+      1,
+      &use_barrier);
+
+  err = vkEndCommandBuffer(command_buffer);
+  check_vk_result(err);
+
+  // Submitted in Update, after the frame that writes the image.
+  entry->State = EntryState::Recorded;
+  return future;
+}
+
+/**
+ * @brief Submits recorded copies, hands completed ones to the worker and trims the buffer pool.
+ */
+void ReadbackQueue::Update() {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  uint64_t idle_bytes = 0;
+  for (auto& entry : m_Entries) {
+    // Submit without waiting, the timeline value is polled in the following updates.
+    if (entry->State == EntryState::Recorded) {
+      VkSubmitInfo info = {};
+      info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+      info.commandBufferCount = 1;
+      info.pCommandBuffers = &entry->CommandBuffer;
+      entry->CopyValue = Canvas::SubmitToQueue(info);
+      entry->State = EntryState::Copying;
+      continue;
+    }
+
+    if (entry->State == EntryState::Copying &&
+        Canvas::IsTimelineValueComplete(entry->CopyValue)) {
+      entry->State = EntryState::Converting;
+      m_Workers.Submit([this, pointer = entry.get()]() { Convert(pointer); });
+    }
+    if (entry->State == EntryState::Available)
+      idle_bytes += entry->Capacity;
+  }
+
+  // Free the least recently used idle buffers until the pool fits its budget.
+  while (idle_bytes > m_PoolBudget) {
+    auto oldest = m_Entries.end();
+    for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it) {
+      if ((*it)->State == EntryState::Available &&
+          (oldest == m_Entries.end() || (*it)->LastUsedFrame < (*oldest)->LastUsedFrame))
+        oldest = it;
+    }
+    idle_bytes -= (*oldest)->Capacity;
+    DestroyEntry(**oldest);
+    m_Entries.erase(oldest);
+  }
+}
+
+/**
+ * @brief Gets the number of readbacks that have not been fulfilled yet.
+ * @return The number of pending readbacks.
+ */
+size_t ReadbackQueue::GetPendingCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return (size_t)std::count_if(m_Entries.begin(), m_Entries.end(), [](const auto& entry) {
+    return entry->State != EntryState::Available;
+  });
+}
+
+/**
+ * @brief Gets an available entry with at least the requested capacity, creating one if needed.
+ * @param size The number of bytes needed.
+ * @return The entry.
+ */
+ReadbackQueue::Entry* ReadbackQueue::AcquireEntry(uint64_t size) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    // Best fit, so small readbacks do not hold on to large buffers.
+    Entry* best = nullptr;
+    for (auto& entry : m_Entries) {
+      if (entry->State == EntryState::Available && entry->Capacity >= size &&
+          (!best || entry->Capacity < best->Capacity))
+        best = entry.get();
+    }
+    if (best) {
+      best->State = EntryState::Recorded;
+      return best;
+    }
+  }
+
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+  auto entry = std::make_unique<Entry>();
+  entry->Capacity = size;
+
+  // Create the Readback Buffer, mapped for the lifetime of the entry.
+  {
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    err = vkCreateBuffer(device, &buffer_info, nullptr, &entry->Buffer);
+    check_vk_result(err);
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(device, entry->Buffer, &req);
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = req.size;
+
+    // Reading uncached memory from the CPU is slow, prefer cached memory where it exists.
+    VkMemoryPropertyFlags flags = 0;
+    alloc_info.memoryTypeIndex = Utils::GetReadbackMemoryType(
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+        req.memoryTypeBits,
+        flags);
+    if (alloc_info.memoryTypeIndex == 0xffffffff) {
+      alloc_info.memoryTypeIndex = Utils::GetReadbackMemoryType(
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+          req.memoryTypeBits,
+          flags);
+    }
+    if (alloc_info.memoryTypeIndex == 0xffffffff)
+      throw std::runtime_error("Failed to find a suitable memory type!");
+    entry->Coherent = (flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+    err = vkAllocateMemory(device, &alloc_info, nullptr, &entry->Memory);
+    check_vk_result(err);
+    err = vkBindBufferMemory(device, entry->Buffer, entry->Memory, 0);
+    check_vk_result(err);
+    err = vkMapMemory(device, entry->Memory, 0, VK_WHOLE_SIZE, 0, (void**)&entry->Mapped);
+    check_vk_result(err);
+  }
+
+  // Create the Copy Command Buffer
+  {
+    VkCommandBufferAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    info.commandPool = m_CommandPool;
+    info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    info.commandBufferCount = 1;
+    err = vkAllocateCommandBuffers(device, &info, &entry->CommandBuffer);
+    check_vk_result(err);
+  }
+
+  entry->State = EntryState::Recorded;
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Entries.push_back(std::move(entry));
+  return m_Entries.back().get();
+}
+
+/**
+ * @brief Destroys the Vulkan objects of an entry.
+ * @param entry The entry.
+ */
+void ReadbackQueue::DestroyEntry(Entry& entry) {
+  VkDevice device = Canvas::GetDevice();
+  vkFreeCommandBuffers(device, m_CommandPool, 1, &entry.CommandBuffer);
+  vkDestroyBuffer(device, entry.Buffer, nullptr);
+  vkFreeMemory(device, entry.Memory, nullptr);
+}
+
+/**
+ * @brief Converts the copied pixels of an entry and fulfills its promise. Runs on a worker.
+ * @param entry The entry.
+ */
+void ReadbackQueue::Convert(Entry* entry) {
+  std::shared_ptr<std::promise<ImageData>> promise = std::move(entry->Promise);
+  try {
+    if (!entry->Coherent) {
+      VkMappedMemoryRange range = {};
+      range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+      range.memory = entry->Memory;
+      range.size = VK_WHOLE_SIZE;
+      VkResult err = vkInvalidateMappedMemoryRanges(Canvas::GetDevice(), 1, &range);
+      check_vk_result(err);
+    }
+
+    const size_t pixel_count = (size_t)entry->Width * entry->Height;
+    const size_t size = pixel_count * Image::GetBytesPerPixel(entry->Format);
+    std::shared_ptr<uint8_t> pixels(new uint8_t[size], std::default_delete<uint8_t[]>());
+
+    const uint8_t* source = entry->Mapped;
+    uint8_t* destination = pixels.get();
+    const ImageFormat from = entry->SourceFormat;
+    const ImageFormat to = entry->Format;
+    if (from == to) {
+      memcpy(destination, source, size);
+    } else if ((to == ImageFormat::RGBA && from == ImageFormat::BGRA8) ||
+               (to == ImageFormat::BGRA8 && from == ImageFormat::RGBA)) {
+      PixelConversion::SwizzleRB(source, destination, pixel_count);
+    } else if (to == ImageFormat::RGBA32F && from == ImageFormat::RGBA16F) {
+      PixelConversion::HalfToFloat((const uint16_t*)source, (float*)destination, pixel_count * 4);
+    } else if (to == ImageFormat::RGBA16F && from == ImageFormat::RGBA32F) {
+      PixelConversion::FloatToHalf((const float*)source, (uint16_t*)destination, pixel_count * 4);
+    } else if (to == ImageFormat::RGBA && from == ImageFormat::RGBA32F) {
+      PixelConversion::FloatToUnorm8((const float*)source, destination, pixel_count * 4);
+    } else if (to == ImageFormat::RGBA && from == ImageFormat::RGBA16F) {
+      // Expand one row at a time, so the intermediate floats stay in cache.
+      const size_t row_count = (size_t)entry->Width * 4;
+      std::vector<float> row(row_count);
+      for (uint32_t y = 0; y < entry->Height; y++) {
+        PixelConversion::HalfToFloat(
+            (const uint16_t*)source + y * row_count, row.data(), row_count);
+        PixelConversion::FloatToUnorm8(row.data(), destination + y * row_count, row_count);
+      }
+    }
+
+    ImageData data;
+    data.Width = entry->Width;
+    data.Height = entry->Height;
+    data.Format = to;
+    data.Pixels = std::shared_ptr<const uint8_t>(pixels, pixels.get());
+    promise->set_value(std::move(data));
+  } catch (...) {
+    promise->set_exception(std::current_exception());
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  entry->State = EntryState::Available;
+  m_Converted.notify_all();
+}
+
+}  // namespace Weaver
@@ -0,0 +1,155 @@
+/**
+ * @file ReadbackQueue.h
+ * @author B.G. Smit
+ * @brief Declares the queue that copies image contents back to the CPU without stalling.
+ *
+ * This file defines the `ReadbackQueue` class. A readback records a copy of an image region
+ * into a pooled host-visible buffer. The `Canvas` submits the copies after the frame, so they
+ * see the frame's uploads and compute work, and polls them once per frame without waiting;
+ * when one has completed, its pixels are converted to the requested format on a worker thread
+ * and the returned future is fulfilled.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef READBACK_QUEUE_H
+#define READBACK_QUEUE_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Image.h"
+#include "ThreadPool.h"
+
+namespace Weaver {
+
+/**
+ * @class ReadbackQueue
+ * @brief Copies image regions into host memory asynchronously.
+ * @details Owned by the `Canvas`, see `Canvas::GetReadbackQueue`. `Submit` and `Update` must be
+ * called from the main thread.
+ */
+class ReadbackQueue {
+ public:
+  /**
+   * @brief Constructs a new ReadbackQueue.
+   * @param pool_budget The number of bytes of idle host buffers kept for reuse.
+   */
+  explicit ReadbackQueue(uint64_t pool_budget);
+  /**
+   * @brief Destroys the ReadbackQueue. Readbacks that have not completed are abandoned, their
+   * futures report a broken promise.
+   */
+  ~ReadbackQueue();
+
+  ReadbackQueue(const ReadbackQueue&) = delete;
+  ReadbackQueue& operator=(const ReadbackQueue&) = delete;
+
+  /**
+   * @brief Records a copy of an image region into host memory, submitted after the frame.
+   * @details The image must be in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`, it is returned
+   * to that layout after the copy.
+   * @param image The image to read.
+   * @param image_format The format of the image.
+   * @param region The region to read, which must lie within the image.
+   * @param format The format of the returned pixels, see `IsConversionSupported`.
+   * @return A future that receives the tightly packed pixels.
+   */
+  std::future<ImageData> Submit(
+      VkImage image, ImageFormat image_format, const ImageRegion& region, ImageFormat format);
+
+  /**
+   * @brief Submits recorded copies, hands completed ones to the worker for conversion and trims
+   * the buffer pool.
+   * @details Called by the `Canvas` once per frame, after the frame has been submitted.
+   */
+  void Update();
+
+  /**
+   * @brief Checks if pixels read from one format can be returned in another.
+   * @details Identical formats, RGBA <-> BGRA8, RGBA16F <-> RGBA32F and RGBA16F / RGBA32F -> RGBA
+   * are supported.
+   * @param source The format of the image.
+   * @param destination The requested format.
+   * @return True if the conversion is supported.
+   */
+  static bool IsConversionSupported(ImageFormat source, ImageFormat destination);
+
+  /**
+   * @brief Gets the number of readbacks that have not been fulfilled yet.
+   * @return The number of pending readbacks.
+   */
+  size_t GetPendingCount() const;
+
+ private:
+  /**
+   * @enum EntryState
+   * @brief Where a pooled buffer is in its readback cycle.
+   */
+  enum class EntryState {
+    Available,  /**< Free to be used by a new readback. */
+    Recorded,   /**< The copy was recorded, it is submitted after the frame. */
+    Copying,    /**< The copy was submitted and may still be executing. */
+    Converting  /**< The copy completed, a worker is converting the pixels. */
+  };
+
+  /**
+   * @struct Entry
+   * @brief A pooled host buffer with the command buffer and timeline value of its copy.
+   */
+  struct Entry {
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    const uint8_t* Mapped = nullptr;
+    uint64_t Capacity = 0;
+    bool Coherent = true;
+    VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+    uint64_t CopyValue = 0;
+    EntryState State = EntryState::Available;
+    uint64_t LastUsedFrame = 0;
+
+    // The request being served.
+    uint32_t Width = 0, Height = 0;
+    ImageFormat SourceFormat = ImageFormat::None;
+    ImageFormat Format = ImageFormat::None;
+    std::shared_ptr<std::promise<ImageData>> Promise;
+  };
+
+  /**
+   * @brief Gets an available entry with at least the requested capacity, creating one if needed.
+   * @param size The number of bytes needed.
+   * @return The entry.
+   */
+  Entry* AcquireEntry(uint64_t size);
+  /**
+   * @brief Destroys the Vulkan objects of an entry.
+   * @param entry The entry.
+   */
+  void DestroyEntry(Entry& entry);
+  /**
+   * @brief Converts the copied pixels of an entry and fulfills its promise. Runs on a worker.
+   * @param entry The entry.
+   */
+  void Convert(Entry* entry);
+
+ private:
+  uint64_t m_PoolBudget = 0;
+  VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+  mutable std::mutex m_Mutex;
+  std::condition_variable m_Converted;
+  std::vector<std::unique_ptr<Entry>> m_Entries;
+
+  // Declared last so the workers are joined before the entries above are destroyed.
+  ThreadPool m_Workers;
+};
+
+}  // namespace Weaver
+
+#endif
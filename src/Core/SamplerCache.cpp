@@ -0,0 +1,115 @@
+/**
+ * @file SamplerCache.cpp
+ * @author B.G. Smit
+ * @brief Implements the cache that shares Vulkan samplers between images.
+ * @copyright Copyright (c) 2025
+ */
+#include "SamplerCache.h"
+
+#include <functional>
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+/**
+ * @brief Gets the specification of a preset.
+ * @param preset The preset.
+ * @return The sampler specification.
+ */
+SamplerSpecification SamplerSpecification::FromPreset(SamplerPreset preset) {
+  SamplerSpecification specification;
+  switch (preset) {
+    case SamplerPreset::Linear:
+      break;
+    case SamplerPreset::Nearest:
+      specification.Filter = VK_FILTER_NEAREST;
+      specification.MipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+      break;
+    case SamplerPreset::LinearClamp:
+      specification.AddressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+      break;
+    case SamplerPreset::NearestClamp:
+      specification.Filter = VK_FILTER_NEAREST;
+      specification.MipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+      specification.AddressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+      break;
+  }
+  return specification;
+}
+
+/**
+ * @brief Hashes a sampler specification.
+ * @param specification The specification to hash.
+ * @return The hash.
+ */
+size_t SamplerCache::Hash::operator()(const SamplerSpecification& specification) const {
+  size_t hash = std::hash<int>()(specification.Filter);
+  auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+  combine(std::hash<int>()(specification.MipmapMode));
+  combine(std::hash<int>()(specification.AddressMode));
+  combine(std::hash<float>()(specification.MaxAnisotropy));
+  combine(std::hash<float>()(specification.MinLod));
+  combine(std::hash<float>()(specification.MaxLod));
+  return hash;
+}
+
+/**
+ * @brief Destroys every sampler.
+ */
+SamplerCache::~SamplerCache() {
+  VkDevice device = Canvas::GetDevice();
+  for (const auto& [specification, sampler] : m_Samplers)
+    vkDestroySampler(device, sampler, nullptr);
+}
+
+/**
+ * @brief Gets the sampler for a specification, creating it on first use.
+ * @param specification The sampler settings.
+ * @return The Vulkan sampler.
+ */
+VkSampler SamplerCache::GetSampler(const SamplerSpecification& specification) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  VkSampler& sampler = m_Samplers[specification];
+  if (sampler != VK_NULL_HANDLE)
+    return sampler;
+
+  // The Canvas enables anisotropy whenever the device supports it, clamp to what it allows.
+  VkPhysicalDeviceFeatures features;
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceFeatures(Canvas::GetPhysicalDevice(), &features);
+  vkGetPhysicalDeviceProperties(Canvas::GetPhysicalDevice(), &properties);
+  float max_anisotropy = specification.MaxAnisotropy;
+  if (!features.samplerAnisotropy)
+    max_anisotropy = 1.0f;
+  else if (max_anisotropy > properties.limits.maxSamplerAnisotropy)
+    max_anisotropy = properties.limits.maxSamplerAnisotropy;
+
+  VkSamplerCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  info.magFilter = specification.Filter;
+  info.minFilter = specification.Filter;
+  info.mipmapMode = specification.MipmapMode;
+  info.addressModeU = specification.AddressMode;
+  info.addressModeV = specification.AddressMode;
+  info.addressModeW = specification.AddressMode;
+  info.anisotropyEnable = max_anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+  info.maxAnisotropy = max_anisotropy;
+  info.minLod = specification.MinLod;
+  info.maxLod = specification.MaxLod;
+  VkResult err = vkCreateSampler(Canvas::GetDevice(), &info, nullptr, &sampler);
+  check_vk_result(err);
+  return sampler;
+}
+
+/**
+ * @brief Gets the number of distinct samplers created.
+ * @return The number of samplers.
+ */
+size_t SamplerCache::GetSamplerCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Samplers.size();
+}
+
+}  // namespace Weaver
@@ -0,0 +1,117 @@
+/**
+ * @file SamplerCache.h
+ * @author B.G. Smit
+ * @brief Declares the cache that shares Vulkan samplers between images.
+ *
+ * This file defines the `SamplerSpecification` key, the `SamplerPreset` shortcuts used by
+ * `Image`, and the `SamplerCache` class, which creates one `VkSampler` per distinct
+ * specification and hands the same handle to every image that asks for it. Drivers limit
+ * the number of samplers that may exist at once, so images never own their sampler.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef SAMPLER_CACHE_H
+#define SAMPLER_CACHE_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace Weaver {
+
+/**
+ * @enum SamplerPreset
+ * @brief Common sampler configurations for images.
+ */
+enum class SamplerPreset {
+  Linear = 0,   /**< Bilinear filtering, repeating (the default). */
+  Nearest,      /**< Nearest filtering, repeating. Use for pixel-exact views. */
+  LinearClamp,  /**< Bilinear filtering, clamped to the edge. */
+  NearestClamp, /**< Nearest filtering, clamped to the edge. */
+};
+
+/**
+ * @struct SamplerSpecification
+ * @brief The settings that identify a sampler in the cache.
+ */
+struct SamplerSpecification {
+  VkFilter Filter = VK_FILTER_LINEAR; /**< The magnification and minification filter. */
+  VkSamplerMipmapMode MipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR; /**< The mipmap filter. */
+  VkSamplerAddressMode AddressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT; /**< U, V and W addressing. */
+  float MaxAnisotropy = 1.0f; /**< Values above one enable anisotropic filtering. */
+  float MinLod = -1000.0f;    /**< The minimum level of detail. */
+  float MaxLod = 1000.0f;     /**< The maximum level of detail. */
+
+  /**
+   * @brief Gets the specification of a preset.
+   * @param preset The preset.
+   * @return The sampler specification.
+   */
+  static SamplerSpecification FromPreset(SamplerPreset preset);
+
+  bool operator==(const SamplerSpecification& other) const {
+    return Filter == other.Filter && MipmapMode == other.MipmapMode &&
+           AddressMode == other.AddressMode && MaxAnisotropy == other.MaxAnisotropy &&
+           MinLod == other.MinLod && MaxLod == other.MaxLod;
+  }
+};
+
+/**
+ * @class SamplerCache
+ * @brief Interns Vulkan samplers by specification for the lifetime of the device.
+ * @details Owned by the `Canvas`, see `Canvas::GetSamplerCache`. Thread-safe.
+ */
+class SamplerCache {
+ public:
+  SamplerCache() = default;
+  /**
+   * @brief Destroys every sampler. The device must be idle.
+   */
+  ~SamplerCache();
+
+  SamplerCache(const SamplerCache&) = delete;
+  SamplerCache& operator=(const SamplerCache&) = delete;
+
+  /**
+   * @brief Gets the sampler for a specification, creating it on first use.
+   * @details The sampler is shared, it must not be destroyed by the caller.
+   * @param specification The sampler settings.
+   * @return The Vulkan sampler.
+   */
+  VkSampler GetSampler(const SamplerSpecification& specification);
+
+  /**
+   * @brief Gets the sampler for a preset, creating it on first use.
+   * @param preset The preset.
+   * @return The Vulkan sampler.
+   */
+  VkSampler GetSampler(SamplerPreset preset) {
+    return GetSampler(SamplerSpecification::FromPreset(preset));
+  }
+
+  /**
+   * @brief Gets the number of distinct samplers created.
+   * @return The number of samplers.
+   */
+  size_t GetSamplerCount() const;
+
+ private:
+  /**
+   * @struct Hash
+   * @brief Hashes a sampler specification.
+   */
+  struct Hash {
+    size_t operator()(const SamplerSpecification& specification) const;
+  };
+
+ private:
+  mutable std::mutex m_Mutex;
+  std::unordered_map<SamplerSpecification, VkSampler, Hash> m_Samplers;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,350 @@
+/**
+ * @file StreamingImage.cpp
+ * @author B.G. Smit
+ * @brief Implements the multi-buffered image for content generated on the CPU every frame.
+ * @copyright Copyright (c) 2025
+ */
+#include "StreamingImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief Gets the Vulkan memory type index for a given memory type and properties.
+ * @param properties The memory properties.
+ * @param type_bits The memory type bits.
+ * @return The memory type index.
+ */
+static uint32_t GetStreamingMemoryType(VkMemoryPropertyFlags properties, uint32_t type_bits) {
+  VkPhysicalDeviceMemoryProperties prop;
+  vkGetPhysicalDeviceMemoryProperties(Canvas::GetPhysicalDevice(), &prop);
+  for (uint32_t i = 0; i < prop.memoryTypeCount; i++) {
+    if ((prop.memoryTypes[i].propertyFlags & properties) == properties && type_bits & (1 << i))
+      return i;
+  }
+
+  return 0xffffffff;
+}
+
+/**
+ * @brief Records a layout transition of a whole color image.
+ * @param command_buffer The command buffer to record into.
+ * @param image The image to transition.
+ * @param old_layout The current layout, or `VK_IMAGE_LAYOUT_UNDEFINED` to discard the contents.
+ * @param new_layout The new layout.
+ * @param src_stage The stages that must finish before the transition.
+ * @param dst_stage The stages that wait for the transition.
+ * @param src_access The writes to make available.
+ * @param dst_access The accesses the new layout is used for.
+ */
+static void TransitionImage(VkCommandBuffer command_buffer,
+    VkImage image,
+    VkImageLayout old_layout,
+    VkImageLayout new_layout,
+    VkPipelineStageFlags src_stage,
+    VkPipelineStageFlags dst_stage,
+    VkAccessFlags src_access,
+    VkAccessFlags dst_access) {
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = src_access;
+  barrier.dstAccessMask = dst_access;
+  barrier.oldLayout = old_layout;
+  barrier.newLayout = new_layout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.layerCount = 1;
+  vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new StreamingImage.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @param format The format of the image.
+ * @param slot_count The number of backing textures, zero to pick one automatically.
+ */
+StreamingImage::StreamingImage(
+    uint32_t width, uint32_t height, ImageFormat format, uint32_t slot_count)
+    : m_Width(width),
+      m_Height(height),
+      m_Format(format) {
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+
+  if (slot_count == 0)
+    slot_count = Canvas::GetFramesInFlight() + 2;
+  m_UploadSize = (size_t)m_Width * m_Height * Image::GetBytesPerPixel(m_Format);
+
+  // Create the Command Pool, the slots record their uploads independently of the frame.
+  {
+    VkCommandPoolCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    info.queueFamilyIndex = Canvas::GetQueueFamilyIndex();
+    err = vkCreateCommandPool(device, &info, nullptr, &m_CommandPool);
+    check_vk_result(err);
+  }
+
+  m_Slots.resize(slot_count);
+  for (Slot& slot : m_Slots) {
+    slot.Texture = std::make_unique<Image>(m_Width, m_Height, m_Format);
+
+    // Create the Upload Buffer, mapped for the lifetime of the slot.
+    {
+      VkBufferCreateInfo buffer_info = {};
+      buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      buffer_info.size = m_UploadSize;
+      buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+      buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+      err = vkCreateBuffer(device, &buffer_info, nullptr, &slot.StagingBuffer);
+      check_vk_result(err);
+      VkMemoryRequirements req;
+      vkGetBufferMemoryRequirements(device, slot.StagingBuffer, &req);
+      VkMemoryAllocateInfo alloc_info = {};
+      alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+      alloc_info.allocationSize = req.size;
+      alloc_info.memoryTypeIndex = Utils::GetStreamingMemoryType(
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+          req.memoryTypeBits);
+      if (alloc_info.memoryTypeIndex == 0xffffffff)
+        throw std::runtime_error("Failed to find a suitable memory type!");
+      err = vkAllocateMemory(device, &alloc_info, nullptr, &slot.StagingMemory);
+      check_vk_result(err);
+      err = vkBindBufferMemory(device, slot.StagingBuffer, slot.StagingMemory, 0);
+      check_vk_result(err);
+      err = vkMapMemory(
+          device, slot.StagingMemory, 0, VK_WHOLE_SIZE, 0, (void**)&slot.MappedStaging);
+      check_vk_result(err);
+    }
+
+    // Create the Upload Command Buffer
+    {
+      VkCommandBufferAllocateInfo info = {};
+      info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      info.commandPool = m_CommandPool;
+      info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      info.commandBufferCount = 1;
+      err = vkAllocateCommandBuffers(device, &info, &slot.CommandBuffer);
+      check_vk_result(err);
+    }
+  }
+
+  // Clear every slot once, so each can be displayed before its first upload completes.
+  {
+    VkCommandBuffer command_buffer = Canvas::GetCommandBuffer(true);
+    VkClearColorValue clear = {};
+    VkImageSubresourceRange range = {};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.levelCount = 1;
+    range.layerCount = 1;
+
+    for (Slot& slot : m_Slots) {
+      VkImage image = slot.Texture->GetVulkanImage();
+      Utils::TransitionImage(command_buffer,
+          image,
+          VK_IMAGE_LAYOUT_UNDEFINED,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          0,
+          VK_ACCESS_TRANSFER_WRITE_BIT);
+      vkCmdClearColorImage(
+          command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear, 1, &range);
+      Utils::TransitionImage(command_buffer,
+          image,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+          VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_ACCESS_SHADER_READ_BIT);
+    }
+
+    Canvas::FlushCommandBuffer(command_buffer);
+  }
+
+  m_Slots[0].State = SlotState::Displayed;
+}
+
+/**
+ * @brief Destroys the StreamingImage, freeing its resources once the GPU is done with them.
+ */
+StreamingImage::~StreamingImage() {
+  std::vector<VkBuffer> buffers;
+  std::vector<VkDeviceMemory> memories;
+  for (const Slot& slot : m_Slots) {
+    buffers.push_back(slot.StagingBuffer);
+    memories.push_back(slot.StagingMemory);
+  }
+
+  // Uploads may still be executing, wait for them before freeing their buffers. The textures
+  // are released by their own destructors after this free has been queued.
+  uint64_t pending = 0;
+  for (const Slot& slot : m_Slots) {
+    if (slot.State == SlotState::Uploading)
+      pending = std::max(pending, slot.UploadValue);
+  }
+
+  Canvas::SubmitResourceFree([pending, buffers, memories, pool = m_CommandPool]() {
+    VkDevice device = Canvas::GetDevice();
+
+    Canvas::WaitForTimelineValue(pending);
+    for (VkBuffer buffer : buffers)
+      vkDestroyBuffer(device, buffer, nullptr);
+    for (VkDeviceMemory memory : memories)
+      vkFreeMemory(device, memory, nullptr);
+    vkDestroyCommandPool(device, pool, nullptr);
+  });
+}
+
+/**
+ * @brief Uploads new pixels without waiting for the GPU.
+ * @param data A pointer to the pixels.
+ * @return True if the pixels were submitted, false if the frame was dropped.
+ */
+bool StreamingImage::SetData(const void* data) {
+  const size_t upload_size = m_UploadSize;
+  return WriteData(
+      [data, upload_size](uint8_t* destination) { memcpy(destination, data, upload_size); });
+}
+
+/**
+ * @brief Uploads new pixels by writing them directly into a free staging buffer.
+ * @param writer Called with the staging memory to fill.
+ * @return True if the pixels were submitted, false if the frame was dropped.
+ */
+bool StreamingImage::WriteData(const std::function<void(uint8_t* destination)>& writer) {
+  Update();
+
+  // Prefer the oldest free slot, so retired slots get as much time as possible.
+  Slot* target = nullptr;
+  for (Slot& slot : m_Slots) {
+    if (slot.State == SlotState::Available && (!target || slot.Sequence < target->Sequence))
+      target = &slot;
+  }
+  if (!target) {
+    m_DroppedFrames++;
+    return false;
+  }
+
+  writer(target->MappedStaging);
+
+  VkResult err;
+  VkCommandBuffer command_buffer = target->CommandBuffer;
+  VkImage image = target->Texture->GetVulkanImage();
+
+  {
+    err = vkResetCommandBuffer(command_buffer, 0);
+    check_vk_result(err);
+    VkCommandBufferBeginInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    info.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    err = vkBeginCommandBuffer(command_buffer, &info);
+    check_vk_result(err);
+  }
+
+  // The previous contents are discarded, no frame samples an available slot.
+  Utils::TransitionImage(command_buffer,
+      image,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      VK_PIPELINE_STAGE_HOST_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      VK_ACCESS_TRANSFER_WRITE_BIT);
+
+  VkBufferImageCopy region = {};
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.layerCount = 1;
+  region.imageExtent.width = m_Width;
+  region.imageExtent.height = m_Height;
+  region.imageExtent.depth = 1;
+  vkCmdCopyBufferToImage(command_buffer,
+      target->StagingBuffer,
+      image,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      1,
+      &region);
+
+  Utils::TransitionImage(command_buffer,
+      image,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_SHADER_READ_BIT);
+
+  err = vkEndCommandBuffer(command_buffer);
+  check_vk_result(err);
+
+  // Submit without waiting, the timeline value is polled in Update.
+  {
+    VkSubmitInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    info.commandBufferCount = 1;
+    info.pCommandBuffers = &command_buffer;
+    target->UploadValue = Canvas::SubmitToQueue(info);
+  }
+
+  target->State = SlotState::Uploading;
+  target->Sequence = ++m_Sequence;
+  return true;
+}
+
+/**
+ * @brief Gets the descriptor set of the newest completed upload.
+ * @return The Vulkan descriptor set.
+ */
+VkDescriptorSet StreamingImage::GetDescriptorSet() {
+  Update();
+
+  Slot& displayed = m_Slots[m_DisplayedSlot];
+  displayed.LastDrawnFrame = Canvas::GetFrameCount();
+  return displayed.Texture->GetDescriptorSet();
+}
+
+/**
+ * @brief Collects finished uploads and swaps the newest one in for display.
+ */
+void StreamingImage::Update() {
+  Slot* newest = nullptr;
+  for (Slot& slot : m_Slots) {
+    if (slot.State == SlotState::Uploading && Canvas::IsTimelineValueComplete(slot.UploadValue))
+      slot.State = SlotState::Uploaded;
+    if (slot.State == SlotState::Retired && Canvas::IsFrameComplete(slot.LastDrawnFrame))
+      slot.State = SlotState::Available;
+
+    if (slot.State == SlotState::Uploaded && (!newest || slot.Sequence > newest->Sequence))
+      newest = &slot;
+  }
+
+  if (!newest)
+    return;
+
+  Slot& displayed = m_Slots[m_DisplayedSlot];
+  displayed.State = SlotState::Retired;
+  newest->State = SlotState::Displayed;
+  m_DisplayedSlot = (size_t)(newest - m_Slots.data());
+
+  // Completed uploads that were overtaken by a newer one were never drawn and are free again.
+  for (Slot& slot : m_Slots) {
+    if (slot.State == SlotState::Uploaded)
+      slot.State = SlotState::Available;
+  }
+}
+
+}  // namespace Weaver
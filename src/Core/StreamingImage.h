@@ -0,0 +1,154 @@
+/**
+ * @file StreamingImage.h
+ * @author B.G. Smit
+ * @brief Declares a multi-buffered image for content generated on the CPU every frame.
+ *
+ * This file defines the `StreamingImage` class. Unlike `Image::SetData`, which waits for
+ * each upload to finish, a streaming image cycles through several textures and staging
+ * buffers: new pixels go into a slot the GPU is not using, the upload is submitted without
+ * waiting, and the image shows the newest slot whose upload has completed.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef STREAMING_IMAGE_H
+#define STREAMING_IMAGE_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Image.h"
+
+namespace Weaver {
+
+/**
+ * @class StreamingImage
+ * @brief An image that is re-uploaded every frame without blocking the CPU on the GPU.
+ * @details Must be used from the main thread.
+ */
+class StreamingImage {
+ public:
+  /**
+   * @brief Constructs a new StreamingImage.
+   * @param width The width of the image.
+   * @param height The height of the image.
+   * @param format The format of the image.
+   * @param slot_count The number of backing textures. Zero picks the number of frames in flight
+   * plus two, which is enough to never drop a frame at one write per frame.
+   */
+  StreamingImage(uint32_t width, uint32_t height, ImageFormat format, uint32_t slot_count = 0);
+  /**
+   * @brief Destroys the StreamingImage, freeing its resources once the GPU is done with them.
+   */
+  ~StreamingImage();
+
+  StreamingImage(const StreamingImage&) = delete;
+  StreamingImage& operator=(const StreamingImage&) = delete;
+
+  /**
+   * @brief Uploads new pixels without waiting for the GPU.
+   * @param data A pointer to `GetWidth() * GetHeight()` tightly packed pixels of the image format.
+   * @return True if the pixels were submitted, false if every slot is busy and the frame was
+   * dropped.
+   */
+  bool SetData(const void* data);
+
+  /**
+   * @brief Uploads new pixels by writing them directly into a free staging buffer.
+   * @param writer Called with the staging memory, which must be filled with
+   * `GetWidth() * GetHeight()` tightly packed pixels of the image format.
+   * @return True if the pixels were submitted, false if every slot is busy and the frame was
+   * dropped.
+   */
+  bool WriteData(const std::function<void(uint8_t* destination)>& writer);
+
+  /**
+   * @brief Gets the descriptor set of the newest completed upload.
+   * @details Call this every frame the image is drawn, it also swaps in finished uploads.
+   * @return The Vulkan descriptor set.
+   */
+  VkDescriptorSet GetDescriptorSet();
+
+  /**
+   * @brief Gets the width of the image.
+   * @return The width of the image.
+   */
+  uint32_t GetWidth() const {
+    return m_Width;
+  }
+  /**
+   * @brief Gets the height of the image.
+   * @return The height of the image.
+   */
+  uint32_t GetHeight() const {
+    return m_Height;
+  }
+  /**
+   * @brief Gets the format of the image.
+   * @return The format of the image.
+   */
+  ImageFormat GetFormat() const {
+    return m_Format;
+  }
+  /**
+   * @brief Gets the number of writes dropped because every slot was busy.
+   * @return The number of dropped frames.
+   */
+  uint64_t GetDroppedFrameCount() const {
+    return m_DroppedFrames;
+  }
+
+ private:
+  /**
+   * @enum SlotState
+   * @brief Where a slot is in its upload and display cycle.
+   */
+  enum class SlotState {
+    Available, /**< Free to be written. */
+    Uploading, /**< An upload was submitted and may still be executing. */
+    Uploaded,  /**< The upload has completed, waiting to be displayed. */
+    Displayed, /**< The slot is the one being drawn. */
+    Retired    /**< Replaced, but frames still in flight may sample it. */
+  };
+
+  /**
+   * @struct Slot
+   * @brief A backing texture with its own staging buffer and upload command buffer.
+   */
+  struct Slot {
+    std::unique_ptr<Image> Texture;
+    VkBuffer StagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory StagingMemory = VK_NULL_HANDLE;
+    uint8_t* MappedStaging = nullptr;
+    VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+    uint64_t UploadValue = 0;  /**< The timeline value of the last upload, see `GpuTimeline`. */
+    SlotState State = SlotState::Available;
+    uint64_t Sequence = 0;  /**< Orders uploads, higher is newer. */
+    uint64_t LastDrawnFrame = 0;
+  };
+
+  /**
+   * @brief Collects finished uploads and swaps the newest one in for display.
+   */
+  void Update();
+
+ private:
+  uint32_t m_Width = 0, m_Height = 0;
+  ImageFormat m_Format = ImageFormat::None;
+  size_t m_UploadSize = 0;
+
+  VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+  std::vector<Slot> m_Slots;
+  size_t m_DisplayedSlot = 0;
+
+  uint64_t m_Sequence = 0;
+  uint64_t m_DroppedFrames = 0;
+};
+
+}  // namespace Weaver
+
+#endif
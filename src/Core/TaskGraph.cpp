@@ -0,0 +1,212 @@
+/**
+ * @file TaskGraph.cpp
+ * @author B.G. Smit
+ * @brief Implements the reusable graph of dependent tasks.
+ * @copyright Copyright (c) 2025
+ */
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Profiler.h"
+
+namespace Weaver {
+
+/**
+ * @brief Constructs a new TaskGraph.
+ * @param name The name of the graph.
+ */
+TaskGraph::TaskGraph(std::string name) : m_Name(std::move(name)) {}
+
+/**
+ * @brief Adds a task.
+ * @param name The name of the task, which is also the name of its profiler scope.
+ * @param func The work of the task, run on a worker thread.
+ * @param dependencies Tasks that must finish first.
+ * @param skippable Whether the task, and the tasks that depend on it, may be skipped when it
+ * would start after the deadline.
+ * @return The id of the task.
+ */
+TaskGraph::TaskId TaskGraph::AddTask(std::string name,
+    std::function<void()> func,
+    const std::vector<TaskId>& dependencies,
+    bool skippable) {
+  if (m_Running)
+    throw std::logic_error("TaskGraph: cannot add a task while the graph runs");
+  const TaskId id = (TaskId)m_Tasks.size();
+  for (TaskId dependency : dependencies) {
+    if (dependency >= id)
+      throw std::invalid_argument("TaskGraph: a task can only depend on earlier tasks");
+  }
+
+  Task task;
+  task.Name = std::move(name);
+  // Interned once here, as profiles may be exported after the graph is gone.
+  task.ProfileName = Profiler::Intern(task.Name);
+  task.Func = std::move(func);
+  task.Dependencies = dependencies;
+  task.Skippable = skippable;
+  m_Tasks.push_back(std::move(task));
+  return id;
+}
+
+/**
+ * @brief Removes every task.
+ */
+void TaskGraph::Clear() {
+  if (m_Running)
+    throw std::logic_error("TaskGraph: cannot clear the graph while it runs");
+  m_Tasks.clear();
+  m_Timings.clear();
+  m_Spans.clear();
+  m_Duration = 0.0f;
+  m_SkippedCount = 0;
+}
+
+/**
+ * @brief Starts running the graph without waiting for it.
+ * @param jobs The job system to run the tasks on.
+ * @param deadline The time after which skippable tasks are not started.
+ */
+void TaskGraph::Start(JobSystem& jobs, TimePoint deadline) {
+  if (m_Running)
+    throw std::logic_error("TaskGraph: the graph is already running");
+  m_Running = true;
+  m_RunStart = Clock::Now();
+  m_Deadline = deadline;
+  m_Errors.assign(m_Tasks.size(), nullptr);
+  m_RunTimings.assign(m_Tasks.size(), TaskTiming());
+  m_RunSpans.assign(m_Tasks.size(), {0, 0});
+  m_Handles.resize(m_Tasks.size());
+
+  // Dependencies always precede a task, so their handles exist when it is scheduled.
+  std::vector<JobHandle> dependencies;
+  for (TaskId id = 0; id < (TaskId)m_Tasks.size(); id++) {
+    dependencies.clear();
+    for (TaskId dependency : m_Tasks[id].Dependencies)
+      dependencies.push_back(m_Handles[dependency]);
+    m_Handles[id] = jobs.Schedule([this, id]() { Execute(id); }, dependencies);
+  }
+}
+
+/**
+ * @brief Waits for the run started with `Start`, executing other jobs meanwhile.
+ * @param jobs The job system passed to `Start`.
+ */
+void TaskGraph::Wait(JobSystem& jobs) {
+  if (!m_Running)
+    return;
+  for (const JobHandle& handle : m_Handles)
+    jobs.Wait(handle);
+  m_Running = false;
+
+  m_Timings.swap(m_RunTimings);
+  m_Spans.swap(m_RunSpans);
+  m_Duration = ToRunTime(Clock::Now());
+  m_SkippedCount = (uint32_t)std::count_if(
+      m_Timings.begin(), m_Timings.end(), [](const TaskTiming& timing) { return timing.Skipped; });
+#ifdef WEAVER_ENABLE_PROFILING
+  if (Profiler::IsActive())
+    RecordCriticalPath();
+#endif
+
+  for (std::exception_ptr& error : m_Errors) {
+    if (error) {
+      std::exception_ptr first = error;
+      m_Errors.assign(m_Errors.size(), nullptr);
+      std::rethrow_exception(first);
+    }
+  }
+}
+
+/**
+ * @brief Gets the chain of tasks that determined the duration of the last completed run.
+ * @details Starts at the task that finished last and follows the dependency that finished last,
+ * as that is the one the task was waiting for.
+ * @return The ids of the tasks, from the first to the last.
+ */
+std::vector<TaskGraph::TaskId> TaskGraph::GetCriticalPath() const {
+  std::vector<TaskId> path;
+  if (m_Timings.size() != m_Tasks.size())
+    return path;
+
+  auto latest = [this](const std::vector<TaskId>& candidates, TaskId& result) {
+    bool found = false;
+    for (TaskId id : candidates) {
+      if (!m_Timings[id].Skipped && (!found || m_Timings[id].End > m_Timings[result].End)) {
+        result = id;
+        found = true;
+      }
+    }
+    return found;
+  };
+
+  std::vector<TaskId> all(m_Tasks.size());
+  for (TaskId id = 0; id < (TaskId)all.size(); id++)
+    all[id] = id;
+  TaskId current = 0;
+  if (!latest(all, current))
+    return path;
+
+  path.push_back(current);
+  while (latest(m_Tasks[current].Dependencies, current))
+    path.push_back(current);
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+/**
+ * @brief Runs one task of the current run, or skips it.
+ * @param task The id of the task.
+ */
+void TaskGraph::Execute(TaskId task) {
+  TaskTiming& timing = m_RunTimings[task];
+  const Task& definition = m_Tasks[task];
+
+  // Tasks whose inputs were not produced do not run either.
+  for (TaskId dependency : definition.Dependencies) {
+    if (m_RunTimings[dependency].Skipped || m_Errors[dependency]) {
+      timing.Skipped = true;
+      return;
+    }
+  }
+  if (definition.Skippable && std::chrono::steady_clock::now() > m_Deadline) {
+    timing.Skipped = true;
+    return;
+  }
+
+  auto& span = m_RunSpans[task];
+  span.first = Clock::Now();
+  try {
+    WEAVER_PROFILE_SCOPE(definition.ProfileName);
+    definition.Func();
+  } catch (...) {
+    m_Errors[task] = std::current_exception();
+  }
+  span.second = Clock::Now();
+  timing.Start = ToRunTime(span.first);
+  timing.End = ToRunTime(span.second);
+}
+
+/**
+ * @brief Converts `Clock` ticks to milliseconds since the start of the current run.
+ * @param ticks The ticks.
+ * @return The time in milliseconds.
+ */
+float TaskGraph::ToRunTime(Clock::Ticks ticks) const {
+  return (float)(Clock::ToNanoseconds(ticks - m_RunStart) * 1e-6);
+}
+
+/**
+ * @brief Records the critical path of the last completed run on the graph's profiler track.
+ */
+void TaskGraph::RecordCriticalPath() {
+  // Graphs are waited for on the main thread, so the track is never written concurrently.
+  const uint32_t track = Profiler::GetTrack(m_Name + " Critical Path");
+  for (TaskId task : GetCriticalPath())
+    Profiler::RecordSpan(track, m_Tasks[task].ProfileName, m_Spans[task].first,
+        m_Spans[task].second);
+}
+
+}  // namespace Weaver
@@ -0,0 +1,214 @@
+/**
+ * @file TaskGraph.h
+ * @author B.G. Smit
+ * @brief Declares a reusable graph of dependent tasks executed on the job system.
+ *
+ * This file defines the `TaskGraph` class. A layer builds its graph once (for example
+ * "ingest -> aggregate -> build plot buffers") and submits it every frame from `OnUpdate` with
+ * `Canvas::SubmitTaskGraph`. The canvas starts all submitted graphs together, so independent
+ * tasks of all layers run in parallel, and joins them before `OnUIRender`. Tasks marked as
+ * skippable are dropped when they would start after the frame deadline. The timings of the last
+ * run and its critical path are kept. With profiling enabled every task is a scope in the
+ * profile, and the critical path of each run is recorded on a track of its own.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Clock.h"
+#include "JobSystem.h"
+
+namespace Weaver {
+
+/**
+ * @class TaskGraph
+ * @brief A directed acyclic graph of tasks that is built once and run many times.
+ * @details The graph may not be changed while it runs. A task only depends on tasks added
+ * before it, which keeps the graph acyclic.
+ */
+class TaskGraph {
+ public:
+  using TaskId = uint32_t;
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  /**
+   * @struct TaskTiming
+   * @brief When a task ran during the last run, relative to its start.
+   */
+  struct TaskTiming {
+    float Start = 0.0f; /**< Milliseconds from the start of the run to the start of the task. */
+    float End = 0.0f;   /**< Milliseconds from the start of the run to the end of the task. */
+    bool Skipped = false; /**< Skipped after the deadline, or after a dependency was skipped. */
+  };
+
+  /**
+   * @brief Constructs a new TaskGraph.
+   * @param name The name of the graph. Its critical path is recorded on the profiler track
+   * "<name> Critical Path".
+   */
+  explicit TaskGraph(std::string name = "TaskGraph");
+
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  /**
+   * @brief Adds a task.
+   * @param name The name of the task, which is also the name of its profiler scope.
+   * @param func The work of the task, run on a worker thread.
+   * @param dependencies Tasks that must finish first.
+   * @param skippable Whether the task, and the tasks that depend on it, may be skipped when it
+   * would start after the deadline.
+   * @return The id of the task.
+   */
+  TaskId AddTask(std::string name,
+      std::function<void()> func,
+      const std::vector<TaskId>& dependencies = {},
+      bool skippable = false);
+  /**
+   * @brief Removes every task.
+   */
+  void Clear();
+
+  /**
+   * @brief Starts running the graph without waiting for it.
+   * @param jobs The job system to run the tasks on.
+   * @param deadline The time after which skippable tasks are not started.
+   */
+  void Start(JobSystem& jobs, TimePoint deadline = TimePoint::max());
+  /**
+   * @brief Waits for the run started with `Start`, executing other jobs meanwhile.
+   * @details Rethrows the first exception thrown by a task. Tasks that depend on a task that
+   * threw are skipped.
+   * @param jobs The job system passed to `Start`.
+   */
+  void Wait(JobSystem& jobs);
+  /**
+   * @brief Runs the graph and waits for it.
+   * @param jobs The job system to run the tasks on.
+   * @param deadline The time after which skippable tasks are not started.
+   */
+  void Run(JobSystem& jobs, TimePoint deadline = TimePoint::max()) {
+    Start(jobs, deadline);
+    Wait(jobs);
+  }
+
+  /**
+   * @brief Checks if the graph was started and not waited for.
+   * @return True while the graph runs.
+   */
+  bool IsRunning() const {
+    return m_Running;
+  }
+  /**
+   * @brief Gets the name of the graph.
+   * @return The name.
+   */
+  const std::string& GetName() const {
+    return m_Name;
+  }
+  /**
+   * @brief Gets the number of tasks.
+   * @return The number of tasks.
+   */
+  size_t GetTaskCount() const {
+    return m_Tasks.size();
+  }
+  /**
+   * @brief Gets the name of a task.
+   * @param task The id of the task.
+   * @return The name.
+   */
+  const std::string& GetTaskName(TaskId task) const {
+    return m_Tasks[task].Name;
+  }
+
+  /**
+   * @brief Gets the timings of the tasks during the last completed run.
+   * @return The timings, indexed by task id.
+   */
+  const std::vector<TaskTiming>& GetTimings() const {
+    return m_Timings;
+  }
+  /**
+   * @brief Gets the chain of tasks that determined the duration of the last completed run.
+   * @return The ids of the tasks, from the first to the last.
+   */
+  std::vector<TaskId> GetCriticalPath() const;
+  /**
+   * @brief Gets the wall time of the last completed run.
+   * @return The duration in milliseconds.
+   */
+  float GetDuration() const {
+    return m_Duration;
+  }
+  /**
+   * @brief Gets the number of tasks skipped in the last completed run.
+   * @return The number of skipped tasks.
+   */
+  uint32_t GetSkippedCount() const {
+    return m_SkippedCount;
+  }
+
+ private:
+  /**
+   * @struct Task
+   * @brief A task and its dependencies.
+   */
+  struct Task {
+    std::string Name;
+    const char* ProfileName = nullptr; /**< The interned name, which outlives the graph. */
+    std::function<void()> Func;
+    std::vector<TaskId> Dependencies;
+    bool Skippable = false;
+  };
+
+  /**
+   * @brief Runs one task of the current run, or skips it.
+   * @param task The id of the task.
+   */
+  void Execute(TaskId task);
+  /**
+   * @brief Converts `Clock` ticks to milliseconds since the start of the current run.
+   * @param ticks The ticks.
+   * @return The time in milliseconds.
+   */
+  float ToRunTime(Clock::Ticks ticks) const;
+  /**
+   * @brief Records the critical path of the last completed run on the graph's profiler track.
+   */
+  void RecordCriticalPath();
+
+ private:
+  std::string m_Name;
+  std::vector<Task> m_Tasks;
+
+  // The state of the current run. Each entry is written by the task of the same index and only
+  // read by the tasks that depend on it, which the job system orders after it.
+  bool m_Running = false;
+  Clock::Ticks m_RunStart = 0;
+  TimePoint m_Deadline;
+  std::vector<JobHandle> m_Handles;
+  std::vector<std::exception_ptr> m_Errors;
+  std::vector<TaskTiming> m_RunTimings;
+  std::vector<std::pair<Clock::Ticks, Clock::Ticks>> m_RunSpans;  // Ticks, for the profiler.
+
+  // The results of the last completed run.
+  std::vector<TaskTiming> m_Timings;
+  std::vector<std::pair<Clock::Ticks, Clock::Ticks>> m_Spans;
+  float m_Duration = 0.0f;
+  uint32_t m_SkippedCount = 0;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file TextureCache.cpp
+ * @author B.G. Smit
+ * @brief Implements the texture cache that deduplicates loaded images.
+ * @copyright Copyright (c) 2025
+ */
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "AssetLoader.h"
+
+namespace Weaver {
+
+/**
+ * @brief Constructs a new TextureCache.
+ * @param loader The asset loader used for cache misses.
+ * @param memory_budget The device memory budget in bytes.
+ * @param eviction_frames The number of frames a texture must go undrawn before it can be evicted.
+ */
+TextureCache::TextureCache(AssetLoader& loader, uint64_t memory_budget, uint32_t eviction_frames)
+    : m_Loader(loader),
+      m_MemoryBudget(memory_budget),
+      m_EvictionFrames(eviction_frames) {}
+
+/**
+ * @brief Gets a shared handle to an image, loading it if it is not cached.
+ * @param path The path to the image file.
+ * @param options The load options, part of the cache key.
+ * @return A shared handle to the image.
+ */
+std::shared_ptr<ImageAsset> TextureCache::Acquire(
+    std::string_view path, const ImageLoadOptions& options) {
+  std::shared_ptr<ImageAsset>& entry = m_Entries[MakeKey(path, options)];
+
+  // Failed or cancelled loads are retried rather than served from the cache.
+  if (entry && entry->GetState() != ImageAsset::State::Failed &&
+      entry->GetState() != ImageAsset::State::Cancelled) {
+    m_Hits++;
+    return entry;
+  }
+
+  m_Misses++;
+  entry = m_Loader.LoadImage(path, options);
+  return entry;
+}
+
+/**
+ * @brief Evicts unreferenced textures while the cache is over its memory budget.
+ * @details Called by the `Canvas` once per frame. Also cancels queued and decoding loads that
+ * are no longer referenced outside the cache.
+ * @param frame The current frame count.
+ */
+void TextureCache::Update(uint64_t frame) {
+  uint64_t usage = 0;
+  std::vector<std::unordered_map<std::string, std::shared_ptr<ImageAsset>>::iterator> candidates;
+
+  for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+    const std::shared_ptr<ImageAsset>& asset = it->second;
+    const bool unreferenced = asset.use_count() == 1;
+
+    // Drop dead entries right away, they hold no device memory.
+    const ImageAsset::State state = asset->GetState();
+    if (unreferenced &&
+        (state == ImageAsset::State::Failed || state == ImageAsset::State::Cancelled)) {
+      it = m_Entries.erase(it);
+      continue;
+    }
+
+    // Nobody is waiting for a pending load any more, so cancel it as dropping the handle would
+    // have done without the cache.
+    if (unreferenced &&
+        (state == ImageAsset::State::Queued || state == ImageAsset::State::Decoding)) {
+      asset->Cancel();
+      it = m_Entries.erase(it);
+      continue;
+    }
+
+    usage += asset->GetMemorySize();
+    if (unreferenced && asset->IsReady() && asset->GetLastUsedFrame() + m_EvictionFrames < frame)
+      candidates.push_back(it);
+    ++it;
+  }
+
+  if (usage <= m_MemoryBudget)
+    return;
+
+  std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+    return a->second->GetLastUsedFrame() < b->second->GetLastUsedFrame();
+  });
+
+  for (auto& candidate : candidates) {
+    if (usage <= m_MemoryBudget)
+      break;
+
+    usage -= candidate->second->GetMemorySize();
+    m_Entries.erase(candidate);
+    m_Evictions++;
+  }
+}
+
+/**
+ * @brief Removes every texture that is not referenced outside the cache.
+ */
+void TextureCache::Clear() {
+  for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+    if (it->second.use_count() == 1)
+      it = m_Entries.erase(it);
+    else
+      ++it;
+  }
+}
+
+/**
+ * @brief Gets the cache counters.
+ * @return The cache statistics.
+ */
+TextureCacheStatistics TextureCache::GetStatistics() const {
+  TextureCacheStatistics statistics;
+  statistics.Hits = m_Hits;
+  statistics.Misses = m_Misses;
+  statistics.Evictions = m_Evictions;
+  statistics.MemoryBudget = m_MemoryBudget;
+  statistics.TextureCount = (uint32_t)m_Entries.size();
+  for (const auto& [key, asset] : m_Entries)
+    statistics.MemoryUsage += asset->GetMemorySize();
+  return statistics;
+}
+
+/**
+ * @brief Builds the cache key for a path and its load options.
+ * @param path The path to the image file.
+ * @param options The load options.
+ * @return The cache key.
+ */
+std::string TextureCache::MakeKey(std::string_view path, const ImageLoadOptions& options) {
+  std::string key(path);
+  key += '|';
+  key += options.HDRToHalfFloat ? '1' : '0';
+  key += options.PreserveChannelCount ? '1' : '0';
+  key += options.PremultiplyAlpha ? '1' : '0';
+  key += options.LinearizeSRGB ? '1' : '0';
+  key += (char)('0' + (int)options.Sampler);
+  return key;
+}
+
+}  // namespace Weaver
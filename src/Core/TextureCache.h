@@ -0,0 +1,130 @@
+/**
+ * @file TextureCache.h
+ * @author B.G. Smit
+ * @brief Declares the texture cache that deduplicates loaded images.
+ *
+ * This file defines the `TextureCache` class, which hands out shared `ImageAsset`
+ * handles keyed by file path and load options, so the same file is only decoded and
+ * uploaded once. Textures that nobody references and that have not been drawn for a
+ * number of frames are evicted in least-recently-used order once the cache exceeds its
+ * memory budget.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Image.h"
+
+namespace Weaver {
+
+class AssetLoader;
+class ImageAsset;
+
+/**
+ * @struct TextureCacheStatistics
+ * @brief Counters describing the behaviour of the texture cache.
+ */
+struct TextureCacheStatistics {
+  uint64_t Hits = 0;         /**< Requests served from the cache. */
+  uint64_t Misses = 0;       /**< Requests that started a new load. */
+  uint64_t Evictions = 0;    /**< Textures evicted to stay within the budget. */
+  uint64_t MemoryUsage = 0;  /**< Device memory used by the cached textures in bytes. */
+  uint64_t MemoryBudget = 0; /**< The configured memory budget in bytes. */
+  uint32_t TextureCount = 0; /**< The number of cached textures. */
+};
+
+/**
+ * @class TextureCache
+ * @brief A reference-counted, memory-budgeted cache of images loaded through the `AssetLoader`.
+ * @details The cache is not thread-safe and must only be used on the main thread. The handles it
+ * returns are shared between every caller of the same image, so `ImageAsset::Cancel` on a cached
+ * handle cancels the load for all of them; drop the handle instead to give up on a load, which
+ * cancels it once no caller holds it any more.
+ */
+class TextureCache {
+ public:
+  /**
+   * @brief Constructs a new TextureCache.
+   * @param loader The asset loader used for cache misses.
+   * @param memory_budget The device memory budget in bytes.
+   * @param eviction_frames The number of frames a texture must go undrawn before it can be
+   * evicted.
+   */
+  TextureCache(AssetLoader& loader, uint64_t memory_budget, uint32_t eviction_frames);
+
+  /**
+   * @brief Gets a shared handle to an image, loading it if it is not cached.
+   * @param path The path to the image file.
+   * @param options The load options, part of the cache key.
+   * @return A shared handle to the image.
+   */
+  std::shared_ptr<ImageAsset> Acquire(
+      std::string_view path, const ImageLoadOptions& options = ImageLoadOptions());
+
+  /**
+   * @brief Evicts unreferenced textures while the cache is over its memory budget.
+   * @details Called by the `Canvas` once per frame. Also cancels queued and decoding loads that
+   * are no longer referenced outside the cache.
+   * @param frame The current frame count.
+   */
+  void Update(uint64_t frame);
+
+  /**
+   * @brief Removes every texture that is not referenced outside the cache.
+   */
+  void Clear();
+
+  /**
+   * @brief Sets the device memory budget.
+   * @param bytes The budget in bytes.
+   */
+  void SetMemoryBudget(uint64_t bytes) {
+    m_MemoryBudget = bytes;
+  }
+
+  /**
+   * @brief Sets the number of frames a texture must go undrawn before it can be evicted.
+   * @param frames The number of frames.
+   */
+  void SetEvictionFrames(uint32_t frames) {
+    m_EvictionFrames = frames;
+  }
+
+  /**
+   * @brief Gets the cache counters.
+   * @return The cache statistics.
+   */
+  TextureCacheStatistics GetStatistics() const;
+
+ private:
+  /**
+   * @brief Builds the cache key for a path and its load options.
+   * @param path The path to the image file.
+   * @param options The load options.
+   * @return The cache key.
+   */
+  static std::string MakeKey(std::string_view path, const ImageLoadOptions& options);
+
+ private:
+  AssetLoader& m_Loader;
+  std::unordered_map<std::string, std::shared_ptr<ImageAsset>> m_Entries;
+
+  uint64_t m_MemoryBudget = 0;
+  uint32_t m_EvictionFrames = 0;
+
+  uint64_t m_Hits = 0;
+  uint64_t m_Misses = 0;
+  uint64_t m_Evictions = 0;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file ThreadPool.cpp
+ * @author B.G. Smit
+ * @brief Implements the fixed-size worker thread pool.
+ * @copyright Copyright (c) 2025
+ */
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace Weaver {
+
+/**
+ * @brief Constructs a new ThreadPool and starts its workers.
+ * @param worker_count The number of worker threads, zero for automatic sizing.
+ */
+ThreadPool::ThreadPool(uint32_t worker_count) {
+  if (worker_count == 0) {
+    // Leave one core for the UI thread.
+    const uint32_t hardware = std::thread::hardware_concurrency();
+    worker_count = std::max(1u, hardware > 1 ? hardware - 1 : 1u);
+  }
+
+  m_Workers.reserve(worker_count);
+  for (uint32_t i = 0; i < worker_count; i++)
+    m_Workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+/**
+ * @brief Destroys the ThreadPool, discarding pending tasks and joining the workers.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stopping = true;
+    m_Tasks.clear();
+  }
+  m_Condition.notify_all();
+
+  for (auto& worker : m_Workers)
+    worker.join();
+}
+
+/**
+ * @brief Queues a task for execution on a worker thread.
+ * @param task The task to execute.
+ */
+void ThreadPool::Submit(std::function<void()>&& task) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Tasks.emplace_back(std::move(task));
+  }
+  m_Condition.notify_one();
+}
+
+/**
+ * @brief The loop executed by each worker thread.
+ */
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+      if (m_Stopping)
+        return;
+
+      task = std::move(m_Tasks.front());
+      m_Tasks.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace Weaver
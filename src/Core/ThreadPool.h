@@ -0,0 +1,75 @@
+/**
+ * @file ThreadPool.h
+ * @author B.G. Smit
+ * @brief Declares a fixed-size worker thread pool.
+ *
+ * This file defines the `ThreadPool` class, a small FIFO worker pool used by Core
+ * systems (such as the `AssetLoader`) to move blocking work off the UI thread.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @class ThreadPool
+ * @brief A fixed number of worker threads that execute submitted tasks in FIFO order.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Constructs a new ThreadPool and starts its workers.
+   * @param worker_count The number of worker threads. Zero selects one less than the
+   * hardware concurrency (at least one).
+   */
+  explicit ThreadPool(uint32_t worker_count = 0);
+  /**
+   * @brief Destroys the ThreadPool. Pending tasks are discarded, running tasks are joined.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Queues a task for execution on a worker thread.
+   * @param task The task to execute.
+   */
+  void Submit(std::function<void()>&& task);
+
+  /**
+   * @brief Gets the number of worker threads.
+   * @return The number of worker threads.
+   */
+  uint32_t GetWorkerCount() const {
+    return (uint32_t)m_Workers.size();
+  }
+
+ private:
+  /**
+   * @brief The loop executed by each worker thread.
+   */
+  void WorkerLoop();
+
+ private:
+  std::vector<std::thread> m_Workers;
+  std::deque<std::function<void()>> m_Tasks;
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  bool m_Stopping = false;
+};
+
+}  // namespace Weaver
+
+#endif
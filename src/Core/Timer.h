@@ -4,7 +4,8 @@
  * @brief Declares utility classes for timing operations.
  *
  * This file defines the `Timer` class for measuring elapsed time and the `ScopedTimer`
- * class for convenient, scope-based timing and logging of code execution durations.
+ * class for convenient, scope-based timing of code execution durations. Scoped timers record into
+ * the named accumulators of `Timers`, which aggregate the calls instead of printing each one.
  * These utilities are essential for performance profiling and debugging.
  * @copyright Copyright (c) 2025
  */
@@ -14,15 +15,18 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 
-#include <chrono>
-#include <iostream>
+#include <cstdint>
 #include <string>
 
+#include "Clock.h"
+#include "Timers.h"
+
 namespace Weaver {
 
 /**
  * @class Timer
  * @brief A simple timer class for measuring elapsed time.
+ * @details Reads the `Clock`, so a sample costs a TSC read where the CPU supports it.
  */
 class Timer {
  public:
@@ -37,7 +41,31 @@ class Timer {
    * @brief Resets the timer.
    */
   void reset() {
-    m_starting_timer = std::chrono::high_resolution_clock::now();
+    m_starting_timer = Clock::Now();
+  }
+
+  /**
+   * @brief Gets the elapsed time in clock ticks, see `Clock::GetFrequency`.
+   * @return The elapsed ticks.
+   */
+  Clock::Ticks elapsed_ticks() const {
+    return Clock::Now() - m_starting_timer;
+  }
+
+  /**
+   * @brief Gets the elapsed time in nanoseconds.
+   * @return The elapsed time in nanoseconds.
+   */
+  uint64_t elapsed_ns() const {
+    return Clock::ToNanoseconds(elapsed_ticks());
+  }
+
+  /**
+   * @brief Gets the elapsed time in seconds, in double precision.
+   * @return The elapsed time in seconds.
+   */
+  double elapsed_seconds() const {
+    return Clock::ToSeconds(elapsed_ticks());
   }
 
   /**
@@ -45,48 +73,67 @@ class Timer {
    * @return The elapsed time in seconds.
    */
   float elapsed() const {
-    return std::chrono::duration_cast<std::chrono::nanoseconds>(
-               std::chrono::high_resolution_clock::now() - m_starting_timer)
-               .count() *
-           0.001f * 0.001f * 0.001f;
+    return (float)elapsed_seconds();
   }
 
   /**
    * @brief Gets the elapsed time in milliseconds.
    * @return The elapsed time in milliseconds.
    */
-  float elapsed_ms() {
-    return elapsed() * 1000.0f;
+  float elapsed_ms() const {
+    return (float)(elapsed_seconds() * 1000.0);
   }
 
  private:
-  std::chrono::time_point<std::chrono::high_resolution_clock> m_starting_timer;
+  Clock::Ticks m_starting_timer;
 };
 
 /**
  * @class ScopedTimer
- * @brief A scoped timer that logs the elapsed time when it goes out of scope.
+ * @brief A scoped timer that records the elapsed time into a named timer when it goes out of
+ * scope. See `Timers` for the statistics.
  */
 class ScopedTimer {
  public:
   /**
    * @brief Constructs a new ScopedTimer object.
+   * @param accumulator The timer to record into.
+   */
+  explicit ScopedTimer(TimerAccumulator& accumulator)
+      : m_accumulator(accumulator), m_start(Clock::Now()) {}
+  /**
+   * @brief Constructs a new ScopedTimer object. Looks the name up on every call; prefer
+   * `WEAVER_TIME_SCOPE` in hot code.
    * @param name The name of the timer.
    */
-  ScopedTimer(const std::string& name) : m_scoped_timer_name(name) {}
+  ScopedTimer(const std::string& name) : ScopedTimer(Timers::Get(name)) {}
   /**
-   * @brief Destroys the ScopedTimer object and logs the elapsed time.
+   * @brief Destroys the ScopedTimer object and records the elapsed time.
    */
   ~ScopedTimer() {
-    float time = m_scoped_timer.elapsed_ms();
-    std::cout << "[TIMER] " << m_scoped_timer_name << " - " << time << "ms\n";
+    m_accumulator.Record(Clock::ToNanoseconds(Clock::Now() - m_start));
   }
 
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
  private:
-  std::string m_scoped_timer_name;
-  Timer m_scoped_timer;
+  TimerAccumulator& m_accumulator;
+  Clock::Ticks m_start;
 };
 
 }  // namespace Weaver
 
+#define WEAVER_TIME_CONCAT_IMPL(a, b) a##b
+#define WEAVER_TIME_CONCAT(a, b) WEAVER_TIME_CONCAT_IMPL(a, b)
+/**
+ * Times the rest of the scope under a name. The timer is looked up once per call site, so the
+ * name must not change between calls.
+ */
+#define WEAVER_TIME_SCOPE(name)                                                    \
+  static ::Weaver::TimerAccumulator& WEAVER_TIME_CONCAT(weaver_timer_, __LINE__) = \
+      ::Weaver::Timers::Get(name);                                                 \
+  ::Weaver::ScopedTimer WEAVER_TIME_CONCAT(weaver_scoped_timer_, __LINE__)(        \
+      WEAVER_TIME_CONCAT(weaver_timer_, __LINE__))
+
 #endif
\ No newline at end of file
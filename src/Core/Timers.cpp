@@ -0,0 +1,290 @@
+/**
+ * @file Timers.cpp
+ * @author B.G. Smit
+ * @brief Implements the registry of named timers and their aggregated statistics.
+ * @copyright Copyright (c) 2025
+ */
+#include "Timers.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "Log.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+static std::shared_mutex s_RegistryMutex;
+static std::unordered_map<std::string, std::unique_ptr<TimerAccumulator>> s_Registry;
+
+static std::mutex s_DumpMutex;
+static std::chrono::steady_clock::duration s_DumpInterval{0};
+static std::chrono::steady_clock::time_point s_NextDump;
+static std::string s_DumpPath;
+static const std::chrono::steady_clock::time_point s_Start = std::chrono::steady_clock::now();
+
+/**
+ * @brief Converts nanoseconds to milliseconds.
+ * @param nanoseconds The duration in nanoseconds.
+ * @return The duration in milliseconds.
+ */
+static double ToMilliseconds(uint64_t nanoseconds) {
+  return (double)nanoseconds * 1e-6;
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new TimerAccumulator.
+ * @param name The name of the timer.
+ */
+TimerAccumulator::TimerAccumulator(std::string name) : m_Name(std::move(name)) {}
+
+/**
+ * @brief Records a duration. Safe on any thread.
+ * @param nanoseconds The duration in nanoseconds.
+ */
+void TimerAccumulator::Record(uint64_t nanoseconds) {
+  m_Total.fetch_add(nanoseconds, std::memory_order_relaxed);
+  m_Buckets[GetBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+
+  // The extremes rarely change, so the compare-and-swap loops almost never run.
+  uint64_t min = m_Min.load(std::memory_order_relaxed);
+  while (nanoseconds < min &&
+         !m_Min.compare_exchange_weak(min, nanoseconds, std::memory_order_relaxed)) {
+  }
+  uint64_t max = m_Max.load(std::memory_order_relaxed);
+  while (nanoseconds > max &&
+         !m_Max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+  }
+}
+
+/**
+ * @brief Computes the statistics of the recorded durations.
+ * @return The statistics.
+ */
+TimerStatistics TimerAccumulator::GetStatistics() const {
+  TimerStatistics statistics;
+  statistics.Name = m_Name;
+
+  // Recording continues while the snapshot is taken, so the histogram is the reference count.
+  uint64_t buckets[kBucketCount];
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < kBucketCount; i++) {
+    buckets[i] = m_Buckets[i].load(std::memory_order_relaxed);
+    count += buckets[i];
+  }
+  if (count == 0)
+    return statistics;
+
+  const uint64_t min = m_Min.load(std::memory_order_relaxed);
+  const uint64_t max = m_Max.load(std::memory_order_relaxed);
+  statistics.Count = count;
+  statistics.TotalMs = Utils::ToMilliseconds(m_Total.load(std::memory_order_relaxed));
+  statistics.MeanMs = statistics.TotalMs / (double)count;
+  statistics.MinMs = Utils::ToMilliseconds(min);
+  statistics.MaxMs = Utils::ToMilliseconds(max);
+
+  // A percentile is reported as the middle of its bucket, clamped to the recorded extremes.
+  auto percentile = [&](double fraction) {
+    const uint64_t rank = std::max<uint64_t>(1, (uint64_t)((double)count * fraction + 0.5));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBucketCount; i++) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        const uint64_t lower = GetBucketLowerBound(i);
+        const uint64_t upper = i + 1 < kBucketCount ? GetBucketLowerBound(i + 1) : UINT64_MAX;
+        const uint64_t middle = lower + (upper - lower) / 2;
+        return Utils::ToMilliseconds(std::clamp(middle, min, std::max(min, max)));
+      }
+    }
+    return Utils::ToMilliseconds(max);
+  };
+  statistics.P50Ms = percentile(0.50);
+  statistics.P95Ms = percentile(0.95);
+  statistics.P99Ms = percentile(0.99);
+  return statistics;
+}
+
+/**
+ * @brief Discards the recorded durations.
+ */
+void TimerAccumulator::Reset() {
+  for (auto& bucket : m_Buckets)
+    bucket.store(0, std::memory_order_relaxed);
+  m_Total.store(0, std::memory_order_relaxed);
+  m_Min.store(UINT64_MAX, std::memory_order_relaxed);
+  m_Max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Gets the histogram bucket of a duration.
+ * @param nanoseconds The duration in nanoseconds.
+ * @return The index of the bucket.
+ */
+uint32_t TimerAccumulator::GetBucket(uint64_t nanoseconds) {
+  if (nanoseconds < kSubBuckets)
+    return (uint32_t)nanoseconds;
+  const uint32_t exponent = 63 - (uint32_t)std::countl_zero(nanoseconds);
+  const uint32_t shift = exponent - kSubBucketBits;
+  const uint32_t sub_bucket = (uint32_t)(nanoseconds >> shift) & (kSubBuckets - 1);
+  return (shift + 1) * kSubBuckets + sub_bucket;
+}
+
+/**
+ * @brief Gets the smallest duration of a histogram bucket.
+ * @param bucket The index of the bucket.
+ * @return The duration in nanoseconds.
+ */
+uint64_t TimerAccumulator::GetBucketLowerBound(uint32_t bucket) {
+  if (bucket < kSubBuckets)
+    return bucket;
+  const uint32_t shift = bucket / kSubBuckets - 1;
+  return (uint64_t)(kSubBuckets + bucket % kSubBuckets) << shift;
+}
+
+/**
+ * @brief Gets the accumulator of a name, creating it on first use.
+ * @param name The name of the timer.
+ * @return The accumulator.
+ */
+TimerAccumulator& Timers::Get(const std::string& name) {
+  {
+    std::shared_lock<std::shared_mutex> lock(Utils::s_RegistryMutex);
+    auto it = Utils::s_Registry.find(name);
+    if (it != Utils::s_Registry.end())
+      return *it->second;
+  }
+  std::unique_lock<std::shared_mutex> lock(Utils::s_RegistryMutex);
+  auto& accumulator = Utils::s_Registry[name];
+  if (!accumulator)
+    accumulator = std::make_unique<TimerAccumulator>(name);
+  return *accumulator;
+}
+
+/**
+ * @brief Reads the statistics of every timer that recorded a duration.
+ * @return The statistics, the timer with the largest total first.
+ */
+std::vector<TimerStatistics> Timers::Snapshot() {
+  std::vector<TimerStatistics> snapshot;
+  {
+    std::shared_lock<std::shared_mutex> lock(Utils::s_RegistryMutex);
+    snapshot.reserve(Utils::s_Registry.size());
+    for (const auto& entry : Utils::s_Registry) {
+      TimerStatistics statistics = entry.second->GetStatistics();
+      if (statistics.Count > 0)
+        snapshot.push_back(std::move(statistics));
+    }
+  }
+  std::sort(snapshot.begin(), snapshot.end(), [](const auto& a, const auto& b) {
+    return a.TotalMs != b.TotalMs ? a.TotalMs > b.TotalMs : a.Name < b.Name;
+  });
+  return snapshot;
+}
+
+/**
+ * @brief Discards the durations recorded by every timer.
+ */
+void Timers::Reset() {
+  std::shared_lock<std::shared_mutex> lock(Utils::s_RegistryMutex);
+  for (const auto& entry : Utils::s_Registry)
+    entry.second->Reset();
+}
+
+/**
+ * @brief Writes a snapshot to the log.
+ */
+void Timers::Dump() {
+  for (const TimerStatistics& timer : Snapshot()) {
+    WEAVER_LOG_INFO("[TIMER] ") << timer.Name << " - count " << timer.Count << ", total "
+                                << timer.TotalMs << "ms, mean " << timer.MeanMs << "ms, min "
+                                << timer.MinMs << "ms, p50 " << timer.P50Ms << "ms, p95 "
+                                << timer.P95Ms << "ms, p99 " << timer.P99Ms << "ms, max "
+                                << timer.MaxMs << "ms";
+  }
+}
+
+/**
+ * @brief Appends a snapshot to a CSV file, writing the header if the file is new.
+ * @param path The path of the file.
+ * @return False if the file could not be written.
+ */
+bool Timers::Dump(const std::string& path) {
+  std::error_code error;
+  const bool header = !std::filesystem::exists(path, error) ||
+                      std::filesystem::file_size(path, error) == 0;
+  std::ofstream file(path, std::ios::app);
+  if (!file)
+    return false;
+  WriteCsv(file, header);
+  return (bool)file;
+}
+
+/**
+ * @brief Writes a snapshot as CSV rows.
+ * @param stream The stream to write to.
+ * @param header True to write the header row first.
+ */
+void Timers::WriteCsv(std::ostream& stream, bool header) {
+  if (header)
+    stream << "time_s,name,count,total_ms,mean_ms,min_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+  const double time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - Utils::s_Start).count();
+  for (const TimerStatistics& timer : Snapshot()) {
+    // Names are quoted, with quotes doubled, so they may contain commas.
+    std::string name = timer.Name;
+    for (size_t i = name.find('"'); i != std::string::npos; i = name.find('"', i + 2))
+      name.insert(i, 1, '"');
+    stream << std::fixed << std::setprecision(3) << time << ",\"" << name << "\","
+           << timer.Count << std::setprecision(6) << ',' << timer.TotalMs << ','
+           << timer.MeanMs << ',' << timer.MinMs << ',' << timer.P50Ms << ',' << timer.P95Ms
+           << ',' << timer.P99Ms << ',' << timer.MaxMs << '\n';
+  }
+  stream << std::defaultfloat;
+}
+
+/**
+ * @brief Sets how often `Update` dumps the timers.
+ * @param seconds The interval in seconds, zero to stop dumping.
+ * @param path The CSV file to append to, or empty to write to the log.
+ */
+void Timers::SetDumpInterval(float seconds, const std::string& path) {
+  std::lock_guard<std::mutex> lock(Utils::s_DumpMutex);
+  Utils::s_DumpInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<float>(std::max(seconds, 0.0f)));
+  Utils::s_DumpPath = path;
+  Utils::s_NextDump = std::chrono::steady_clock::now() + Utils::s_DumpInterval;
+}
+
+/**
+ * @brief Dumps the timers if the dump interval has passed. Called once per frame by the
+ * `Canvas`.
+ */
+void Timers::Update() {
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(Utils::s_DumpMutex);
+    const auto now = std::chrono::steady_clock::now();
+    if (Utils::s_DumpInterval.count() == 0 || now < Utils::s_NextDump)
+      return;
+    Utils::s_NextDump = now + Utils::s_DumpInterval;
+    path = Utils::s_DumpPath;
+  }
+
+  if (path.empty())
+    Dump();
+  else if (!Dump(path))
+    WEAVER_LOG_ERROR("Failed to write the timers to ") << path;
+}
+
+}  // namespace Weaver
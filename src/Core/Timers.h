@@ -0,0 +1,165 @@
+/**
+ * @file Timers.h
+ * @author B.G. Smit
+ * @brief Declares the registry of named timers and their aggregated statistics.
+ *
+ * This file defines the `TimerAccumulator`, which aggregates the durations recorded under one
+ * name into a count, total, minimum, maximum and a latency histogram, and the `Timers` registry
+ * that owns the accumulators. `ScopedTimer` records into it instead of printing every call, so
+ * functions called millions of times can be measured; `Timers::Snapshot` reads the statistics and
+ * `Timers::Dump` writes them to the log or a CSV file, periodically if a dump interval is set.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @struct TimerStatistics
+ * @brief The statistics of a named timer at the time of a snapshot.
+ */
+struct TimerStatistics {
+  std::string Name;
+  uint64_t Count = 0;
+  double TotalMs = 0.0;
+  double MeanMs = 0.0;
+  double MinMs = 0.0;
+  double MaxMs = 0.0;
+  double P50Ms = 0.0;
+  double P95Ms = 0.0;
+  double P99Ms = 0.0;
+};
+
+/**
+ * @class TimerAccumulator
+ * @brief Aggregates the durations recorded under one name. Recording is lock-free.
+ * @details Durations are counted in a log-linear histogram: every power of two is split into
+ * `kSubBuckets` buckets, so percentiles are within about 6% of the true value from nanoseconds to
+ * hours, in a fixed amount of memory.
+ */
+class TimerAccumulator {
+ public:
+  static constexpr uint32_t kSubBucketBits = 4;
+  static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+  static constexpr uint32_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  /**
+   * @brief Constructs a new TimerAccumulator.
+   * @param name The name of the timer.
+   */
+  explicit TimerAccumulator(std::string name);
+
+  TimerAccumulator(const TimerAccumulator&) = delete;
+  TimerAccumulator& operator=(const TimerAccumulator&) = delete;
+
+  /**
+   * @brief Records a duration. Safe on any thread.
+   * @param nanoseconds The duration in nanoseconds.
+   */
+  void Record(uint64_t nanoseconds);
+  /**
+   * @brief Computes the statistics of the recorded durations.
+   * @return The statistics.
+   */
+  TimerStatistics GetStatistics() const;
+  /**
+   * @brief Discards the recorded durations.
+   */
+  void Reset();
+  /**
+   * @brief Gets the name of the timer.
+   * @return The name.
+   */
+  const std::string& GetName() const {
+    return m_Name;
+  }
+
+  /**
+   * @brief Gets the histogram bucket of a duration.
+   * @param nanoseconds The duration in nanoseconds.
+   * @return The index of the bucket.
+   */
+  static uint32_t GetBucket(uint64_t nanoseconds);
+  /**
+   * @brief Gets the smallest duration of a histogram bucket.
+   * @param bucket The index of the bucket.
+   * @return The duration in nanoseconds.
+   */
+  static uint64_t GetBucketLowerBound(uint32_t bucket);
+
+ private:
+  std::string m_Name;
+  std::atomic<uint64_t> m_Total{0};
+  std::atomic<uint64_t> m_Min{UINT64_MAX};
+  std::atomic<uint64_t> m_Max{0};
+  std::atomic<uint64_t> m_Buckets[kBucketCount] = {};  // Their sum is the count.
+};
+
+/**
+ * @class Timers
+ * @brief The registry of named timers.
+ * @details Accumulators live until the program exits, so references returned by `Get` stay valid.
+ * Looking a name up takes a shared lock; hot code should look its accumulator up once, which
+ * `WEAVER_TIME_SCOPE` does.
+ */
+class Timers {
+ public:
+  /**
+   * @brief Gets the accumulator of a name, creating it on first use.
+   * @param name The name of the timer.
+   * @return The accumulator.
+   */
+  static TimerAccumulator& Get(const std::string& name);
+  /**
+   * @brief Reads the statistics of every timer that recorded a duration.
+   * @return The statistics, the timer with the largest total first.
+   */
+  static std::vector<TimerStatistics> Snapshot();
+  /**
+   * @brief Discards the durations recorded by every timer.
+   */
+  static void Reset();
+
+  /**
+   * @brief Writes a snapshot to the log.
+   */
+  static void Dump();
+  /**
+   * @brief Appends a snapshot to a CSV file, writing the header if the file is new.
+   * @param path The path of the file.
+   * @return False if the file could not be written.
+   */
+  static bool Dump(const std::string& path);
+  /**
+   * @brief Writes a snapshot as CSV rows.
+   * @param stream The stream to write to.
+   * @param header True to write the header row first.
+   */
+  static void WriteCsv(std::ostream& stream, bool header);
+
+  /**
+   * @brief Sets how often `Update` dumps the timers.
+   * @param seconds The interval in seconds, zero to stop dumping.
+   * @param path The CSV file to append to, or empty to write to the log.
+   */
+  static void SetDumpInterval(float seconds, const std::string& path = "");
+  /**
+   * @brief Dumps the timers if the dump interval has passed. Called once per frame by the
+   * `Canvas`.
+   */
+  static void Update();
+};
+
+}  // namespace Weaver
+
+#endif
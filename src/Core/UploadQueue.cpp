@@ -0,0 +1,321 @@
+/**
+ * @file UploadQueue.cpp
+ * @author B.G. Smit
+ * @brief Implements the queue that batches image uploads into the frame's command buffer.
+ * @copyright Copyright (c) 2025
+ */
+#include "UploadQueue.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Canvas.h"
+
+namespace Weaver {
+
+namespace Utils {
+
+/**
+ * @brief The alignment of uploads within a chunk, a multiple of every texel size.
+ */
+static constexpr uint64_t UPLOAD_ALIGNMENT = 16;
+
+/**
+ * @brief Marks a chunk holding staged uploads whose copy has not been recorded yet.
+ */
+static constexpr uint64_t PENDING_FRAME = UINT64_MAX;
+
+/**
+ * @brief Gets the Vulkan memory type index for a given memory type and properties.
+ * @param properties The memory properties.
+ * @param type_bits The memory type bits.
+ * @return The memory type index.
+ */
+static uint32_t GetUploadMemoryType(VkMemoryPropertyFlags properties, uint32_t type_bits) {
+  VkPhysicalDeviceMemoryProperties prop;
+  vkGetPhysicalDeviceMemoryProperties(Canvas::GetPhysicalDevice(), &prop);
+  for (uint32_t i = 0; i < prop.memoryTypeCount; i++) {
+    if ((prop.memoryTypes[i].propertyFlags & properties) == properties && type_bits & (1 << i))
+      return i;
+  }
+
+  return 0xffffffff;
+}
+
+}  // namespace Utils
+
+/**
+ * @brief Constructs a new UploadQueue.
+ * @param chunk_size The size of each staging chunk.
+ * @param pool_budget The number of bytes of idle staging chunks kept for reuse.
+ */
+UploadQueue::UploadQueue(uint64_t chunk_size, uint64_t pool_budget)
+    : m_ChunkSize(chunk_size),
+      m_PoolBudget(pool_budget) {}
+
+/**
+ * @brief Destroys the UploadQueue. The device must be idle.
+ */
+UploadQueue::~UploadQueue() {
+  for (Chunk& chunk : m_Chunks)
+    DestroyChunk(chunk);
+}
+
+/**
+ * @brief Stages pixels for an image, to be copied when the frame is recorded.
+ * @param image The image to write.
+ * @param width The width of the region to write.
+ * @param height The height of the region to write.
+ * @param image_width The width of the image.
+ * @param image_height The height of the image.
+ * @param size The number of bytes of tightly packed pixels.
+ * @param writer Called with the staging memory to fill.
+ */
+void UploadQueue::UploadImage(VkImage image,
+    uint32_t width,
+    uint32_t height,
+    uint32_t image_width,
+    uint32_t image_height,
+    uint64_t size,
+    const std::function<void(uint8_t* destination)>& writer) {
+  // Layers may upload from worker threads. The writer runs under the lock as well, so `Record`
+  // never copies from staging memory that is still being filled.
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  // A second write to the same image this frame replaces the first, the copy is not recorded yet.
+  auto it = std::find_if(m_Pending.begin(), m_Pending.end(), [image](const PendingUpload& pending) {
+    return pending.Image == image;
+  });
+  PendingUpload* upload = nullptr;
+  if (it != m_Pending.end()) {
+    upload = &*it;
+    m_Deduplicated++;
+  } else {
+    m_Pending.emplace_back();
+    upload = &m_Pending.back();
+    upload->Image = image;
+  }
+
+  if (upload->Size != size)
+    Allocate(size, *upload);
+  upload->Width = width;
+  upload->Height = height;
+  upload->ImageWidth = image_width;
+  upload->ImageHeight = image_height;
+  upload->Size = size;
+  writer(upload->Mapped);
+}
+
+/**
+ * @brief Records the pending uploads into a command buffer and clears them.
+ * @param command_buffer The command buffer to record into.
+ */
+void UploadQueue::Record(VkCommandBuffer command_buffer) {
+  // Uploads made while recording go into the next frame. Both vectors keep their capacity.
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Recording.swap(m_Pending);
+
+    // Every staged upload is being recorded now, so tag their chunks with the frame that records
+    // the copies rather than the one that staged them, as a frame may have started in between.
+    const uint64_t frame = Canvas::GetFrameCount();
+    for (Chunk& chunk : m_Chunks) {
+      if (chunk.Used && chunk.LastUsedFrame == Utils::PENDING_FRAME)
+        chunk.LastUsedFrame = frame;
+    }
+  }
+
+  if (!m_Recording.empty()) {
+    std::vector<VkImageMemoryBarrier> barriers(m_Recording.size());
+    for (size_t i = 0; i < m_Recording.size(); i++) {
+      VkImageMemoryBarrier& barrier = barriers[i];
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = m_Recording[i].Image;
+      barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      barrier.subresourceRange.levelCount = 1;
+      barrier.subresourceRange.layerCount = 1;
+    }
+    // The previous contents are discarded, but earlier frames may still be sampling them.
+    vkCmdPipelineBarrier(command_buffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0,
+        NULL,
+        0,
+        NULL,
+        (uint32_t)barriers.size(),
+        barriers.data());
+
+    for (const PendingUpload& upload : m_Recording) {
+      VkBufferImageCopy regions[4] = {};
+      regions[0].bufferOffset = upload.Offset;
+      regions[0].bufferRowLength = upload.Width;
+      regions[0].bufferImageHeight = upload.Height;
+      regions[0].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      regions[0].imageSubresource.layerCount = 1;
+      regions[0].imageExtent.width = upload.Width;
+      regions[0].imageExtent.height = upload.Height;
+      regions[0].imageExtent.depth = 1;
+      uint32_t region_count = 1;
+
+      // Replicate the last column and row into the unused capacity beyond them, re-reading the
+      // staged pixels, so bilinear filtering at the logical edges samples the edge texels.
+      const uint64_t texel_size = upload.Size / ((uint64_t)upload.Width * upload.Height);
+      const bool pad_x = upload.Width < upload.ImageWidth;
+      const bool pad_y = upload.Height < upload.ImageHeight;
+      const uint32_t last_x = upload.Width - 1, last_y = upload.Height - 1;
+      auto replicate = [&](uint32_t source_x,
+          uint32_t source_y,
+          uint32_t x,
+          uint32_t y,
+          uint32_t width,
+          uint32_t height) {
+        VkBufferImageCopy& region = regions[region_count++];
+        region = regions[0];
+        region.bufferOffset =
+            upload.Offset + ((uint64_t)source_y * upload.Width + source_x) * texel_size;
+        region.imageOffset = {(int32_t)x, (int32_t)y, 0};
+        region.imageExtent = {width, height, 1};
+      };
+      if (pad_x)
+        replicate(last_x, 0, upload.Width, 0, 1, upload.Height);
+      if (pad_y)
+        replicate(0, last_y, 0, upload.Height, upload.Width, 1);
+      if (pad_x && pad_y)
+        replicate(last_x, last_y, upload.Width, upload.Height, 1, 1);
+
+      vkCmdCopyBufferToImage(command_buffer,
+          upload.Buffer,
+          upload.Image,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          region_count,
+          regions);
+    }
+
+    for (VkImageMemoryBarrier& barrier : barriers) {
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+    vkCmdPipelineBarrier(command_buffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0,
+        0,
+        NULL,
+        0,
+        NULL,
+        (uint32_t)barriers.size(),
+        barriers.data());
+
+    m_Recording.clear();
+  }
+
+  // Free the largest idle chunks until the pool fits its budget.
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  uint64_t idle_bytes = 0;
+  for (const Chunk& chunk : m_Chunks) {
+    if (!chunk.Used)
+      idle_bytes += chunk.Capacity;
+  }
+  while (idle_bytes > m_PoolBudget) {
+    auto largest = m_Chunks.end();
+    for (auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it) {
+      if (!it->Used && (largest == m_Chunks.end() || it->Capacity > largest->Capacity))
+        largest = it;
+    }
+    idle_bytes -= largest->Capacity;
+    DestroyChunk(*largest);
+    m_Chunks.erase(largest);
+  }
+}
+
+/**
+ * @brief Sub-allocates staging memory that no frame in flight uses.
+ * @param size The number of bytes needed.
+ * @param upload Receives the buffer, offset and mapped pointer.
+ */
+void UploadQueue::Allocate(uint64_t size, PendingUpload& upload) {
+  Chunk* target = nullptr;
+  for (Chunk& chunk : m_Chunks) {
+    // Chunks last used by frames that have completed are free again.
+    if (chunk.Used && Canvas::IsFrameComplete(chunk.LastUsedFrame)) {
+      chunk.Used = false;
+      chunk.Offset = 0;
+    }
+
+    const bool available = !chunk.Used || chunk.LastUsedFrame == Utils::PENDING_FRAME;
+    const uint64_t offset =
+        (chunk.Offset + Utils::UPLOAD_ALIGNMENT - 1) & ~(Utils::UPLOAD_ALIGNMENT - 1);
+    if (!target && available && offset + size <= chunk.Capacity)
+      target = &chunk;
+  }
+  if (!target) {
+    m_Chunks.push_back(CreateChunk(std::max(size, m_ChunkSize)));
+    target = &m_Chunks.back();
+  }
+
+  upload.Offset = (target->Offset + Utils::UPLOAD_ALIGNMENT - 1) & ~(Utils::UPLOAD_ALIGNMENT - 1);
+  upload.Buffer = target->Buffer;
+  upload.Mapped = target->Mapped + upload.Offset;
+  target->Offset = upload.Offset + size;
+  target->Used = true;
+  // Kept until `Record` tags the chunk with the frame that copies from it.
+  target->LastUsedFrame = Utils::PENDING_FRAME;
+}
+
+/**
+ * @brief Creates a staging chunk.
+ * @param capacity The size of the chunk.
+ * @return The chunk.
+ */
+UploadQueue::Chunk UploadQueue::CreateChunk(uint64_t capacity) {
+  VkDevice device = Canvas::GetDevice();
+  VkResult err;
+  Chunk chunk;
+  chunk.Capacity = capacity;
+
+  VkBufferCreateInfo buffer_info = {};
+  buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  buffer_info.size = capacity;
+  buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  err = vkCreateBuffer(device, &buffer_info, nullptr, &chunk.Buffer);
+  check_vk_result(err);
+  VkMemoryRequirements req;
+  vkGetBufferMemoryRequirements(device, chunk.Buffer, &req);
+  VkMemoryAllocateInfo alloc_info = {};
+  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  alloc_info.allocationSize = req.size;
+  alloc_info.memoryTypeIndex = Utils::GetUploadMemoryType(
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      req.memoryTypeBits);
+  if (alloc_info.memoryTypeIndex == 0xffffffff)
+    throw std::runtime_error("Failed to find a suitable memory type!");
+  err = vkAllocateMemory(device, &alloc_info, nullptr, &chunk.Memory);
+  check_vk_result(err);
+  err = vkBindBufferMemory(device, chunk.Buffer, chunk.Memory, 0);
+  check_vk_result(err);
+  err = vkMapMemory(device, chunk.Memory, 0, VK_WHOLE_SIZE, 0, (void**)&chunk.Mapped);
+  check_vk_result(err);
+  return chunk;
+}
+
+/**
+ * @brief Destroys a staging chunk.
+ * @param chunk The chunk.
+ */
+void UploadQueue::DestroyChunk(Chunk& chunk) {
+  VkDevice device = Canvas::GetDevice();
+  vkDestroyBuffer(device, chunk.Buffer, nullptr);
+  vkFreeMemory(device, chunk.Memory, nullptr);
+}
+
+}  // namespace Weaver
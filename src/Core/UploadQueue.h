@@ -0,0 +1,155 @@
+/**
+ * @file UploadQueue.h
+ * @author B.G. Smit
+ * @brief Declares the queue that batches image uploads into the frame's command buffer.
+ *
+ * This file defines the `UploadQueue` class. `Image::SetData` writes its pixels into a staging
+ * chunk shared by all uploads of the frame and records nothing itself. When the frame is
+ * rendered, every pending upload is recorded into the frame's command buffer ahead of the UI,
+ * with the layout transitions of all images batched into two barriers. The number of queue
+ * submissions per frame no longer depends on the number of images updated.
+ * @copyright Copyright (c) 2025
+ */
+#ifndef UPLOAD_QUEUE_H
+#define UPLOAD_QUEUE_H
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Weaver {
+
+/**
+ * @class UploadQueue
+ * @brief Collects the image uploads of a frame and records them together.
+ * @details Owned by the `Canvas`, see `Canvas::GetUploadQueue`. `UploadImage` may be called
+ * from any thread, e.g. by layers updating on the `JobSystem`; everything else must be called
+ * from the main thread.
+ */
+class UploadQueue {
+ public:
+  /**
+   * @brief Constructs a new UploadQueue.
+   * @param chunk_size The size of each staging chunk. Larger uploads get a chunk of their own.
+   * @param pool_budget The number of bytes of idle staging chunks kept for reuse.
+   */
+  UploadQueue(uint64_t chunk_size, uint64_t pool_budget);
+  /**
+   * @brief Destroys the UploadQueue. The device must be idle.
+   */
+  ~UploadQueue();
+
+  UploadQueue(const UploadQueue&) = delete;
+  UploadQueue& operator=(const UploadQueue&) = delete;
+
+  /**
+   * @brief Stages pixels for an image, to be copied when the frame is recorded.
+   * @details If the image was already written this frame, the earlier upload is replaced
+   * instead of copying twice. Safe on any thread; the writer runs under the queue's lock, so
+   * concurrent uploads are copied one after the other.
+   * @param image The image to write, left in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`.
+   * @param width The width of the region to write, starting at the top left.
+   * @param height The height of the region to write.
+   * @param image_width The width of the image. The last column of the region is replicated into
+   * the column after it, so linear filtering at the edge does not read uninitialized texels.
+   * @param image_height The height of the image. The last row is replicated the same way.
+   * @param size The number of bytes of tightly packed pixels.
+   * @param writer Called with the staging memory to fill with `size` bytes.
+   */
+  void UploadImage(VkImage image,
+      uint32_t width,
+      uint32_t height,
+      uint32_t image_width,
+      uint32_t image_height,
+      uint64_t size,
+      const std::function<void(uint8_t* destination)>& writer);
+
+  /**
+   * @brief Records the pending uploads into a command buffer and clears them.
+   * @param command_buffer The command buffer to record into.
+   */
+  void Record(VkCommandBuffer command_buffer);
+
+  /**
+   * @brief Checks if uploads are waiting to be recorded.
+   * @return True if uploads are pending.
+   */
+  bool HasPendingUploads() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return !m_Pending.empty();
+  }
+
+  /**
+   * @brief Gets the number of uploads replaced by a later write to the same image this frame.
+   * @return The number of deduplicated uploads.
+   */
+  uint64_t GetDeduplicatedCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Deduplicated;
+  }
+
+ private:
+  /**
+   * @struct Chunk
+   * @brief A mapped host-visible buffer that uploads are sub-allocated from.
+   */
+  struct Chunk {
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    uint8_t* Mapped = nullptr;
+    uint64_t Capacity = 0;
+    uint64_t Offset = 0;
+    uint64_t LastUsedFrame = 0;
+    bool Used = false;
+  };
+
+  /**
+   * @struct PendingUpload
+   * @brief A staged copy into an image.
+   */
+  struct PendingUpload {
+    VkImage Image = VK_NULL_HANDLE;
+    uint32_t Width = 0, Height = 0;
+    uint32_t ImageWidth = 0, ImageHeight = 0;
+    uint64_t Size = 0;
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    uint64_t Offset = 0;
+    uint8_t* Mapped = nullptr;
+  };
+
+  /**
+   * @brief Sub-allocates staging memory that no frame in flight uses.
+   * @param size The number of bytes needed.
+   * @param upload Receives the buffer, offset and mapped pointer.
+   */
+  void Allocate(uint64_t size, PendingUpload& upload);
+  /**
+   * @brief Creates a staging chunk.
+   * @param capacity The size of the chunk.
+   * @return The chunk.
+   */
+  Chunk CreateChunk(uint64_t capacity);
+  /**
+   * @brief Destroys a staging chunk.
+   * @param chunk The chunk.
+   */
+  void DestroyChunk(Chunk& chunk);
+
+ private:
+  uint64_t m_ChunkSize = 0;
+  uint64_t m_PoolBudget = 0;
+  mutable std::mutex m_Mutex;  // Guards the chunks, the pending uploads and the counter.
+  std::vector<Chunk> m_Chunks;
+  std::vector<PendingUpload> m_Pending;
+  std::vector<PendingUpload> m_Recording;  // Main thread only, swapped with `m_Pending`.
+  uint64_t m_Deduplicated = 0;
+};
+
+}  // namespace Weaver
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file test_clock.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the tick clock and its sources.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "Core/Clock.h"
+#include "Core/Timer.h"
+
+/**
+ * @brief Tests that both sources are monotonic and measure a sleep like `steady_clock` does.
+ */
+TEST(ClockTest, SourcesAgreeWithSteadyClock) {
+  const Weaver::ClockSource supported = Weaver::Clock::GetSupportedSource();
+  for (Weaver::ClockSource source : {Weaver::ClockSource::SteadyClock, supported}) {
+    Weaver::Clock::SetSource(source);
+    EXPECT_EQ(Weaver::Clock::GetSource(), source);
+    EXPECT_NEAR((double)Weaver::Clock::ToNanoseconds(Weaver::Clock::GetFrequency()), 1e9, 1e3);
+    EXPECT_NEAR(Weaver::Clock::ToSeconds(Weaver::Clock::GetFrequency()), 1.0, 1e-6);
+
+    Weaver::Clock::Ticks previous = Weaver::Clock::Now();
+    for (int i = 0; i < 1000; i++) {
+      const Weaver::Clock::Ticks now = Weaver::Clock::Now();
+      EXPECT_GE(now, previous);
+      previous = now;
+    }
+
+    const auto steady_start = std::chrono::steady_clock::now();
+    Weaver::Timer timer;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const double seconds = timer.elapsed_seconds();
+    const double steady_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - steady_start).count();
+    EXPECT_GE(seconds, 0.019);
+    EXPECT_NEAR(seconds, steady_seconds, steady_seconds * 0.01 + 0.0005);
+    EXPECT_NEAR((double)timer.elapsed_ns() * 1e-9, timer.elapsed_seconds(), 1e-3);
+  }
+  Weaver::Clock::SetSource(supported);
+}
+
+/**
+ * @brief Tests that a source the CPU lacks falls back to `steady_clock`.
+ */
+TEST(ClockTest, FallsBackToSteadyClock) {
+  Weaver::Clock::SetSource(Weaver::ClockSource::Tsc);
+  EXPECT_EQ(Weaver::Clock::GetSource(), Weaver::Clock::GetSupportedSource());
+  if (Weaver::Clock::GetSupportedSource() == Weaver::ClockSource::SteadyClock) {
+    EXPECT_EQ(Weaver::Clock::GetFrequency(), 1000000000u);
+  }
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_coroutine.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the coroutine support and its main-thread scheduler.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "Core/Coroutine.h"
+
+namespace {
+
+/**
+ * @brief Calls `ResumeReady` until a task is done, like the frames of the `Canvas` would.
+ * @return The number of frames it took.
+ */
+template <typename Task>
+int RunFrames(Weaver::CoroutineScheduler& scheduler, const Task& task, uint64_t completed = 0) {
+  int frames = 0;
+  const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!task.IsDone() && std::chrono::steady_clock::now() < give_up) {
+    scheduler.ResumeReady(completed);
+    frames++;
+  }
+  return frames;
+}
+
+Weaver::AsyncTask<int> CountFrames(int frames, std::thread::id& resumed_on) {
+  for (int i = 0; i < frames; i++)
+    co_await Weaver::NextFrame();
+  resumed_on = std::this_thread::get_id();
+  co_return frames;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that a coroutine runs until its first suspension when called and resumes on the
+ * thread that calls `ResumeReady`, once per frame.
+ */
+TEST(CoroutineTest, ResumesOncePerFrame) {
+  Weaver::JobSystem jobs(2);
+  Weaver::CoroutineScheduler scheduler;
+  std::thread::id resumed_on;
+  auto task = CountFrames(3, resumed_on);
+  EXPECT_FALSE(task.IsDone());
+  EXPECT_EQ(scheduler.GetPendingCount(), 1u);
+
+  EXPECT_EQ(scheduler.ResumeReady(0), 1u);
+  EXPECT_EQ(scheduler.ResumeReady(0), 1u);
+  EXPECT_FALSE(task.IsDone());
+  EXPECT_EQ(scheduler.ResumeReady(0), 1u);
+  ASSERT_TRUE(task.IsDone());
+  EXPECT_EQ(task.GetResult(), 3);
+  EXPECT_EQ(resumed_on, std::this_thread::get_id());
+  EXPECT_EQ(scheduler.GetPendingCount(), 0u);
+}
+
+/**
+ * @brief Tests awaiting jobs, background functions, delays and GPU frames.
+ */
+TEST(CoroutineTest, AwaitsJobsDelaysAndFrames) {
+  Weaver::JobSystem jobs(2);
+  Weaver::CoroutineScheduler scheduler;
+  const std::thread::id main_thread = std::this_thread::get_id();
+  std::atomic<bool> job_ran{false};
+  bool resumed_on_main = true;
+
+  // The lambda outlives the coroutine, which refers to its captures.
+  auto make_flow = [&]() -> Weaver::AsyncTask<int> {
+    co_await jobs.Schedule([&]() { job_ran = true; });
+    resumed_on_main &= std::this_thread::get_id() == main_thread;
+
+    const int value = co_await Weaver::RunInBackground([&]() {
+      EXPECT_NE(std::this_thread::get_id(), main_thread);
+      return 41;
+    });
+    resumed_on_main &= std::this_thread::get_id() == main_thread;
+
+    const auto before = std::chrono::steady_clock::now();
+    co_await Weaver::Delay(5.0f);
+    EXPECT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(5));
+
+    co_await Weaver::WaitForGpuFrame(10);
+    co_return value + 1;
+  };
+  auto flow = make_flow();
+
+  // The GPU never finishes frame 10, so the flow stops there.
+  RunFrames(scheduler, flow, 10);
+  EXPECT_FALSE(flow.IsDone());
+  EXPECT_TRUE(job_ran.load());
+  RunFrames(scheduler, flow, 11);
+  ASSERT_TRUE(flow.IsDone());
+  EXPECT_EQ(flow.GetResult(), 42);
+  EXPECT_TRUE(resumed_on_main);
+}
+
+/**
+ * @brief Tests that coroutines can await each other, and that exceptions reach the awaiter.
+ */
+TEST(CoroutineTest, ComposesAndPropagatesExceptions) {
+  Weaver::JobSystem jobs(2);
+  Weaver::CoroutineScheduler scheduler;
+  auto failing = []() -> Weaver::AsyncTask<> {
+    co_await Weaver::NextFrame();
+    throw std::runtime_error("step failed");
+  };
+  auto make_outer = [&]() -> Weaver::AsyncTask<int> {
+    std::thread::id ignored;
+    const int frames = co_await CountFrames(2, ignored);
+    try {
+      co_await failing();
+    } catch (const std::runtime_error&) {
+      co_return frames * 10;
+    }
+    co_return 0;
+  };
+  auto outer = make_outer();
+
+  EXPECT_EQ(RunFrames(scheduler, outer), 3);
+  EXPECT_EQ(outer.GetResult(), 20);
+
+  auto background_failure = []() -> Weaver::AsyncTask<> {
+    co_await Weaver::RunInBackground([]() { throw std::runtime_error("worker failed"); });
+  }();
+  RunFrames(scheduler, background_failure);
+  ASSERT_TRUE(background_failure.IsDone());
+  EXPECT_THROW(background_failure.GetResult(), std::runtime_error);
+}
+
+/**
+ * @brief Tests that destroying the scheduler destroys suspended coroutines and their awaiters.
+ */
+TEST(CoroutineTest, DestroysSuspendedCoroutines) {
+  Weaver::JobSystem jobs(2);
+  int destroyed = 0;
+  struct Guard {
+    int& Count;
+    ~Guard() {
+      Count++;
+    }
+  };
+
+  {
+    Weaver::CoroutineScheduler scheduler;
+    auto inner = [&]() -> Weaver::AsyncTask<> {
+      Guard guard{destroyed};
+      co_await Weaver::Delay(60000.0f);
+    };
+    auto make_outer = [&]() -> Weaver::AsyncTask<> {
+      Guard guard{destroyed};
+      co_await inner();
+    };
+    auto outer = make_outer();
+    scheduler.ResumeReady(0);
+    EXPECT_EQ(destroyed, 0);
+  }
+  EXPECT_EQ(destroyed, 2);
+}
+
+/**
+ * @brief Tests that destroying the scheduler waits for a background job that has not finished,
+ * so its coroutine is destroyed on the destroying thread rather than on the worker.
+ */
+TEST(CoroutineTest, WaitsForBackgroundJobsOnDestruction) {
+  Weaver::JobSystem jobs(2);
+  std::thread::id destroyed_on;
+  std::atomic<bool> finished{false};
+  struct Guard {
+    std::thread::id& DestroyedOn;
+    ~Guard() {
+      DestroyedOn = std::this_thread::get_id();
+    }
+  };
+
+  {
+    Weaver::CoroutineScheduler scheduler;
+    auto work = [&]() -> Weaver::AsyncTask<> {
+      Guard guard{destroyed_on};
+      co_await Weaver::RunInBackground([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished = true;
+      });
+    };
+    auto task = work();
+  }
+  EXPECT_TRUE(finished);
+  EXPECT_EQ(destroyed_on, std::this_thread::get_id());
+}
@@ -0,0 +1,186 @@
+/**
+ * @file test_event_bus.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the typed event bus.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core/EventBus.h"
+
+namespace {
+
+struct PingEvent {
+  int Value = 0;
+};
+
+struct MotionEvent {
+  static constexpr bool Coalesce = true;
+  float X = 0.0f;
+};
+
+struct DragEvent {
+  static constexpr bool Coalesce = true;
+  float X = 0.0f;
+  float DeltaX = 0.0f;
+  void Merge(const DragEvent& older) {
+    DeltaX += older.DeltaX;
+  }
+};
+
+struct UnusedEvent {};
+
+}  // namespace
+
+/**
+ * @brief Tests that events reach only the listeners subscribed to their type, in publishing order.
+ */
+TEST(EventBusTest, DeliversSubscribedTypesInOrder) {
+  Weaver::EventBus bus;
+  Weaver::EventListener listener;
+  std::vector<std::string> received;
+  listener.Subscribe<PingEvent>([&](const PingEvent& event) {
+    received.push_back("ping" + std::to_string(event.Value));
+    return false;
+  });
+  listener.Subscribe<MotionEvent>([&](const MotionEvent&) {
+    received.push_back("motion");
+    return false;
+  });
+
+  bus.Publish(PingEvent{1});
+  bus.Publish(UnusedEvent{});
+  bus.Publish(MotionEvent{});
+  bus.Publish(PingEvent{2});
+  EXPECT_TRUE(received.empty());
+
+  bus.Dispatch({&listener});
+  const std::vector<std::string> expected = {"ping1", "motion", "ping2"};
+  EXPECT_EQ(received, expected);
+  EXPECT_EQ(bus.GetDispatchedCount(), 4u);
+
+  // The queue is empty after a dispatch, and unsubscribed types are no longer delivered.
+  received.clear();
+  listener.Unsubscribe<PingEvent>();
+  bus.Publish(PingEvent{3});
+  bus.Dispatch({&listener});
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(bus.GetDispatchedCount(), 1u);
+}
+
+/**
+ * @brief Tests that delivery stops at the first listener that handles an event.
+ */
+TEST(EventBusTest, HandledEventsStopPropagating) {
+  Weaver::EventBus bus;
+  Weaver::EventListener top;
+  Weaver::EventListener bottom;
+  int top_count = 0;
+  int bottom_count = 0;
+  top.Subscribe<PingEvent>([&](const PingEvent& event) {
+    top_count++;
+    return event.Value == 1;
+  });
+  bottom.Subscribe<PingEvent>([&](const PingEvent&) {
+    bottom_count++;
+    return true;
+  });
+
+  bus.Publish(PingEvent{1});
+  bus.Publish(PingEvent{2});
+  bus.Dispatch({&top, &bottom});
+  EXPECT_EQ(top_count, 2);
+  EXPECT_EQ(bottom_count, 1);
+}
+
+/**
+ * @brief Tests that coalesced events keep only the latest event, at its position.
+ */
+TEST(EventBusTest, CoalescesHighFrequencyEvents) {
+  Weaver::EventBus bus;
+  Weaver::EventListener listener;
+  std::vector<std::string> received;
+  listener.Subscribe<PingEvent>([&](const PingEvent& event) {
+    received.push_back("ping" + std::to_string(event.Value));
+    return false;
+  });
+  listener.Subscribe<MotionEvent>([&](const MotionEvent& event) {
+    received.push_back("motion" + std::to_string((int)event.X));
+    return false;
+  });
+
+  for (int i = 0; i < 100; i++) {
+    bus.Publish(MotionEvent{(float)i});
+    if (i == 50)
+      bus.Publish(PingEvent{1});
+  }
+  bus.Dispatch({&listener});
+  const std::vector<std::string> expected = {"ping1", "motion99"};
+  EXPECT_EQ(received, expected);
+  EXPECT_EQ(bus.GetCoalescedCount(), 99u);
+  EXPECT_EQ(bus.GetDispatchedCount(), 2u);
+}
+
+/**
+ * @brief Tests that coalesced events with a `Merge` member fold the replaced events into the
+ * delivered one.
+ */
+TEST(EventBusTest, MergesCoalescedEvents) {
+  Weaver::EventBus bus;
+  Weaver::EventListener listener;
+  std::vector<DragEvent> received;
+  listener.Subscribe<DragEvent>([&](const DragEvent& event) {
+    received.push_back(event);
+    return false;
+  });
+
+  for (int i = 1; i <= 10; i++)
+    bus.Publish(DragEvent{(float)i, 1.0f});
+  bus.Dispatch({&listener});
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_FLOAT_EQ(received[0].X, 10.0f);
+  EXPECT_FLOAT_EQ(received[0].DeltaX, 10.0f);
+
+  // The next frame starts from zero again.
+  received.clear();
+  bus.Publish(DragEvent{11.0f, 1.0f});
+  bus.Dispatch({&listener});
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_FLOAT_EQ(received[0].DeltaX, 1.0f);
+}
+
+/**
+ * @brief Tests that events published from other threads and from handlers are delivered.
+ */
+TEST(EventBusTest, PublishesFromThreadsAndHandlers) {
+  Weaver::EventBus bus;
+  Weaver::EventListener listener;
+  int sum = 0;
+  listener.Subscribe<PingEvent>([&](const PingEvent& event) {
+    sum += event.Value;
+    if (event.Value == 1000)
+      bus.Publish(PingEvent{1});
+    return true;
+  });
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 250; i++)
+        bus.Publish(PingEvent{1});
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  bus.Publish(PingEvent{1000});
+
+  bus.Dispatch({&listener});
+  EXPECT_EQ(sum, 2000);
+  // The event published by the handler waits for the next dispatch.
+  bus.Dispatch({&listener});
+  EXPECT_EQ(sum, 2001);
+}
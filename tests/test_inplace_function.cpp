@@ -0,0 +1,54 @@
+/**
+ * @file test_inplace_function.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the callable wrapper that stores its callable inline.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <utility>
+
+#include "Core/InplaceFunction.h"
+
+/**
+ * @brief Tests calling, moving and resetting functions with move-only captures.
+ */
+TEST(InplaceFunctionTest, MovesAndCalls) {
+  Weaver::InplaceFunction<int(int)> empty;
+  EXPECT_FALSE(empty);
+
+  auto value = std::make_unique<int>(40);
+  Weaver::InplaceFunction<int(int)> add([value = std::move(value)](int x) { return *value + x; });
+  ASSERT_TRUE(add);
+  EXPECT_EQ(add(2), 42);
+
+  Weaver::InplaceFunction<int(int)> moved(std::move(add));
+  EXPECT_FALSE(add);
+  EXPECT_EQ(moved(1), 41);
+
+  empty = std::move(moved);
+  EXPECT_FALSE(moved);
+  EXPECT_EQ(empty(0), 40);
+  empty.Reset();
+  EXPECT_FALSE(empty);
+}
+
+/**
+ * @brief Tests that the captures are destroyed exactly once, on reset, reassignment or
+ * destruction.
+ */
+TEST(InplaceFunctionTest, DestroysCaptures) {
+  auto tracked = std::make_shared<int>(0);
+  {
+    Weaver::InplaceFunction<void()> first([tracked]() {});
+    Weaver::InplaceFunction<void()> second([tracked]() {});
+    EXPECT_EQ(tracked.use_count(), 3);
+
+    first = std::move(second);
+    EXPECT_EQ(tracked.use_count(), 2);
+    Weaver::InplaceFunction<void()> third(std::move(first));
+    EXPECT_EQ(tracked.use_count(), 2);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
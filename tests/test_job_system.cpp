@@ -0,0 +1,198 @@
+/**
+ * @file test_job_system.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the work-stealing job system.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Core/JobSystem.h"
+
+/**
+ * @brief Tests that jobs taken from one deque by its owner and by thieves are each taken once.
+ */
+TEST(JobSystemTest, DequeHandsOutEveryJobOnce) {
+  constexpr int kJobCount = 100000;
+  std::vector<Weaver::Detail::JobState> jobs(kJobCount);
+  Weaver::Detail::WorkStealingDeque deque(1024);
+  std::vector<std::atomic<int>> taken(kJobCount);
+
+  std::atomic<bool> pushing{true};
+  auto take = [&](Weaver::Detail::JobState* job) { taken[job - jobs.data()]++; };
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < 3; t++) {
+    thieves.emplace_back([&]() {
+      while (pushing.load()) {
+        if (Weaver::Detail::JobState* job = deque.Steal())
+          take(job);
+      }
+      while (Weaver::Detail::JobState* job = deque.Steal())
+        take(job);
+    });
+  }
+
+  for (int i = 0; i < kJobCount; i++) {
+    while (!deque.Push(&jobs[i])) {
+      if (Weaver::Detail::JobState* job = deque.Pop())
+        take(job);
+    }
+    if (i % 3 == 0) {
+      if (Weaver::Detail::JobState* job = deque.Pop())
+        take(job);
+    }
+  }
+  while (Weaver::Detail::JobState* job = deque.Pop())
+    take(job);
+  pushing = false;
+  for (auto& thief : thieves)
+    thief.join();
+
+  for (int i = 0; i < kJobCount; i++)
+    EXPECT_EQ(taken[i].load(), 1) << "job " << i;
+}
+
+/**
+ * @brief Tests that scheduled jobs run and can be waited for.
+ */
+TEST(JobSystemTest, RunsScheduledJobs) {
+  Weaver::JobSystem jobs(4);
+  EXPECT_EQ(jobs.GetWorkerCount(), 4u);
+  EXPECT_EQ(&Weaver::JobSystem::Get(), &jobs);
+
+  std::atomic<int> executed{0};
+  std::vector<Weaver::JobHandle> handles;
+  for (int i = 0; i < 1000; i++)
+    handles.push_back(jobs.Schedule([&]() { executed++; }));
+  for (const auto& handle : handles)
+    jobs.Wait(handle);
+  EXPECT_EQ(executed.load(), 1000);
+  EXPECT_TRUE(handles.front().IsDone());
+}
+
+/**
+ * @brief Tests that a continuation runs only after all of its dependencies.
+ */
+TEST(JobSystemTest, ContinuationsRunAfterDependencies) {
+  Weaver::JobSystem jobs(3);
+  for (int repeat = 0; repeat < 100; repeat++) {
+    std::atomic<int> finished{0};
+    std::vector<Weaver::JobHandle> dependencies;
+    for (int i = 0; i < 8; i++)
+      dependencies.push_back(jobs.Schedule([&]() { finished++; }));
+
+    int seen = -1;
+    Weaver::JobHandle all = jobs.Schedule([&]() { seen = finished.load(); }, dependencies);
+    int chained = 0;
+    Weaver::JobHandle then = jobs.Then(all, [&]() { chained = seen + 1; });
+    jobs.Wait(then);
+    EXPECT_EQ(seen, 8);
+    EXPECT_EQ(chained, 9);
+  }
+}
+
+/**
+ * @brief Tests that jobs scheduled from inside jobs are run, including nested waits.
+ */
+TEST(JobSystemTest, NestedJobs) {
+  Weaver::JobSystem jobs(2);
+  std::atomic<int> leaves{0};
+  Weaver::JobHandle root = jobs.Schedule([&]() {
+    std::vector<Weaver::JobHandle> children;
+    for (int i = 0; i < 16; i++) {
+      children.push_back(jobs.Schedule([&]() {
+        std::vector<Weaver::JobHandle> grandchildren;
+        for (int j = 0; j < 16; j++)
+          grandchildren.push_back(jobs.Schedule([&]() { leaves++; }));
+        for (const auto& grandchild : grandchildren)
+          jobs.Wait(grandchild);
+      }));
+    }
+    for (const auto& child : children)
+      jobs.Wait(child);
+  });
+  jobs.Wait(root);
+  EXPECT_EQ(leaves.load(), 256);
+}
+
+/**
+ * @brief Tests that an exception thrown by a job is rethrown by `Wait`.
+ */
+TEST(JobSystemTest, WaitRethrowsJobExceptions) {
+  Weaver::JobSystem jobs(2);
+  Weaver::JobHandle job = jobs.Schedule([]() { throw std::runtime_error("job failed"); });
+  EXPECT_THROW(jobs.Wait(job), std::runtime_error);
+  EXPECT_THROW(
+      jobs.ParallelFor(0, 1000, [](size_t i) {
+        if (i == 500)
+          throw std::runtime_error("index failed");
+      }),
+      std::runtime_error);
+}
+
+/**
+ * @brief Tests that `ParallelFor` visits every index exactly once.
+ */
+TEST(JobSystemTest, ParallelForVisitsEveryIndex) {
+  Weaver::JobSystem jobs(4);
+  for (size_t grain : {0, 1, 7, 1000}) {
+    std::vector<std::atomic<int>> visits(10007);
+    jobs.ParallelFor(0, visits.size(), [&](size_t i) { visits[i]++; }, grain);
+    for (size_t i = 0; i < visits.size(); i++)
+      ASSERT_EQ(visits[i].load(), 1) << "index " << i << ", grain " << grain;
+  }
+  // Empty ranges do nothing.
+  jobs.ParallelFor(5, 5, [](size_t) { FAIL(); });
+}
+
+/**
+ * @brief Tests that `ParallelReduce` matches a serial reduction.
+ */
+TEST(JobSystemTest, ParallelReduceMatchesSerial) {
+  Weaver::JobSystem jobs(4);
+  std::vector<uint64_t> values(100000);
+  std::iota(values.begin(), values.end(), 1);
+
+  const uint64_t sum = jobs.ParallelReduce(
+      0, values.size(), uint64_t(0), [&](size_t i) { return values[i]; }, std::plus<uint64_t>());
+  EXPECT_EQ(sum, std::accumulate(values.begin(), values.end(), uint64_t(0)));
+
+  const uint64_t max = jobs.ParallelReduce(0,
+      values.size(),
+      uint64_t(0),
+      [&](size_t i) { return values[i] * 7 % 1000; },
+      [](uint64_t a, uint64_t b) { return std::max(a, b); });
+  EXPECT_EQ(max, 999u);
+  EXPECT_EQ(jobs.ParallelReduce(
+                3, 3, 42, [](size_t) { return 0; }, std::plus<int>()),
+      42);
+}
+
+/**
+ * @brief Tests that `ParallelSort` sorts like `std::sort`, for run counts that do not pair up.
+ */
+TEST(JobSystemTest, ParallelSortMatchesStdSort) {
+  for (uint32_t workers : {1u, 2u, 4u}) {
+    Weaver::JobSystem jobs(workers);
+    std::mt19937 random(workers);
+    std::vector<int> values(200003);
+    for (int& value : values)
+      value = (int)(random() % 100000);
+    std::vector<int> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    jobs.ParallelSort(values.begin(), values.end());
+    EXPECT_EQ(values, expected) << workers << " workers";
+
+    jobs.ParallelSort(values.begin(), values.end(), std::greater<int>());
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end(), std::greater<int>()));
+  }
+}
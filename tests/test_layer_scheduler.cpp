@@ -0,0 +1,272 @@
+/**
+ * @file test_layer_scheduler.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the scheduler that runs the layer stack's updates.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Core/JobSystem.h"
+#include "Core/LayerScheduler.h"
+
+namespace {
+
+/**
+ * @brief A layer with configurable traits that runs a callback in `OnUpdate`.
+ */
+class TestLayer : public Weaver::Layer {
+ public:
+  TestLayer(Weaver::LayerUpdateTraits traits, std::function<void()> update)
+      : m_Traits(std::move(traits)), m_Update(std::move(update)) {}
+
+  void OnUpdate(float ts) override {
+    LastTimeStep = ts;
+    m_Update();
+  }
+
+  Weaver::LayerUpdateTraits GetUpdateTraits() const override {
+    return m_Traits;
+  }
+
+  float LastTimeStep = 0.0f;
+
+ private:
+  Weaver::LayerUpdateTraits m_Traits;
+  std::function<void()> m_Update;
+};
+
+/**
+ * @brief Creates traits that declare the given reads and writes.
+ */
+Weaver::LayerUpdateTraits Declare(
+    std::vector<std::string> reads, std::vector<std::string> writes) {
+  Weaver::LayerUpdateTraits traits;
+  traits.Reads = std::move(reads);
+  traits.Writes = std::move(writes);
+  return traits;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that layers without traits run on the calling thread, in stack order.
+ */
+TEST(LayerSchedulerTest, UndeclaredLayersRunInOrderOnMainThread) {
+  const std::thread::id main_thread = std::this_thread::get_id();
+  std::vector<int> order;
+  std::vector<std::shared_ptr<Weaver::Layer>> layers;
+  for (int i = 0; i < 3; i++) {
+    layers.push_back(std::make_shared<TestLayer>(Weaver::LayerUpdateTraits(), [&, i]() {
+      EXPECT_EQ(std::this_thread::get_id(), main_thread);
+      order.push_back(i);
+    }));
+  }
+
+  Weaver::JobSystem jobs(2);
+  Weaver::LayerScheduler scheduler(jobs);
+  scheduler.Update(layers, 0.0f);
+  EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+  EXPECT_EQ(scheduler.GetStageCount(), 3u);
+  EXPECT_EQ(scheduler.GetUpdateTimes().size(), 3u);
+}
+
+/**
+ * @brief Tests that independent layers are updated at the same time.
+ */
+TEST(LayerSchedulerTest, IndependentLayersRunConcurrently) {
+  constexpr int kLayerCount = 3;
+  std::atomic<int> started{0};
+  std::atomic<bool> overlapped{true};
+  Weaver::LayerUpdateTraits independent;
+  independent.Independent = true;
+
+  std::vector<std::shared_ptr<Weaver::Layer>> layers;
+  for (int i = 0; i < kLayerCount; i++) {
+    layers.push_back(std::make_shared<TestLayer>(independent, [&]() {
+      // Every layer waits until all of them have started, which only happens concurrently.
+      started++;
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (started.load() < kLayerCount) {
+        if (std::chrono::steady_clock::now() > deadline) {
+          overlapped = false;
+          return;
+        }
+        std::this_thread::yield();
+      }
+    }));
+  }
+
+  Weaver::JobSystem jobs(kLayerCount - 1);
+  Weaver::LayerScheduler scheduler(jobs);
+  scheduler.Update(layers, 0.0f);
+  EXPECT_TRUE(overlapped.load());
+  EXPECT_EQ(scheduler.GetStageCount(), 1u);
+}
+
+/**
+ * @brief Tests that a layer reading data runs after an earlier layer that writes it.
+ */
+TEST(LayerSchedulerTest, ConflictingLayersKeepStackOrder) {
+  std::mutex mutex;
+  std::vector<int> order;
+  auto record = [&](int i) {
+    return [&, i]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(i == 0 ? 20 : 0));
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+    };
+  };
+
+  std::vector<std::shared_ptr<Weaver::Layer>> layers;
+  layers.push_back(std::make_shared<TestLayer>(Declare({}, {"terrain"}), record(0)));
+  layers.push_back(std::make_shared<TestLayer>(Declare({"terrain"}, {"agents"}), record(1)));
+  layers.push_back(std::make_shared<TestLayer>(Declare({}, {"weather"}), record(2)));
+
+  Weaver::JobSystem jobs(2);
+  Weaver::LayerScheduler scheduler(jobs);
+  scheduler.Update(layers, 0.0f);
+  ASSERT_EQ(order.size(), 3u);
+  EXPECT_LT(std::find(order.begin(), order.end(), 0), std::find(order.begin(), order.end(), 1));
+  // The writers of "terrain" and "weather" share the first stage, the reader follows.
+  EXPECT_EQ(scheduler.GetStageCount(), 2u);
+}
+
+/**
+ * @brief Tests that an exception thrown by a layer on a worker reaches the caller.
+ */
+TEST(LayerSchedulerTest, RethrowsLayerExceptions) {
+  Weaver::LayerUpdateTraits independent;
+  independent.Independent = true;
+  std::vector<std::shared_ptr<Weaver::Layer>> layers;
+  layers.push_back(std::make_shared<TestLayer>(independent, []() {}));
+  layers.push_back(std::make_shared<TestLayer>(
+      independent, []() { throw std::runtime_error("update failed"); }));
+
+  Weaver::JobSystem jobs(1);
+  Weaver::LayerScheduler scheduler(jobs);
+  EXPECT_THROW(scheduler.Update(layers, 0.0f), std::runtime_error);
+}
+
+/**
+ * @brief Tests that a fixed-rate layer updates at its rate with the time since its last update.
+ */
+TEST(LayerSchedulerTest, FixedRateLayersSkipFrames) {
+  Weaver::JobSystem jobs(2);
+  Weaver::LayerScheduler scheduler(jobs);
+
+  Weaver::LayerUpdateTraits slow;
+  slow.UpdateMode = Weaver::LayerUpdateMode::FixedRate;
+  slow.UpdateRate = 4.0f;
+  int slow_updates = 0;
+  int fast_updates = 0;
+  auto slow_layer = std::make_shared<TestLayer>(slow, [&]() { slow_updates++; });
+  std::vector<std::shared_ptr<Weaver::Layer>> layers = {slow_layer,
+      std::make_shared<TestLayer>(Weaver::LayerUpdateTraits(), [&]() { fast_updates++; })};
+
+  // One second at 64 frames per second: the first frame, then every sixteenth.
+  for (int frame = 0; frame < 64; frame++)
+    scheduler.Update(layers, 1.0f / 64.0f);
+  EXPECT_EQ(fast_updates, 64);
+  EXPECT_EQ(slow_updates, 4);
+  EXPECT_FLOAT_EQ(slow_layer->LastTimeStep, 0.25f);
+  EXPECT_EQ(scheduler.GetUpdatedLayerCount(), 1u);
+}
+
+/**
+ * @brief Tests that a fixed-rate layer keeps its rate on average when the rate does not divide
+ * the frame rate, and that it does not update every frame to catch up after a stall.
+ */
+TEST(LayerSchedulerTest, FixedRateLayersKeepAverageRate) {
+  Weaver::JobSystem jobs(2);
+  Weaver::LayerScheduler scheduler(jobs);
+
+  Weaver::LayerUpdateTraits traits;
+  traits.Independent = true;
+  traits.UpdateMode = Weaver::LayerUpdateMode::FixedRate;
+  traits.UpdateRate = 5.0f;
+  int updates = 0;
+  std::vector<std::shared_ptr<Weaver::Layer>> layers = {
+      std::make_shared<TestLayer>(traits, [&]() { updates++; })};
+
+  // 100 seconds at 60 frames per second: 500 updates after the first.
+  for (int frame = 0; frame < 6000; frame++)
+    scheduler.Update(layers, 1.0f / 60.0f);
+  EXPECT_NEAR(updates, 501, 1);
+
+  // A two second stall updates once, then the rate resumes.
+  updates = 0;
+  scheduler.Update(layers, 2.0f);
+  for (int frame = 0; frame < 60; frame++)
+    scheduler.Update(layers, 1.0f / 60.0f);
+  EXPECT_NEAR(updates, 6, 1);
+}
+
+/**
+ * @brief Tests that the measured wall time drives fixed-rate layers at their rate whatever the
+ * frame rate, and that every-frame layers receive the real frame time.
+ */
+TEST(LayerSchedulerTest, FixedRateLayersFollowWallTime) {
+  for (const int frame_ms : {5, 40}) {
+    Weaver::JobSystem jobs(2);
+    Weaver::LayerScheduler scheduler(jobs);
+
+    Weaver::LayerUpdateTraits traits;
+    traits.UpdateMode = Weaver::LayerUpdateMode::FixedRate;
+    traits.UpdateRate = 10.0f;
+    int updates = 0;
+    float total_time = 0.0f;
+    std::shared_ptr<TestLayer> frame_layer;
+    frame_layer = std::make_shared<TestLayer>(
+        Weaver::LayerUpdateTraits(), [&]() { total_time += frame_layer->LastTimeStep; });
+    std::vector<std::shared_ptr<Weaver::Layer>> layers = {
+        std::make_shared<TestLayer>(traits, [&]() { updates++; }), frame_layer};
+
+    const auto start = std::chrono::steady_clock::now();
+    scheduler.Update(layers);
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(frame_ms));
+      scheduler.Update(layers);
+    }
+    const float elapsed =
+        std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+    // The first frame, then one update per tenth of a second.
+    EXPECT_NEAR(updates, 1 + (int)(elapsed * 10.0f), 1) << frame_ms << " ms frames";
+    EXPECT_NEAR(total_time, elapsed, 0.05f) << frame_ms << " ms frames";
+  }
+}
+
+/**
+ * @brief Tests that an on-request layer updates once initially and then only when requested.
+ */
+TEST(LayerSchedulerTest, OnRequestLayersUpdateWhenRequested) {
+  Weaver::JobSystem jobs(2);
+  Weaver::LayerScheduler scheduler(jobs);
+
+  Weaver::LayerUpdateTraits traits;
+  traits.Independent = true;
+  traits.UpdateMode = Weaver::LayerUpdateMode::OnRequest;
+  int updates = 0;
+  auto layer = std::make_shared<TestLayer>(traits, [&]() { updates++; });
+  std::vector<std::shared_ptr<Weaver::Layer>> layers = {layer};
+
+  scheduler.Update(layers, 0.01f);
+  scheduler.Update(layers, 0.01f);
+  EXPECT_EQ(updates, 1);
+  EXPECT_EQ(scheduler.GetUpdatedLayerCount(), 0u);
+
+  std::thread([&]() { layer->RequestUpdate(); }).join();
+  scheduler.Update(layers, 0.01f);
+  scheduler.Update(layers, 0.01f);
+  EXPECT_EQ(updates, 2);
+}
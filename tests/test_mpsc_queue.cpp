@@ -0,0 +1,147 @@
+/**
+ * @file test_mpsc_queue.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the lock-free multi-producer, single-consumer queue.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Core/MpscQueue.h"
+
+/**
+ * @brief Tests that items pushed from one thread are taken in push order.
+ */
+TEST(MpscQueueTest, PreservesPushOrder) {
+  Weaver::MpscQueue<int> queue;
+  EXPECT_TRUE(queue.IsEmpty());
+  for (int i = 0; i < 100; i++)
+    queue.Push(int(i));
+  EXPECT_FALSE(queue.IsEmpty());
+
+  std::vector<int> items;
+  queue.PopAll(items);
+  ASSERT_EQ(items.size(), 100u);
+  for (int i = 0; i < 100; i++)
+    EXPECT_EQ(items[i], i);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+/**
+ * @brief Tests that no item is lost or duplicated when many threads push concurrently.
+ */
+TEST(MpscQueueTest, ConcurrentProducers) {
+  constexpr int kThreadCount = 8;
+  constexpr int kItemsPerThread = 10000;
+  Weaver::MpscQueue<int> queue;
+
+  std::vector<int> items;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreadCount; t++) {
+    producers.emplace_back([&queue, t]() {
+      for (int i = 0; i < kItemsPerThread; i++)
+        queue.Push(t * kItemsPerThread + i);
+    });
+  }
+  // Consume while the producers are still running.
+  for (int i = 0; i < 100; i++)
+    queue.PopAll(items);
+  for (auto& producer : producers)
+    producer.join();
+  queue.PopAll(items);
+
+  ASSERT_EQ(items.size(), (size_t)kThreadCount * kItemsPerThread);
+  std::vector<int> last(kThreadCount, -1);
+  std::vector<bool> seen(items.size(), false);
+  for (int item : items) {
+    EXPECT_FALSE(seen[item]);
+    seen[item] = true;
+    // Items of one producer keep their order.
+    const int thread = item / kItemsPerThread;
+    EXPECT_GT(item, last[thread]);
+    last[thread] = item;
+  }
+}
+
+/**
+ * @brief Tests that items that are never taken are destroyed with the queue.
+ */
+TEST(MpscQueueTest, DestroysRemainingItems) {
+  auto tracked = std::make_shared<int>(0);
+  {
+    Weaver::MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(std::shared_ptr<int>(tracked));
+    EXPECT_EQ(tracked.use_count(), 2);
+  }
+  EXPECT_EQ(tracked.use_count(), 1);
+}
+
+/**
+ * @brief Tests that the bounded queue keeps order, refuses items when full and accepts them again
+ * once the consumer made room.
+ */
+TEST(BoundedMpscQueueTest, RefusesItemsWhenFull) {
+  Weaver::BoundedMpscQueue<std::unique_ptr<int>, 4> queue;
+  EXPECT_EQ(queue.GetCapacity(), 4u);
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(queue.TryPush(std::make_unique<int>(i)));
+
+  auto refused = std::make_unique<int>(4);
+  EXPECT_FALSE(queue.TryPush(std::move(refused)));
+  ASSERT_NE(refused, nullptr);
+  EXPECT_EQ(queue.GetSize(), 4u);
+
+  std::unique_ptr<int> item;
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(*item, 0);
+  EXPECT_TRUE(queue.TryPush(std::move(refused)));
+  for (int i = 1; i <= 4; i++) {
+    ASSERT_TRUE(queue.TryPop(item));
+    EXPECT_EQ(*item, i);
+  }
+  EXPECT_FALSE(queue.TryPop(item));
+  EXPECT_EQ(queue.GetSize(), 0u);
+}
+
+/**
+ * @brief Tests that no item is lost or duplicated when many threads push into a small ring while
+ * the consumer pops.
+ */
+TEST(BoundedMpscQueueTest, ConcurrentProducers) {
+  constexpr int kThreadCount = 8;
+  constexpr int kItemsPerThread = 10000;
+  Weaver::BoundedMpscQueue<int, 64> queue;
+
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreadCount; t++) {
+    producers.emplace_back([&queue, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        while (!queue.TryPush(t * kItemsPerThread + i))
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  std::vector<int> items;
+  int item = 0;
+  while (items.size() < (size_t)kThreadCount * kItemsPerThread) {
+    if (queue.TryPop(item))
+      items.push_back(item);
+  }
+  for (auto& producer : producers)
+    producer.join();
+  EXPECT_FALSE(queue.TryPop(item));
+
+  std::vector<int> last(kThreadCount, -1);
+  std::vector<bool> seen(items.size(), false);
+  for (int value : items) {
+    EXPECT_FALSE(seen[value]);
+    seen[value] = true;
+    const int thread = value / kItemsPerThread;
+    EXPECT_GT(value, last[thread]);
+    last[thread] = value;
+  }
+}
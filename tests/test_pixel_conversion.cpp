@@ -0,0 +1,230 @@
+/**
+ * @file test_pixel_conversion.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the pixel conversion kernels.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "Core/PixelConversion.h"
+
+using Weaver::PixelConversion;
+using Weaver::SimdLevel;
+
+namespace {
+
+// Odd sizes exercise both the vector loops and their scalar tails.
+constexpr size_t kPixelCount = 1037;
+
+/**
+ * @brief Runs a kernel under every supported SIMD level and restores the original level.
+ */
+template <typename Kernel>
+void ForEachSimdLevel(Kernel kernel) {
+  const SimdLevel original = PixelConversion::GetSimdLevel();
+  for (int level = 0; level <= (int)PixelConversion::GetSupportedSimdLevel(); level++) {
+    PixelConversion::SetSimdLevel((SimdLevel)level);
+    SCOPED_TRACE("SIMD level " + std::to_string(level));
+    kernel();
+  }
+  PixelConversion::SetSimdLevel(original);
+}
+
+std::vector<uint8_t> RandomBytes(size_t count) {
+  std::mt19937 random(42);
+  std::vector<uint8_t> bytes(count);
+  for (uint8_t& byte : bytes)
+    byte = (uint8_t)random();
+  return bytes;
+}
+
+std::vector<float> RandomFloats(size_t count, float min, float max) {
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> distribution(min, max);
+  std::vector<float> values(count);
+  for (float& value : values)
+    value = distribution(random);
+  return values;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that RGB pixels are expanded with an opaque alpha.
+ */
+TEST(PixelConversionTest, RGBToRGBA) {
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 3);
+  ForEachSimdLevel([&]() {
+    std::vector<uint8_t> destination(kPixelCount * 4);
+    PixelConversion::RGBToRGBA(source.data(), destination.data(), kPixelCount);
+    for (size_t i = 0; i < kPixelCount; i++) {
+      ASSERT_EQ(destination[i * 4 + 0], source[i * 3 + 0]);
+      ASSERT_EQ(destination[i * 4 + 1], source[i * 3 + 1]);
+      ASSERT_EQ(destination[i * 4 + 2], source[i * 3 + 2]);
+      ASSERT_EQ(destination[i * 4 + 3], 255);
+    }
+  });
+}
+
+/**
+ * @brief Tests that the red and blue channels are swapped, also in place.
+ */
+TEST(PixelConversionTest, SwizzleRB) {
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 4);
+  ForEachSimdLevel([&]() {
+    std::vector<uint8_t> destination = source;
+    PixelConversion::SwizzleRB(destination.data(), destination.data(), kPixelCount);
+    for (size_t i = 0; i < kPixelCount; i++) {
+      ASSERT_EQ(destination[i * 4 + 0], source[i * 4 + 2]);
+      ASSERT_EQ(destination[i * 4 + 1], source[i * 4 + 1]);
+      ASSERT_EQ(destination[i * 4 + 2], source[i * 4 + 0]);
+      ASSERT_EQ(destination[i * 4 + 3], source[i * 4 + 3]);
+    }
+  });
+}
+
+/**
+ * @brief Tests the single value half float conversions against known bit patterns.
+ */
+TEST(PixelConversionTest, HalfFloatValues) {
+  EXPECT_EQ(PixelConversion::FloatToHalf(0.0f), 0x0000);
+  EXPECT_EQ(PixelConversion::FloatToHalf(-0.0f), 0x8000);
+  EXPECT_EQ(PixelConversion::FloatToHalf(1.0f), 0x3C00);
+  EXPECT_EQ(PixelConversion::FloatToHalf(-2.0f), 0xC000);
+  EXPECT_EQ(PixelConversion::FloatToHalf(65504.0f), 0x7BFF);
+  EXPECT_EQ(PixelConversion::FloatToHalf(65520.0f), 0x7C00);
+  EXPECT_EQ(PixelConversion::FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+  // Halfway between 1 and the next half rounds to even.
+  EXPECT_EQ(PixelConversion::FloatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3C00);
+  EXPECT_EQ(PixelConversion::HalfToFloat(0x3C00), 1.0f);
+  EXPECT_EQ(PixelConversion::HalfToFloat(0x0001), std::ldexp(1.0f, -24));
+  EXPECT_TRUE(std::isinf(PixelConversion::HalfToFloat(0xFC00)));
+  EXPECT_TRUE(std::isnan(PixelConversion::HalfToFloat(0x7E00)));
+}
+
+/**
+ * @brief Tests that every half float survives a round trip through float at every SIMD level.
+ */
+TEST(PixelConversionTest, HalfFloatRoundTrip) {
+  std::vector<uint16_t> halves(65536);
+  for (size_t i = 0; i < halves.size(); i++)
+    halves[i] = (uint16_t)i;
+
+  ForEachSimdLevel([&]() {
+    std::vector<float> floats(halves.size());
+    std::vector<uint16_t> round_trip(halves.size());
+    PixelConversion::HalfToFloat(halves.data(), floats.data(), halves.size());
+    PixelConversion::FloatToHalf(floats.data(), round_trip.data(), floats.size());
+
+    for (size_t i = 0; i < halves.size(); i++) {
+      if (std::isnan(PixelConversion::HalfToFloat(halves[i]))) {
+        ASSERT_TRUE(std::isnan(floats[i])) << "half " << i;
+        ASSERT_TRUE(std::isnan(PixelConversion::HalfToFloat(round_trip[i]))) << "half " << i;
+      } else {
+        ASSERT_EQ(floats[i], PixelConversion::HalfToFloat(halves[i])) << "half " << i;
+        ASSERT_EQ(round_trip[i], halves[i]) << "half " << i;
+      }
+    }
+  });
+}
+
+/**
+ * @brief Tests that the vector float to half kernels round like the scalar conversion.
+ */
+TEST(PixelConversionTest, FloatToHalfMatchesScalar) {
+  std::vector<float> source = RandomFloats(kPixelCount * 4, -70000.0f, 70000.0f);
+  const std::vector<float> small = RandomFloats(kPixelCount, -1e-4f, 1e-4f);
+  source.insert(source.end(), small.begin(), small.end());
+  source.push_back(std::numeric_limits<float>::infinity());
+  source.push_back(-std::numeric_limits<float>::infinity());
+
+  ForEachSimdLevel([&]() {
+    std::vector<uint16_t> destination(source.size());
+    PixelConversion::FloatToHalf(source.data(), destination.data(), source.size());
+    for (size_t i = 0; i < source.size(); i++)
+      ASSERT_EQ(destination[i], PixelConversion::FloatToHalf(source[i])) << source[i];
+  });
+}
+
+/**
+ * @brief Tests that floats are clamped and rounded to unorm values, with NaN as zero.
+ */
+TEST(PixelConversionTest, FloatToUnorm8) {
+  std::vector<float> source = RandomFloats(kPixelCount * 4, -0.5f, 1.5f);
+  source[0] = std::numeric_limits<float>::quiet_NaN();
+  source[1] = 0.5f / 255.0f;
+  source[2] = 1.0f;
+
+  ForEachSimdLevel([&]() {
+    std::vector<uint8_t> destination(source.size());
+    PixelConversion::FloatToUnorm8(source.data(), destination.data(), source.size());
+    EXPECT_EQ(destination[0], 0);
+    EXPECT_EQ(destination[1], 1);
+    EXPECT_EQ(destination[2], 255);
+    for (size_t i = 3; i < source.size(); i++) {
+      const float clamped = std::fmin(std::fmax(source[i], 0.0f), 1.0f);
+      ASSERT_EQ(destination[i], (uint8_t)(clamped * 255.0f + 0.5f)) << source[i];
+    }
+  });
+}
+
+/**
+ * @brief Tests that premultiplication rounds exactly and keeps alpha.
+ */
+TEST(PixelConversionTest, PremultiplyAlpha) {
+  const std::vector<uint8_t> source = RandomBytes(kPixelCount * 4);
+  ForEachSimdLevel([&]() {
+    std::vector<uint8_t> destination(source.size());
+    PixelConversion::PremultiplyAlpha(source.data(), destination.data(), kPixelCount);
+    for (size_t i = 0; i < kPixelCount; i++) {
+      const int alpha = source[i * 4 + 3];
+      for (size_t c = 0; c < 3; c++) {
+        const int expected = (int)std::lround(source[i * 4 + c] * alpha / 255.0);
+        ASSERT_EQ(destination[i * 4 + c], expected);
+      }
+      ASSERT_EQ(destination[i * 4 + 3], alpha);
+    }
+  });
+}
+
+/**
+ * @brief Tests that sRGB encoding is within one step of the exact transfer function.
+ */
+TEST(PixelConversionTest, LinearToSRGB) {
+  const std::vector<float> source = RandomFloats(kPixelCount * 4, -0.1f, 1.1f);
+  ForEachSimdLevel([&]() {
+    std::vector<uint8_t> destination(source.size());
+    PixelConversion::LinearToSRGB(source.data(), destination.data(), kPixelCount);
+    for (size_t i = 0; i < source.size(); i++) {
+      const double linear = std::fmin(std::fmax(source[i], 0.0), 1.0);
+      const double srgb = (i % 4 == 3)            ? linear
+                          : linear <= 0.0031308 ? linear * 12.92
+                                                : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+      ASSERT_NEAR(destination[i], srgb * 255.0, 1.0) << source[i];
+    }
+  });
+}
+
+/**
+ * @brief Tests that sRGB decoding inverts encoding.
+ */
+TEST(PixelConversionTest, SRGBRoundTrip) {
+  std::vector<uint8_t> source(256 * 4);
+  for (size_t i = 0; i < source.size(); i++)
+    source[i] = (uint8_t)(i / 4);
+
+  ForEachSimdLevel([&]() {
+    std::vector<float> linear(source.size());
+    std::vector<uint8_t> round_trip(source.size());
+    PixelConversion::SRGBToLinear(source.data(), linear.data(), 256);
+    PixelConversion::LinearToSRGB(linear.data(), round_trip.data(), 256);
+    EXPECT_EQ(round_trip, source);
+    EXPECT_FLOAT_EQ(linear[255 * 4], 1.0f);
+    EXPECT_FLOAT_EQ(linear[3], 0.0f);
+  });
+}
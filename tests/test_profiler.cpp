@@ -0,0 +1,132 @@
+/**
+ * @file test_profiler.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the instrumentation profiler and its Chrome trace export.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core/Clock.h"
+#include "Core/Profiler.h"
+
+namespace {
+
+/**
+ * @brief Counts the occurrences of a string in a text.
+ */
+size_t CountOccurrences(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t position = text.find(pattern); position != std::string::npos;
+       position = text.find(pattern, position + pattern.size()))
+    count++;
+  return count;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that nested scopes and frame markers are exported in order, and that nothing is
+ * recorded outside a session.
+ */
+TEST(ProfilerTest, ExportsNestedScopes) {
+  Weaver::Profiler::EndSession();
+  { Weaver::ProfileScope ignored("Ignored"); }
+
+  Weaver::Profiler::BeginSession();
+  EXPECT_TRUE(Weaver::Profiler::IsActive());
+  Weaver::Profiler::SetThreadName("Test \"Main\"");
+  Weaver::Profiler::MarkFrame(7);
+  {
+    Weaver::ProfileScope outer("Outer");
+    Weaver::ProfileScope inner("Inner");
+  }
+  Weaver::Profiler::EndSession();
+  { Weaver::ProfileScope ignored("Ignored"); }
+  EXPECT_EQ(Weaver::Profiler::GetEventCount(), 5u);
+
+  std::ostringstream stream;
+  Weaver::Profiler::WriteChromeTrace(stream);
+  const std::string trace = stream.str();
+  EXPECT_EQ(trace.find("Ignored"), std::string::npos);
+  EXPECT_NE(trace.find("\"args\":{\"name\":\"Test \\\"Main\\\"\"}"), std::string::npos);
+  EXPECT_NE(trace.find("\"args\":{\"frame\":7}"), std::string::npos);
+
+  const size_t outer_begin = trace.find("{\"name\":\"Outer\",\"ph\":\"B\"");
+  const size_t inner_begin = trace.find("{\"name\":\"Inner\",\"ph\":\"B\"");
+  const size_t inner_end = trace.find("{\"name\":\"Inner\",\"ph\":\"E\"");
+  const size_t outer_end = trace.find("{\"name\":\"Outer\",\"ph\":\"E\"");
+  ASSERT_NE(outer_end, std::string::npos);
+  EXPECT_LT(outer_begin, inner_begin);
+  EXPECT_LT(inner_begin, inner_end);
+  EXPECT_LT(inner_end, outer_end);
+}
+
+/**
+ * @brief Tests that every thread records into its own track, with begins and ends balanced, and
+ * that a new session discards the old events.
+ */
+TEST(ProfilerTest, RecordsThreadsSeparately) {
+  constexpr int kThreadCount = 4;
+  constexpr int kScopesPerThread = 5000;
+  Weaver::Profiler::BeginSession();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; t++) {
+    threads.emplace_back([t]() {
+      Weaver::Profiler::SetThreadName("Worker " + std::to_string(t));
+      for (int i = 0; i < kScopesPerThread; i++) {
+        Weaver::ProfileScope scope("Work");
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  Weaver::Profiler::EndSession();
+
+  EXPECT_EQ(Weaver::Profiler::GetEventCount(), (size_t)kThreadCount * kScopesPerThread * 2);
+  EXPECT_EQ(Weaver::Profiler::GetDroppedEventCount(), 0u);
+  std::ostringstream stream;
+  Weaver::Profiler::WriteChromeTrace(stream);
+  const std::string trace = stream.str();
+  EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"M\""), (size_t)kThreadCount);
+  EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"B\""), (size_t)kThreadCount * kScopesPerThread);
+  EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"E\""), (size_t)kThreadCount * kScopesPerThread);
+  EXPECT_EQ(trace.find("Outer"), std::string::npos);
+
+  Weaver::Profiler::BeginSession();
+  Weaver::Profiler::EndSession();
+  EXPECT_EQ(Weaver::Profiler::GetEventCount(), 0u);
+}
+
+/**
+ * @brief Tests that spans recorded on a track are exported on a row of their own, under the
+ * track's name, and that interned names stay valid after their source is gone.
+ */
+TEST(ProfilerTest, RecordsSpansOnTracks) {
+  const uint32_t track = Weaver::Profiler::GetTrack("Graph Critical Path");
+  EXPECT_EQ(Weaver::Profiler::GetTrack("Graph Critical Path"), track);
+  const char* name = Weaver::Profiler::Intern(std::string("Aggregate"));
+  EXPECT_EQ(Weaver::Profiler::Intern("Aggregate"), name);
+
+  Weaver::Profiler::RecordSpan(track, name, 1, 2);
+  Weaver::Profiler::BeginSession();
+  const uint64_t begin = Weaver::Clock::Now();
+  Weaver::Profiler::RecordSpan(track, name, begin, begin + 10);
+  Weaver::Profiler::RecordSpan(track, "Build", begin + 10, begin + 20);
+  Weaver::Profiler::EndSession();
+  EXPECT_EQ(Weaver::Profiler::GetEventCount(), 4u);
+
+  std::ostringstream stream;
+  Weaver::Profiler::WriteChromeTrace(stream);
+  const std::string trace = stream.str();
+  EXPECT_NE(trace.find("\"args\":{\"name\":\"Graph Critical Path\"}"), std::string::npos);
+  const size_t aggregate = trace.find("{\"name\":\"Aggregate\",\"ph\":\"B\"");
+  const size_t build = trace.find("{\"name\":\"Build\",\"ph\":\"B\"");
+  ASSERT_NE(build, std::string::npos);
+  EXPECT_LT(aggregate, build);
+}
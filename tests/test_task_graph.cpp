@@ -0,0 +1,129 @@
+/**
+ * @file test_task_graph.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the reusable task graph.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Core/TaskGraph.h"
+
+/**
+ * @brief Tests that every task runs after its dependencies, on every run of the same graph.
+ */
+TEST(TaskGraphTest, RunsTasksAfterDependencies) {
+  Weaver::JobSystem jobs(4);
+  Weaver::TaskGraph graph("Plot");
+
+  std::atomic<int> ingested{0};
+  int aggregated = 0;
+  int built = 0;
+  std::vector<Weaver::TaskGraph::TaskId> ingest;
+  for (int i = 0; i < 8; i++)
+    ingest.push_back(graph.AddTask("Ingest", [&]() { ingested++; }));
+  const auto aggregate =
+      graph.AddTask("Aggregate", [&]() { aggregated = ingested.load(); }, ingest);
+  graph.AddTask("Build", [&]() { built = aggregated + 1; }, {aggregate});
+  EXPECT_EQ(graph.GetTaskCount(), 10u);
+
+  for (int run = 1; run <= 50; run++) {
+    graph.Run(jobs);
+    EXPECT_FALSE(graph.IsRunning());
+    EXPECT_EQ(aggregated, 8 * run);
+    EXPECT_EQ(built, 8 * run + 1);
+    ingested = 8 * run;
+  }
+  EXPECT_EQ(graph.GetSkippedCount(), 0u);
+}
+
+/**
+ * @brief Tests that independent tasks run at the same time.
+ */
+TEST(TaskGraphTest, RunsIndependentTasksInParallel) {
+  Weaver::JobSystem jobs(3);
+  Weaver::TaskGraph graph;
+  std::atomic<int> arrived{0};
+  for (int i = 0; i < 2; i++) {
+    graph.AddTask("Barrier", [&]() {
+      arrived++;
+      const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (arrived.load() < 2 && std::chrono::steady_clock::now() < give_up)
+        std::this_thread::yield();
+    });
+  }
+  graph.Run(jobs);
+  EXPECT_EQ(arrived.load(), 2);
+  EXPECT_LT(graph.GetDuration(), 5000.0f);
+}
+
+/**
+ * @brief Tests that skippable tasks past the deadline are skipped with their dependents.
+ */
+TEST(TaskGraphTest, SkipsTasksAfterDeadline) {
+  Weaver::JobSystem jobs(2);
+  Weaver::TaskGraph graph;
+  bool required = false;
+  bool optional = false;
+  bool dependent = false;
+  graph.AddTask("Required", [&]() { required = true; });
+  const auto skippable = graph.AddTask("Optional", [&]() { optional = true; }, {}, true);
+  graph.AddTask("Dependent", [&]() { dependent = true; }, {skippable});
+
+  graph.Run(jobs, std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+  EXPECT_TRUE(required);
+  EXPECT_FALSE(optional);
+  EXPECT_FALSE(dependent);
+  EXPECT_EQ(graph.GetSkippedCount(), 2u);
+  EXPECT_TRUE(graph.GetTimings()[1].Skipped);
+
+  graph.Run(jobs);
+  EXPECT_TRUE(optional);
+  EXPECT_TRUE(dependent);
+  EXPECT_EQ(graph.GetSkippedCount(), 0u);
+}
+
+/**
+ * @brief Tests that the critical path follows the dependencies that finished last.
+ */
+TEST(TaskGraphTest, FindsCriticalPath) {
+  Weaver::JobSystem jobs(4);
+  Weaver::TaskGraph graph;
+  auto sleep = [](int ms) {
+    return [ms]() { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); };
+  };
+  const auto fast = graph.AddTask("Fast", sleep(1));
+  const auto slow = graph.AddTask("Slow", sleep(30));
+  const auto join = graph.AddTask("Join", sleep(1), {fast, slow});
+  graph.AddTask("Side", sleep(1), {fast});
+
+  graph.Run(jobs);
+  const std::vector<Weaver::TaskGraph::TaskId> expected = {slow, join};
+  EXPECT_EQ(graph.GetCriticalPath(), expected);
+  const auto& timings = graph.GetTimings();
+  EXPECT_GE(timings[join].Start, timings[slow].End);
+  EXPECT_GE(graph.GetDuration(), timings[join].End);
+}
+
+/**
+ * @brief Tests that an exception is rethrown by `Wait` and that the dependents of the task are
+ * skipped.
+ */
+TEST(TaskGraphTest, RethrowsTaskExceptions) {
+  Weaver::JobSystem jobs(2);
+  Weaver::TaskGraph graph;
+  bool dependent = false;
+  const auto failing = graph.AddTask("Failing", []() { throw std::runtime_error("task failed"); });
+  graph.AddTask("Dependent", [&]() { dependent = true; }, {failing});
+
+  EXPECT_THROW(graph.Run(jobs), std::runtime_error);
+  EXPECT_FALSE(graph.IsRunning());
+  EXPECT_FALSE(dependent);
+  EXPECT_TRUE(graph.GetTimings()[1].Skipped);
+  EXPECT_THROW(graph.AddTask("Cycle", []() {}, {5}), std::invalid_argument);
+}
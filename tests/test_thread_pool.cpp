@@ -0,0 +1,46 @@
+/**
+ * @file test_thread_pool.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the worker thread pool.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "Core/ThreadPool.h"
+
+/**
+ * @brief Tests that every submitted task is executed.
+ */
+TEST(ThreadPoolTest, ExecutesAllTasks) {
+  constexpr int kTaskCount = 1000;
+  std::atomic<int> executed{0};
+  std::mutex mutex;
+  std::condition_variable done;
+
+  Weaver::ThreadPool pool(4);
+  EXPECT_EQ(pool.GetWorkerCount(), 4u);
+  for (int i = 0; i < kTaskCount; i++) {
+    pool.Submit([&]() {
+      if (executed.fetch_add(1) + 1 == kTaskCount) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_one();
+      }
+    });
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&]() { return executed.load() == kTaskCount; });
+  EXPECT_EQ(executed.load(), kTaskCount);
+}
+
+/**
+ * @brief Tests that a pool sized automatically has at least one worker.
+ */
+TEST(ThreadPoolTest, AutomaticSizing) {
+  Weaver::ThreadPool pool;
+  EXPECT_GE(pool.GetWorkerCount(), 1u);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file test_timers.cpp
+ * @author B.G. Smit
+ * @brief Unit tests for the named timer registry and its statistics.
+ * @copyright Copyright (c) 2025
+ */
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core/Timer.h"
+#include "Core/Timers.h"
+
+/**
+ * @brief Tests that every duration falls into a bucket whose bounds contain it, and that buckets
+ * are within the promised precision.
+ */
+TEST(TimersTest, BucketsContainTheirDurations) {
+  using Weaver::TimerAccumulator;
+  for (uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull}) {
+    const uint32_t bucket = TimerAccumulator::GetBucket(value);
+    ASSERT_LT(bucket, TimerAccumulator::kBucketCount);
+    EXPECT_LE(TimerAccumulator::GetBucketLowerBound(bucket), value);
+    if (bucket + 1 < TimerAccumulator::kBucketCount) {
+      const uint64_t next = TimerAccumulator::GetBucketLowerBound(bucket + 1);
+      EXPECT_GT(next, value);
+      EXPECT_LE(next - TimerAccumulator::GetBucketLowerBound(bucket),
+          std::max<uint64_t>(1, value / TimerAccumulator::kSubBuckets));
+    }
+  }
+}
+
+/**
+ * @brief Tests the count, extremes, mean and percentiles of a known distribution.
+ */
+TEST(TimersTest, ComputesStatistics) {
+  Weaver::TimerAccumulator& timer = Weaver::Timers::Get("TimersTest.Statistics");
+  EXPECT_EQ(&timer, &Weaver::Timers::Get("TimersTest.Statistics"));
+  timer.Reset();
+
+  // 1 to 1000 microseconds.
+  for (uint64_t i = 1; i <= 1000; i++)
+    timer.Record(i * 1000);
+  const Weaver::TimerStatistics statistics = timer.GetStatistics();
+  EXPECT_EQ(statistics.Name, "TimersTest.Statistics");
+  EXPECT_EQ(statistics.Count, 1000u);
+  EXPECT_DOUBLE_EQ(statistics.MinMs, 0.001);
+  EXPECT_DOUBLE_EQ(statistics.MaxMs, 1.0);
+  EXPECT_NEAR(statistics.MeanMs, 0.5005, 1e-9);
+  EXPECT_NEAR(statistics.P50Ms, 0.5, 0.5 * 0.07);
+  EXPECT_NEAR(statistics.P95Ms, 0.95, 0.95 * 0.07);
+  EXPECT_NEAR(statistics.P99Ms, 0.99, 0.99 * 0.07);
+
+  timer.Reset();
+  EXPECT_EQ(timer.GetStatistics().Count, 0u);
+}
+
+/**
+ * @brief Tests that scoped timers on many threads record every call into the same timer, and that
+ * snapshots and CSV dumps contain it.
+ */
+TEST(TimersTest, AggregatesScopedTimers) {
+  constexpr int kThreadCount = 4;
+  constexpr int kCallsPerThread = 20000;
+  Weaver::Timers::Get("TimersTest.Scoped").Reset();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; t++) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < kCallsPerThread; i++) {
+        WEAVER_TIME_SCOPE("TimersTest.Scoped");
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  { Weaver::ScopedTimer by_name("TimersTest.Scoped"); }
+
+  bool found = false;
+  for (const Weaver::TimerStatistics& statistics : Weaver::Timers::Snapshot()) {
+    if (statistics.Name == "TimersTest.Scoped") {
+      found = true;
+      EXPECT_EQ(statistics.Count, (uint64_t)kThreadCount * kCallsPerThread + 1);
+      EXPECT_LE(statistics.MinMs, statistics.P50Ms);
+      EXPECT_LE(statistics.P50Ms, statistics.P99Ms);
+      EXPECT_LE(statistics.P99Ms, statistics.MaxMs);
+    }
+  }
+  EXPECT_TRUE(found);
+
+  std::ostringstream csv;
+  Weaver::Timers::WriteCsv(csv, true);
+  EXPECT_EQ(csv.str().rfind("time_s,name,count,", 0), 0u);
+  EXPECT_NE(csv.str().find(",\"TimersTest.Scoped\",80001,"), std::string::npos);
+}